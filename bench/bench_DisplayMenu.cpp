@@ -0,0 +1,828 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    Host microbenchmarks for the DisplayMenu class. Prints the cost in ns/op of
+//    navigation, interaction and printing functions for several grid sizes.
+//    Usage: bench_DisplayMenu [--quick]
+//      --quick   run each measurement for a few ms only (used as a CI smoke test)
+//
+//***********************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <new>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+#include "DisplayMenu.h"
+#include "DisplayGridMenu.h"
+#include "DisplayMenuGroup.h"
+#include "DisplayWidget.h"
+#include "DisplayFramebuffer.h"
+#include "DisplayBlit.h"
+#include "DisplayRenderList.h"
+#include "DisplayRenderer.h"
+#include "DisplayFlushPipeline.h"
+#include "DisplayGlyphCache.h"
+#include "DisplayTween.h"
+#include "HostDisplay.h"
+#include "HostAsyncBus.h"
+
+#define BENCH_BATCH_NB (64)
+
+static double benchDurationNs = 200e6;
+static volatile uint32_t sink; // keeps results alive so the compiler does not remove the work
+
+static int widgetValues[MAX_WIDGETS_NB];
+
+struct GridSize
+{
+  uint16_t x;
+  uint16_t y;
+};
+
+/***************************************************************************/
+/*!
+    @brief Run op in batches until the benchmark duration is reached
+    @return average duration of one op in ns
+*/
+/***************************************************************************/
+template <typename Op>
+static double measure(Op op)
+{
+  typedef std::chrono::steady_clock clock;
+  unsigned long iterations = 0;
+  clock::time_point start = clock::now();
+  double elapsed = 0;
+  do {
+    for (int i = 0; i < BENCH_BATCH_NB; i++) {
+      op();
+    }
+    iterations += BENCH_BATCH_NB;
+    elapsed = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+  } while (elapsed < benchDurationNs);
+  return elapsed / iterations;
+}
+
+static void report(const char *name, const GridSize &grid, double nsPerOp)
+{
+  printf("%-22s %3ux%-3u %12.1f ns/op\n", name, grid.x, grid.y, nsPerOp);
+}
+
+static void benchGrid(const GridSize &grid)
+{
+  uint16_t nb = grid.x * grid.y;
+
+  // DisplayWidget has no default ctor, build the page in raw storage
+  alignas(DisplayWidget) static unsigned char storage[MAX_WIDGETS_NB * sizeof(DisplayWidget)];
+  DisplayWidget *widgets = (DisplayWidget *)storage;
+  for (uint16_t i = 0; i < nb; i++) {
+    new (&widgets[i]) DisplayWidget(&widgetValues[i], 1, 1000, 0, (i / grid.y) * 20, (i % grid.y) * 20, 20, 20);
+  }
+
+  DisplayMenu menu;
+  menu.setColors(0xFFFF, 0x001F, 0x07E0, 0x0000);
+  menu.setDisplayedWidgets(widgets, grid.y, grid.x);
+
+  report("moveUp", grid, measure([&]() { menu.moveUp(); }));
+  report("moveDown", grid, measure([&]() { menu.moveDown(); }));
+  report("moveLeft", grid, measure([&]() { menu.moveLeft(); }));
+  report("moveRight", grid, measure([&]() { menu.moveRight(); }));
+
+  // same page through a navigation table
+  static DisplayNavEntry navTable[MAX_WIDGETS_NB];
+  report("nav table build", grid, measure([&]() { sink += DisplayNavTable::build(widgets, nb, navTable); }));
+  menu.setDisplayedLayout(widgets, nb, navTable);
+  report("nav moveDown", grid, measure([&]() { menu.moveDown(); menu.moveUp(); }) / 2);
+  report("nav moveRight", grid, measure([&]() { menu.moveRight(); menu.moveLeft(); }) / 2);
+  menu.setDisplayedWidgets(widgets, grid.y, grid.x);
+  report("interact", grid, measure([&]() { menu.interact(); }));
+
+  menu.interact();
+  if (!menu.isEditingTarget()) {
+    menu.interact();
+  }
+  report("edit (moveUp)", grid, measure([&]() { menu.moveUp(); }));
+  menu.interact();
+
+  DisplayInputQueue queue;
+  report("32 moves, one by one", grid, measure([&]() {
+    for (uint8_t i = 0; i < DISPLAY_INPUT_QUEUE_SIZE; i++) {
+      menu.moveDown();
+    }
+  }));
+  report("32 moves, queued", grid, measure([&]() {
+    for (uint8_t i = 0; i < DISPLAY_INPUT_QUEUE_SIZE; i++) {
+      queue.push(DISPLAY_INPUT_DOWN);
+    }
+    sink += menu.processInputs(queue);
+  }));
+
+  uint16_t idx = 0;
+  report("getWidgetColor", grid, measure([&]() {
+    sink += menu.getWidgetColor(idx);
+    idx = (idx + 1 < nb) ? idx + 1 : 0;
+  }));
+
+  // cost per page, not per widget
+  report("startPrint/nextPrint", grid, measure([&]() {
+    menu.startPrint();
+    for (uint16_t i = 0; i < nb; i++) {
+      sink += menu.getPrintColor() + menu.getPrintX() + menu.getPrintY();
+      menu.nextPrint();
+    }
+  }));
+
+  report("dirty print (1 move)", grid, measure([&]() {
+    menu.moveDown();
+    if (menu.startDirtyPrint()) {
+      do {
+        sink += menu.getPrintColor() + menu.getPrintX() + menu.getPrintY();
+      } while (menu.nextDirtyPrint());
+    }
+    menu.clearDamage();
+  }));
+}
+
+template <uint16_t Y_NB, uint16_t X_NB>
+static void benchGridMenu()
+{
+  const GridSize grid = {X_NB, Y_NB};
+  alignas(DisplayWidget) static unsigned char storage[Y_NB * X_NB * sizeof(DisplayWidget)];
+  DisplayWidget *widgets = (DisplayWidget *)storage;
+  for (uint16_t i = 0; i < Y_NB * X_NB; i++) {
+    new (&widgets[i]) DisplayWidget(&widgetValues[i], 1, 1000);
+  }
+
+  DisplayGridMenu<Y_NB, X_NB> menu;
+  menu.setDisplayedWidgets(*(DisplayWidget(*)[Y_NB * X_NB])widgets);
+  report("grid moveDown", grid, measure([&]() { menu.moveDown(); }));
+  report("grid moveRight", grid, measure([&]() { menu.moveRight(); }));
+}
+
+#define BENCH_LIST_ITEM_NB (100000)
+#define BENCH_LIST_ROW_NB (8)
+
+static DisplayWidget benchRowProvider(uint32_t itemIdx, uint16_t viewRow, void *ctx)
+{
+  (void)ctx;
+  return DisplayWidget(&widgetValues[itemIdx % MAX_WIDGETS_NB], 1, 1000, 0, 0, viewRow * 16, 240, 16);
+}
+
+static void benchList()
+{
+  const GridSize grid = {1, BENCH_LIST_ROW_NB};
+  static DisplayWidgetSlot rows[BENCH_LIST_ROW_NB];
+  DisplayMenu menu;
+  menu.setDisplayedList(rows, BENCH_LIST_ROW_NB, BENCH_LIST_ITEM_NB, benchRowProvider);
+  report("list moveDown", grid, measure([&]() { menu.moveDown(); }));
+  report("list moveDown(100)", grid, measure([&]() { menu.moveDown(100); }));
+  printf("%-22s %u items, at item %u\n", "list", (unsigned int)menu.getListItemNb(),
+         (unsigned int)menu.getTargetItem());
+}
+
+static void benchRenderer()
+{
+  const GridSize grid = {4, 4};
+  static uint16_t pixels[240 * 320];
+  static DisplayWidget widgets[16] = {
+      DisplayWidget(&widgetValues[0], 1, 100, 0, 0, 0, 60, 80),     DisplayWidget(&widgetValues[1], 1, 100, 0, 0, 80, 60, 80),
+      DisplayWidget(&widgetValues[2], 1, 100, 0, 0, 160, 60, 80),   DisplayWidget(&widgetValues[3], 1, 100, 0, 0, 240, 60, 80),
+      DisplayWidget(&widgetValues[4], 1, 100, 0, 60, 0, 60, 80),    DisplayWidget(&widgetValues[5], 1, 100, 0, 60, 80, 60, 80),
+      DisplayWidget(&widgetValues[6], 1, 100, 0, 60, 160, 60, 80),  DisplayWidget(&widgetValues[7], 1, 100, 0, 60, 240, 60, 80),
+      DisplayWidget(&widgetValues[8], 1, 100, 0, 120, 0, 60, 80),   DisplayWidget(&widgetValues[9], 1, 100, 0, 120, 80, 60, 80),
+      DisplayWidget(&widgetValues[10], 1, 100, 0, 120, 160, 60, 80), DisplayWidget(&widgetValues[11], 1, 100, 0, 120, 240, 60, 80),
+      DisplayWidget(&widgetValues[12], 1, 100, 0, 180, 0, 60, 80),  DisplayWidget(&widgetValues[13], 1, 100, 0, 180, 80, 60, 80),
+      DisplayWidget(&widgetValues[14], 1, 100, 0, 180, 160, 60, 80), DisplayWidget(&widgetValues[15], 1, 100, 0, 180, 240, 60, 80)};
+  DisplayFramebuffer fb(pixels, 240, 320);
+  HostDisplay screen(240, 320);
+  DisplayFramebufferBackend backend(fb, HostDisplay::flush, &screen);
+  DisplayRenderer<DisplayFramebufferBackend> renderer(backend);
+  DisplayMenu menu;
+  menu.setColors(0xFFFF, 0x001F, 0x07E0, 0x0000);
+  menu.setDisplayedWidgets(widgets, 4, 4);
+  renderer.setTextStyle(2, 8, 30, 3);
+
+  report("renderer printMenu", grid, measure([&]() { renderer.printMenu(menu); }));
+  report("renderer move+dirty", grid, measure([&]() {
+    menu.moveDown();
+    renderer.printDirty(menu);
+  }));
+  screen.resetCounters();
+  menu.moveDown();
+  renderer.printDirty(menu);
+  printf("%-22s %u pixels in %u transfers for 1 move\n", "renderer", (unsigned int)screen.getPixelNb(),
+         (unsigned int)screen.getTransferNb());
+
+  menu.resetStats();
+  for (uint16_t i = 0; i < 100; i++) {
+    menu.moveDown();
+    renderer.printDirty(menu);
+  }
+  const DisplayRenderStats &stats = menu.getStats();
+  printf("%-22s %u frames: %u widgets redrawn, %u skipped, %u pixels, worst %u us\n", "renderer stats",
+         (unsigned int)stats.frameNb, (unsigned int)stats.redrawnWidgetNb, (unsigned int)stats.skippedWidgetNb,
+         (unsigned int)stats.pushedPixelNb, (unsigned int)stats.worstFrameUs);
+
+  // between two frames: changes are only accumulated
+  menu.setFrameSchedule(60000);
+  sink = menu.isFrameDue();
+  report("frame due check", grid, measure([&]() {
+    menu.moveDown();
+    sink = menu.isFrameDue();
+  }));
+  menu.setFrameSchedule(0);
+
+  DisplayValueFormat format = {6, 1, "V", ' ', true};
+  char text[DISPLAY_RENDERER_TEXT_LEN];
+  report("format value", grid, measure([&]() { sink = widgets[5].formatValue(text, sizeof(text), format); }));
+
+  static DisplayGlyphCache cache;
+  cache.build(menu, 2);
+  renderer.setGlyphCache(&cache);
+  screen.resetCounters();
+  menu.moveDown();
+  renderer.printDirty(menu);
+  printf("%-22s %u pixels in %u transfers for 1 move\n", "renderer glyph cache", (unsigned int)screen.getPixelNb(),
+         (unsigned int)screen.getTransferNb());
+}
+
+// Status screen gauges, the level moves by 1% per frame
+static void benchBar()
+{
+  const GridSize grid = {4, 1};
+  static uint16_t pixels[240 * 320];
+  static uint8_t levels[4] = {10, 35, 60, 85};
+  static const DisplayValueRange<uint8_t> ranges[4] = {
+      {&levels[0], 1, 0, 100}, {&levels[1], 1, 0, 100}, {&levels[2], 1, 0, 100}, {&levels[3], 1, 0, 100}};
+  static DisplayWidget gauges[4] = {
+      DisplayWidget(ranges[0], BAR_LEFT_TO_RIGHT, 10, 10, 204, 24), DisplayWidget(ranges[1], BAR_LEFT_TO_RIGHT, 10, 50, 204, 24),
+      DisplayWidget(ranges[2], BAR_LEFT_TO_RIGHT, 10, 90, 204, 24), DisplayWidget(ranges[3], BAR_LEFT_TO_RIGHT, 10, 130, 204, 24)};
+  DisplayFramebuffer fb(pixels, 240, 320);
+  HostDisplay screen(240, 320);
+  DisplayFramebufferBackend backend(fb, HostDisplay::flush, &screen);
+  DisplayRenderer<DisplayFramebufferBackend> renderer(backend);
+  DisplayMenu menu;
+  menu.setColors(0xFFFF, 0x001F, 0x07E0, 0x0000);
+  menu.setDisplayedWidgets(gauges, 4, 1);
+  renderer.setBarColor(0x07E0);
+  renderer.printMenu(menu);
+
+  uint8_t frame = 0;
+  auto stepLevels = [&]() {
+    bool isUp = ((frame++ / 20) & 1) == 0;
+    for (uint16_t i = 0; i < 4; i++) {
+      levels[i] += isUp ? 1 : -1;
+      menu.flagWidgetChange(i);
+    }
+  };
+  report("bar 1% delta", grid, measure([&]() {
+    stepLevels();
+    renderer.printDirty(menu);
+  }));
+  report("bar 1% full redraw", grid, measure([&]() {
+    stepLevels();
+    renderer.printMenu(menu);
+  }));
+
+  screen.resetCounters();
+  stepLevels();
+  renderer.printDirty(menu);
+  uint32_t deltaPixelNb = screen.getPixelNb();
+  screen.resetCounters();
+  stepLevels();
+  renderer.printMenu(menu);
+  printf("%-22s %u pixels per 1%% change, %u with full redraws\n", "bar gauges", (unsigned int)deltaPixelNb,
+         (unsigned int)screen.getPixelNb());
+}
+
+#define BENCH_SCREEN_WIDTH (240)
+
+static uint16_t glyphScreen[BENCH_SCREEN_WIDTH * 64];
+static uint32_t glyphTransferNb;
+
+static void pushToScreen(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t *pixels, uint16_t stride,
+                         void *ctx)
+{
+  (void)ctx;
+  for (uint16_t j = 0; j < h; j++) {
+    memcpy(&glyphScreen[(y + j) * BENCH_SCREEN_WIDTH + x], &pixels[j * stride], w * sizeof(uint16_t));
+  }
+  glyphTransferNb++;
+}
+
+// Opaque scaled text the way Adafruit_GFX::drawChar does it: one block transfer per font pixel
+static void fontRendererText(int16_t x, int16_t y, const char *text, uint16_t color, uint16_t bgColor, uint8_t size)
+{
+  static const uint8_t digitFont[10][5] = {
+      {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00}, {0x72, 0x49, 0x49, 0x49, 0x46},
+      {0x21, 0x41, 0x49, 0x4D, 0x33}, {0x18, 0x14, 0x12, 0x7F, 0x10}, {0x27, 0x45, 0x45, 0x45, 0x39},
+      {0x3C, 0x4A, 0x49, 0x49, 0x31}, {0x41, 0x21, 0x11, 0x09, 0x07}, {0x36, 0x49, 0x49, 0x49, 0x36},
+      {0x46, 0x49, 0x49, 0x29, 0x1E}};
+  uint16_t fgBlock[GLYPH_CACHE_MAX_TEXT_SIZE * GLYPH_CACHE_MAX_TEXT_SIZE];
+  uint16_t bgBlock[GLYPH_CACHE_MAX_TEXT_SIZE * GLYPH_CACHE_MAX_TEXT_SIZE];
+  for (uint8_t i = 0; i < size * size; i++) {
+    fgBlock[i] = color;
+    bgBlock[i] = bgColor;
+  }
+  for (; *text != '\0'; text++, x += 6 * size) {
+    for (uint8_t col = 0; col < 6; col++) {
+      uint8_t bits = ((col < 5) && (*text >= '0') && (*text <= '9')) ? digitFont[*text - '0'][col] : 0;
+      for (uint8_t row = 0; row < 8; row++, bits >>= 1) {
+        pushToScreen(x + col * size, y + row * size, size, size, (bits & 1) ? fgBlock : bgBlock, size, NULL);
+      }
+    }
+  }
+}
+
+static void benchGlyphCache()
+{
+  const GridSize grid = {4, 1};
+  const uint16_t colors[GLYPH_CACHE_STATE_NB] = {0xFFFF, 0x001F, 0x07E0};
+  static DisplayGlyphCache cache;
+  const char *values[] = {"1234", "1235", "1236", "1237"};
+  uint32_t i = 0;
+
+  report("glyph cache build", grid, measure([&]() { sink = cache.build(3, colors, 0x0000); }));
+  report("font renderer value", grid, measure([&]() { fontRendererText(8, 8, values[i++ & 3], 0x07E0, 0x0000, 3); }));
+  report("glyph cache value", grid, measure([&]() { cache.drawText(8, 8, values[i++ & 3], 0x07E0, pushToScreen); }));
+
+  glyphTransferNb = 0;
+  fontRendererText(8, 8, "-90.5", 0x07E0, 0x0000, 3);
+  uint32_t fontTransferNb = glyphTransferNb;
+  glyphTransferNb = 0;
+  cache.drawText(8, 8, "-90.5", 0x07E0, pushToScreen);
+  printf("%-22s %u transfers per value instead of %u\n", "glyph cache", (unsigned int)glyphTransferNb,
+         (unsigned int)fontTransferNb);
+}
+
+static void benchTween()
+{
+  const GridSize grid = {DISPLAY_ANIMATOR_MAX_TWEENS, 1};
+  static int16_t levels[DISPLAY_ANIMATOR_MAX_TWEENS];
+  static uint16_t colors[DISPLAY_ANIMATOR_MAX_TWEENS];
+  DisplayAnimator animator;
+  animator.setStepPeriod(0);
+  unsigned long now = millis();
+
+  // time goes 1 ms per update, tweens restart when done
+  report("tween update", grid, measure([&]() {
+    now++;
+    for (uint8_t i = 0; i < DISPLAY_ANIMATOR_MAX_TWEENS / 2; i++) {
+      if (animator.getRunningNb() < DISPLAY_ANIMATOR_MAX_TWEENS) {
+        animator.animate(&levels[i], (levels[i] == 0) ? 200 : 0, 500, EASE_IN_OUT);
+        animator.animateColor(&colors[i], (colors[i] == 0) ? 0xFFFF : 0, 500);
+      }
+    }
+    sink = animator.update(now);
+  }));
+}
+
+#define TICKLESS_IDLE_MS (40)
+#define TICKLESS_PERIOD_MS (20)
+
+/***************************************************************************/
+/*!
+    @brief Event driven loop: sleeps until an input, the menu deadline or the
+    next tween step. Inputs come in two bursts between idle times, the first
+    one starts a tween, the loop must not wake up when there is nothing to do.
+    @return false if a timer woke the loop up with nothing to do
+*/
+/***************************************************************************/
+static bool benchTickless()
+{
+  static DisplayWidget widgets[4] = {DisplayWidget(&widgetValues[0], 1, 100), DisplayWidget(&widgetValues[1], 1, 100),
+                                     DisplayWidget(&widgetValues[2], 1, 100), DisplayWidget(&widgetValues[3], 1, 100)};
+  DisplayMenu menu;
+  DisplayInputQueue queue;
+  DisplayAnimator animator;
+  std::mutex mutex;
+  std::condition_variable wakeup;
+  bool isStopped = false;
+  bool isTimerWakeup = false;
+  bool isTweenStarted = false;
+  uint32_t eventWakeNb = 0, deadlineWakeNb = 0, idleWakeNb = 0, frameNb = 0, stepNb = 0;
+
+  menu.setDisplayedWidgets(widgets, 4);
+  menu.setFrameSchedule(TICKLESS_PERIOD_MS);
+  animator.setStepPeriod(TICKLESS_PERIOD_MS / 2);
+  displayValueStore(&widgetValues[3], 0);
+
+  std::thread inputs([&]() {
+    const uint32_t burstTimesMs[] = {TICKLESS_IDLE_MS, TICKLESS_IDLE_MS + TICKLESS_PERIOD_MS / 4};
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t burstTime : burstTimesMs) {
+      std::this_thread::sleep_until(start + std::chrono::milliseconds(burstTime));
+      // under the lock so the notification cannot fall between the check and the wait of the loop
+      std::lock_guard<std::mutex> lock(mutex);
+      for (uint8_t i = 0; i < 3; i++) {
+        queue.push(DISPLAY_INPUT_DOWN);
+      }
+      wakeup.notify_one();
+    }
+    std::this_thread::sleep_until(start + std::chrono::milliseconds(2 * TICKLESS_IDLE_MS + TICKLESS_PERIOD_MS));
+    std::lock_guard<std::mutex> lock(mutex);
+    isStopped = true;
+    wakeup.notify_one();
+  });
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    if ((menu.processInputs(queue) > 0) && !isTweenStarted) {
+      // linear, every step changes the value
+      animator.animateWidget(menu, 3, TWEEN_KIND_WIDGET_VALUE, 4 * TICKLESS_PERIOD_MS, 2 * TICKLESS_PERIOD_MS,
+                             EASE_LINEAR);
+      isTweenStarted = true;
+    }
+    uint8_t changedNb = animator.update();
+    stepNb += changedNb;
+    bool isFrame = menu.isFrameDue();
+    if (isFrame) {
+      if (menu.startDirtyPrint()) {
+        while (menu.nextDirtyPrint()) {
+        }
+      }
+      menu.clearDamage();
+      frameNb++;
+    }
+    // judged on what the wakeup did, not on deadlines read again after it
+    if (isTimerWakeup && !isFrame && (changedNb == 0)) {
+      idleWakeNb++;
+    }
+
+    uint32_t delayMs = menu.getNextDeadlineMs();
+    uint32_t tweenDelayMs = animator.getNextDeadlineMs();
+    if (tweenDelayMs < delayMs) {
+      delayMs = tweenDelayMs;
+    }
+    std::function<bool()> hasEvent = [&]() { return isStopped || !queue.isEmpty(); };
+    bool isEvent = (delayMs == DISPLAY_DEADLINE_NEVER) ? (wakeup.wait(lock, hasEvent), true)
+                                                       : wakeup.wait_for(lock, std::chrono::milliseconds(delayMs), hasEvent);
+    if (isStopped) {
+      break;
+    }
+    isTimerWakeup = !isEvent;
+    if (isEvent) {
+      eventWakeNb++;
+    } else {
+      deadlineWakeNb++;
+    }
+  }
+  lock.unlock();
+  inputs.join();
+
+  printf("%-22s %u frames, %u tween steps, %u input wakeups, %u deadline wakeups, %u idle wakeups\n",
+         "tickless loop", (unsigned int)frameNb, (unsigned int)stepNb, (unsigned int)eventWakeNb,
+         (unsigned int)deadlineWakeNb, (unsigned int)idleWakeNb);
+  return (idleWakeNb == 0) && (displayValueLoad(&widgetValues[3]) == 4 * TICKLESS_PERIOD_MS);
+}
+
+#define STATUS_FLUSH_DELAY_US (3000)    // slow I2C status display, per flushed rectangle
+#define MULTI_VOLUME_STEPS     (10)
+#define MULTI_BATTERY_END      (80)
+
+// Status display: every flushed rectangle takes STATUS_FLUSH_DELAY_US
+static void slowStatusFlush(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t *pixels, uint16_t stride,
+                            void *ctx)
+{
+  HostDisplay::flush(x, y, w, h, pixels, stride, ctx);
+  std::this_thread::sleep_for(std::chrono::microseconds(STATUS_FLUSH_DELAY_US));
+}
+
+// Main TFT and status display rendered by their own threads, inputs routed to
+// the focused menu, volume edited on the main menu and battery changed by the
+// application, both shown on the two displays
+static bool benchMultiDisplay()
+{
+  static uint16_t mainPixels[240 * 320];
+  static uint16_t statusPixels[128 * 64];
+  static uint8_t volume = 20;
+  static uint8_t battery = 100;
+  static const DisplayValueRange<uint8_t> volumeRange = {&volume, 1, 0, 100};
+  static const DisplayValueRange<uint8_t> batteryRange = {&battery, 1, 0, 100};
+  static DisplayWidget mainWidgets[3] = {DisplayWidget(volumeRange, 0, 0, 120, 40), DisplayWidget(batteryRange, 0, 40, 120, 40),
+                                         DisplayWidget(&widgetValues[0], 1, 100, 0, 0, 80, 120, 40)};
+  static DisplayWidget statusWidgets[2] = {DisplayWidget(volumeRange, BAR_LEFT_TO_RIGHT, 4, 4, 120, 20),
+                                           DisplayWidget(batteryRange, BAR_LEFT_TO_RIGHT, 4, 36, 120, 20)};
+  DisplayFramebuffer mainFb(mainPixels, 240, 320);
+  DisplayFramebuffer statusFb(statusPixels, 128, 64);
+  HostDisplay mainScreen(240, 320);
+  HostDisplay statusScreen(128, 64);
+  DisplayFramebufferBackend mainBackend(mainFb, HostDisplay::flush, &mainScreen);
+  DisplayFramebufferBackend statusBackend(statusFb, slowStatusFlush, &statusScreen);
+  DisplayRenderer<DisplayFramebufferBackend> mainRenderer(mainBackend);
+  DisplayRenderer<DisplayFramebufferBackend> statusRenderer(statusBackend);
+  DisplayMenu mainMenu, statusMenu;
+  DisplayInputQueue mainQueue, statusQueue;
+  DisplayMenuGroup group;
+  std::atomic<bool> isStopped(false);
+  uint32_t frameNb[2] = {0, 0};
+
+  mainMenu.setDisplayedWidgets(mainWidgets, 3);
+  statusMenu.setDisplayedWidgets(statusWidgets, 2);
+  uint8_t mainIdx = group.addMenu(mainMenu, mainQueue);
+  uint8_t statusIdx = group.addMenu(statusMenu, statusQueue);
+  group.addSharedValue(&volume);
+  group.addSharedValue(&battery);
+  mainRenderer.printMenu(mainMenu);
+  statusRenderer.printMenu(statusMenu);
+
+  auto renderLoop = [&](uint8_t menuIdx, DisplayRenderer<DisplayFramebufferBackend> &renderer) {
+    DisplayMenu &menu = *group.getMenu(menuIdx);
+    while (!isStopped.load()) {
+      group.processInputs(menuIdx);
+      if (renderer.printDirty(menu) > 0) {
+        frameNb[menuIdx]++;
+      } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+      }
+    }
+  };
+  std::thread mainTask(renderLoop, mainIdx, std::ref(mainRenderer));
+  std::thread statusTask(renderLoop, statusIdx, std::ref(statusRenderer));
+
+  // sensor: the application changes the battery level, always down to MULTI_BATTERY_END
+  std::thread sensor([&]() {
+    while (displayValueLoad(&battery) > MULTI_BATTERY_END) {
+      displayValueStore(&battery, (uint8_t)(displayValueLoad(&battery) - 1));
+      group.notifyValueChange(&battery);
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+  });
+
+  // inputs: edit the volume on the main menu, then navigate the status menu
+  group.push(DISPLAY_INPUT_INTERACT);
+  for (uint8_t i = 0; i < MULTI_VOLUME_STEPS; i++) {
+    group.push(DISPLAY_INPUT_UP);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  group.push(DISPLAY_INPUT_INTERACT);
+  group.setFocus(statusIdx);
+  group.push(DISPLAY_INPUT_DOWN);
+  group.setFocus(mainIdx);
+  sensor.join();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  isStopped = true;
+  mainTask.join();
+  statusTask.join();
+
+  // last changes, single threaded
+  for (uint8_t i = 0; i < group.getMenuNb(); i++) {
+    group.processInputs(i);
+  }
+  mainRenderer.printDirty(mainMenu);
+  statusRenderer.printDirty(statusMenu);
+
+  uint16_t barLength = statusWidgets[0].getWidth() - 2 * DISPLAY_RENDERER_BAR_INSET;
+  bool isSynced = (volume == 20 + MULTI_VOLUME_STEPS) && (battery == MULTI_BATTERY_END) &&
+                  (statusWidgets[0].getBarDrawnExtent() == (int16_t)displayValueScale(volumeRange, barLength)) &&
+                  (statusWidgets[1].getBarDrawnExtent() == (int16_t)displayValueScale(batteryRange, barLength)) &&
+                  (statusMenu.getTargetItem() == 1) && (mainMenu.getTargetItem() == 0);
+  printf("%-22s main %u frames, status %u frames (%u us flushes), volume %u battery %u %s\n", "multi display",
+         (unsigned int)frameNb[mainIdx], (unsigned int)frameNb[statusIdx], (unsigned int)STATUS_FLUSH_DELAY_US,
+         (unsigned int)volume, (unsigned int)battery, isSynced ? "synced" : "NOT synced");
+  return isSynced;
+}
+
+#define BENCH_BUS_BITS_PER_S (40000000)   // 40 MHz SPI
+#define BENCH_BAND_RENDER_US (2000)        // drawing time of a band on a small MCU
+
+static void renderBand(DisplayFramebuffer &fb, uint32_t frame)
+{
+  typedef std::chrono::steady_clock clock;
+  clock::time_point end = clock::now() + std::chrono::microseconds(BENCH_BAND_RENDER_US);
+  fb.fillScreen(0x0000);
+  for (uint16_t row = 0; row < 12; row++) {
+    fb.fillRect(8 + (frame * 7 + row * 13) % 160, row * 26, 64, 20, 0x07E0);
+  }
+  while (clock::now() < end) {
+  }
+}
+
+static void benchPipeline()
+{
+  typedef std::chrono::steady_clock clock;
+  const GridSize grid = {240, 320};
+  const uint16_t bandHeight = 40;
+  const uint32_t frameNb = (benchDurationNs < 10e6) ? 1 : 10;
+  static uint16_t bufferA[240 * 40];
+  static uint16_t bufferB[240 * 40];
+  HostDisplay screen(240, 320);
+  HostAsyncBus bus(screen, BENCH_BUS_BITS_PER_S);
+
+  // synchronous: wait for the end of each band transfer before drawing the next one
+  DisplayFramebuffer syncFb(bufferA, 240, 320, bandHeight);
+  std::atomic<bool> isSent(false);
+  bus.setDoneFct([](void *ctx) { ((std::atomic<bool> *)ctx)->store(true, std::memory_order_release); }, &isSent);
+  clock::time_point start = clock::now();
+  for (uint32_t frame = 0; frame < frameNb; frame++) {
+    syncFb.startBand();
+    do {
+      renderBand(syncFb, frame);
+      DisplayFlushFct syncSend = [](int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t *pixels,
+                                    uint16_t stride, void *ctx) {
+        HostAsyncBus *b = (HostAsyncBus *)((void **)ctx)[0];
+        std::atomic<bool> *sent = (std::atomic<bool> *)((void **)ctx)[1];
+        sent->store(false, std::memory_order_relaxed);
+        HostAsyncBus::send(x, y, w, h, pixels, stride, b);
+        // acquire: the band buffer is drawn into again only once the bus read it
+        while (!sent->load(std::memory_order_acquire)) {
+        }
+      };
+      void *ctx[2] = {&bus, &isSent};
+      syncFb.flush(syncSend, ctx);
+    } while (syncFb.nextBand());
+  }
+  double syncNs = std::chrono::duration<double, std::nano>(clock::now() - start).count() / frameNb;
+
+  // pipelined: draw band N+1 while band N is sent
+  DisplayFramebuffer fb(bufferA, 240, 320, bandHeight);
+  DisplayFlushPipeline pipeline(fb, bufferB, HostAsyncBus::send, &bus);
+  bus.setDoneFct(DisplayFlushPipeline::transferDone, &pipeline);
+  start = clock::now();
+  for (uint32_t frame = 0; frame < frameNb; frame++) {
+    fb.startBand();
+    do {
+      renderBand(fb, frame);
+      pipeline.submitBand();
+    } while (fb.nextBand());
+  }
+  pipeline.waitIdle();
+  double asyncNs = std::chrono::duration<double, std::nano>(clock::now() - start).count() / frameNb;
+  bus.setDoneFct(NULL, NULL);
+
+  report("frame, sync flush", grid, syncNs);
+  report("frame, pipelined", grid, asyncNs);
+}
+
+static void countCmd(const DisplayCmd &cmd, void *ctx)
+{
+  (void)cmd;
+  (*(uint32_t *)ctx)++;
+}
+
+static void benchRenderList()
+{
+  const GridSize grid = {2, 12};
+  static DisplayRenderList list;
+  static char value[8];
+  uint32_t frame = 0;
+  uint32_t sentNb = 0;
+
+  // 12 rows of label + value, one value changing every frame
+  auto recordPage = [&]() {
+    list.begin();
+    list.fillRect(0, 0, 240, 320, 0x0000);
+    list.drawRect(0, 0, 240, 320, 0xFFFF);
+    for (uint8_t row = 0; row < 12; row++) {
+      list.setGroup(row + 1);
+      list.drawText(4, row * 24 + 4, "Label", 0xFFFF, 0x0000, 2, 60, 16);
+      snprintf(value, sizeof(value), "%u", (unsigned int)((row == 3) ? frame : row));
+      list.drawText(120, row * 24 + 4, value, 0x07E0, 0x0000, 2, 80, 16);
+    }
+    frame++;
+  };
+  report("render list frame", grid, measure([&]() {
+    recordPage();
+    list.commit(countCmd, &sentNb);
+  }));
+  list.invalidate();
+  recordPage();
+  uint32_t fullNb = 0;
+  list.commit(countCmd, &fullNb);
+  recordPage();
+  sentNb = 0;
+  list.commit(countCmd, &sentNb);
+  printf("%-22s %u of %u commands sent\n", "render list", (unsigned int)sentNb, (unsigned int)fullNb);
+}
+
+static void countSpan(uint16_t x, uint16_t y, uint16_t len, void *ctx)
+{
+  (void)ctx;
+  sink += x + y + len;
+}
+
+static void benchPackedBitmap()
+{
+  // charge logo of examples/batteryLevel.cpp, 26x17
+  static const unsigned char raw[] = {
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x10, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x00, 0x00, 0x1f, 0xc0, 0x00, 0x00, 0x0f, 0xf8, 0x00,
+      0x3f, 0xfc, 0x00, 0x00, 0x07, 0xfc, 0x00, 0x00, 0x00, 0x7e, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00};
+  static unsigned char packed[sizeof(raw) * 2];
+  const GridSize size = {26, 17}; // bitmap size, in pixels
+  DisplayBitmap bmp(size.x, size.y, raw);
+  DisplayPackedBitmap packedBmp(size.x, size.y, packed);
+  uint16_t packedSize = DisplayPackedBitmap::pack(bmp, packed, sizeof(packed));
+  printf("packed bitmap          %3ux%-3u %5u -> %u bytes\n", size.x, size.y, (unsigned int)sizeof(raw), packedSize);
+
+  report("packed bitmap spans", size, measure([&]() {
+    DisplayBitmapDecoder decoder(packedBmp);
+    while (decoder.nextRowSpans(countSpan)) {
+    }
+  }));
+}
+
+static void benchBlit()
+{
+  static unsigned char bits[240 / 8];
+  static uint16_t line[240];
+  const GridSize size = {240, 1}; // row length, in pixels
+  for (unsigned int i = 0; i < sizeof(bits); i++) {
+    bits[i] = (uint8_t)(i * 37);
+  }
+  DisplayBlit blit(0xFFFF, 0x0000);
+
+  report("row per pixel", size, measure([&]() {
+    for (uint16_t x = 0; x < size.x; x++) {
+      line[x] = (bits[x >> 3] & (0x80 >> (x & 7))) ? 0xFFFF : 0x0000;
+    }
+    sink += line[size.x - 1];
+  }));
+  report("row DisplayBlit", size, measure([&]() {
+    blit.expandRow(bits, size.x, line);
+    sink += line[size.x - 1];
+  }));
+}
+
+static void benchFramebuffer()
+{
+  static const uint16_t screenSide = 240;
+  static uint16_t pixels[screenSide * screenSide];
+  static uint16_t band[screenSide * 40];
+  const GridSize grid = {screenSide, screenSide}; // screen size, in pixels
+  HostDisplay screen(screenSide, screenSide);
+  DisplayFramebuffer fb(pixels, screenSide, screenSide);
+  DisplayFramebuffer bandedFb(band, screenSide, screenSide, 40);
+
+  report("fb full screen flush", grid, measure([&]() {
+    fb.fillScreen(0);
+    sink += fb.flush(HostDisplay::flush, &screen);
+  }));
+  report("fb one widget flush", grid, measure([&]() {
+    fb.drawRect(120, 0, 119, 119, 0xFFFF);
+    sink += fb.flush(HostDisplay::flush, &screen);
+  }));
+  report("banded fb full screen", grid, measure([&]() {
+    bandedFb.startBand();
+    do {
+      bandedFb.fillScreen(0);
+      sink += bandedFb.flush(HostDisplay::flush, &screen);
+    } while (bandedFb.nextBand());
+  }));
+}
+
+int main(int argc, char **argv)
+{
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--quick") == 0) {
+      benchDurationNs = 2e6;
+    }
+  }
+
+  printf("sizeof(DisplayWidget)  %u bytes\n", (unsigned int)sizeof(DisplayWidget));
+
+  const GridSize grids[] = {{1, 4}, {4, 4}, {MAX_SINGLE_AXIS_NB_WIDGETS, MAX_SINGLE_AXIS_NB_WIDGETS}};
+  for (unsigned int i = 0; i < sizeof(grids) / sizeof(grids[0]); i++) {
+    benchGrid(grids[i]);
+  }
+  benchGridMenu<4, 4>();
+  benchGridMenu<MAX_SINGLE_AXIS_NB_WIDGETS, MAX_SINGLE_AXIS_NB_WIDGETS>();
+  benchList();
+  benchRenderList();
+  benchRenderer();
+  benchBar();
+  benchGlyphCache();
+  benchTween();
+  benchPipeline();
+  benchPackedBitmap();
+  benchBlit();
+  benchFramebuffer();
+  if (!benchTickless()) {
+    printf("FAILED: the tickless loop woke up while idle\n");
+    return 1;
+  }
+  if (!benchMultiDisplay()) {
+    printf("FAILED: the displays do not show the shared values\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,2233 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    Host unit tests of the library, with the Unity stand-in of host/unity.h.
+//    Checks results (pixels, cursor positions, text, ...), where
+//    bench_DisplayMenu measures costs.
+//    Usage: test_DisplayMenu_host, returns the number of failed tests
+//
+//***********************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "Arduino.h"
+#include "unity.h"
+#include "DisplayDamage.h"
+#include "DisplayBitmap.h"
+#include "DisplayBlit.h"
+#include "DisplayFramebuffer.h"
+#include "DisplayFlushPipeline.h"
+#include "DisplayBackend.h"
+#include "DisplayGlyphCache.h"
+#include "DisplayGridMenu.h"
+#include "DisplayRenderList.h"
+#include "DisplayRenderer.h"
+#include "DisplayFormat.h"
+#include "DisplayTween.h"
+#include "DisplayMenuGroup.h"
+#include "DisplayPageStack.h"
+#include "HostAsyncBus.h"
+
+//#######################################################################
+// Host build
+//#######################################################################
+
+void Test_hostClock(void)
+{
+  unsigned long startMs = millis();
+  unsigned long startUs = micros();
+  delay(2);
+  TEST_ASSERT_TRUE(millis() - startMs >= 2);
+  TEST_ASSERT_TRUE(micros() - startUs >= 2000);
+}
+
+void Test_hostString(void)
+{
+  String text = String("V") + String(12);
+  TEST_ASSERT_EQUAL_STRING("V12", text.c_str());
+  TEST_ASSERT_EQUAL(3, text.length());
+}
+
+//#######################################################################
+// Damage region
+//#######################################################################
+
+static bool isDamageDisjoint(const DisplayDamage &damage)
+{
+  for (uint8_t i = 0; i < damage.getRectNb(); i++) {
+    for (uint8_t j = i + 1; j < damage.getRectNb(); j++) {
+      if (damage.getRect(i).overlaps(damage.getRect(j))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static bool isInDamage(const DisplayDamage &damage, const DisplayRect &rect)
+{
+  for (uint8_t i = 0; i < damage.getRectNb(); i++) {
+    const DisplayRect &r = damage.getRect(i);
+    if ((rect.x >= r.x) && (rect.y >= r.y) && (rect.x + rect.w <= r.x + r.w) && (rect.y + rect.h <= r.y + r.h)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Test_damageMergesOverlaps(void)
+{
+  DisplayDamage damage;
+  damage.add(0, 0, 10, 10);
+  damage.add(5, 5, 10, 10);   // union larger than both, still merged
+  TEST_ASSERT_EQUAL(1, damage.getRectNb());
+  TEST_ASSERT_EQUAL(0, damage.getRect(0).x);
+  TEST_ASSERT_EQUAL(15, damage.getRect(0).w);
+  TEST_ASSERT_EQUAL(15, damage.getRect(0).h);
+}
+
+void Test_damageMergesAdjacent(void)
+{
+  DisplayDamage damage;
+  damage.add(0, 0, 10, 10);
+  damage.add(10, 0, 10, 10);
+  TEST_ASSERT_EQUAL(1, damage.getRectNb());
+  TEST_ASSERT_EQUAL(20, damage.getRect(0).w);
+
+  // only a corner in common: the union would push 200 more pixels
+  damage.clear();
+  damage.add(0, 0, 10, 10);
+  damage.add(10, 10, 10, 10);
+  TEST_ASSERT_EQUAL(2, damage.getRectNb());
+}
+
+void Test_damageFullList(void)
+{
+  DisplayDamage damage;
+  DisplayRect rects[40];
+  uint32_t seed = 1;
+  for (uint8_t i = 0; i < 40; i++) {
+    seed = seed * 1103515245 + 12345;
+    DisplayRect r = {(int16_t)((seed >> 8) % 200), (int16_t)((seed >> 16) % 300), (uint16_t)(1 + (seed >> 4) % 40),
+                     (uint16_t)(1 + (seed >> 12) % 40)};
+    rects[i] = r;
+    damage.add(r);
+    TEST_ASSERT_TRUE(damage.getRectNb() <= MAX_DAMAGE_RECTS_NB);
+    TEST_ASSERT_TRUE(isDamageDisjoint(damage));
+    for (uint8_t j = 0; j <= i; j++) {
+      TEST_ASSERT_TRUE(isInDamage(damage, rects[j]));
+    }
+  }
+}
+
+//#######################################################################
+// Framebuffer
+//#######################################################################
+
+#define FB_TEST_WIDTH (64)     // 4 tiles of 16
+#define FB_TEST_HEIGHT (40)    // last tile row is 8 pixels high
+#define FB_TEST_MAX_FLUSHES (8)
+
+struct FbTestFlushes
+{
+  uint8_t nb;
+  DisplayRect rects[FB_TEST_MAX_FLUSHES];
+  const uint16_t *pixels[FB_TEST_MAX_FLUSHES];
+  uint16_t stride;
+};
+
+static void recordFlush(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t *pixels, uint16_t stride,
+                        void *ctx)
+{
+  FbTestFlushes *flushes = (FbTestFlushes *)ctx;
+  if (flushes->nb < FB_TEST_MAX_FLUSHES) {
+    DisplayRect rect = {x, y, w, h};
+    flushes->rects[flushes->nb] = rect;
+    flushes->pixels[flushes->nb] = pixels;
+    flushes->nb++;
+  }
+  flushes->stride = stride;
+}
+
+static bool isFlushed(const FbTestFlushes &flushes, uint8_t idx, int16_t x, int16_t y, uint16_t w, uint16_t h)
+{
+  const DisplayRect &rect = flushes.rects[idx];
+  return (idx < flushes.nb) && (rect.x == x) && (rect.y == y) && (rect.w == w) && (rect.h == h);
+}
+
+void Test_framebufferFlushMergesTiles(void)
+{
+  static uint16_t pixels[FB_TEST_WIDTH * FB_TEST_HEIGHT];
+  DisplayFramebuffer fb(pixels, FB_TEST_WIDTH, FB_TEST_HEIGHT);
+  FbTestFlushes flushes;
+  memset(&flushes, 0, sizeof(flushes));
+
+  fb.fillRect(2, 2, 3, 3, 0xF800);        // tile 0 of row 0
+  fb.fillRect(20, 5, 20, 2, 0x07E0);      // tiles 1 and 2 of row 0
+  fb.drawPixel(5, 17, 0x001F);            // tile 0 of row 1
+  fb.drawPixel(40, 20, 0x001F);           // tile 2 of row 1
+  fb.fillRect(60, 35, 10, 10, 0xFFFF);    // tile 3 of row 2, clipped to the screen
+  TEST_ASSERT_EQUAL(16 * 48 + 2 * 16 * 16 + 16 * 8, fb.flush(recordFlush, &flushes));
+
+  TEST_ASSERT_EQUAL(4, flushes.nb);
+  TEST_ASSERT_TRUE(isFlushed(flushes, 0, 0, 0, 48, 16));
+  TEST_ASSERT_TRUE(isFlushed(flushes, 1, 0, 16, 16, 16));
+  TEST_ASSERT_TRUE(isFlushed(flushes, 2, 32, 16, 16, 16));
+  TEST_ASSERT_TRUE(isFlushed(flushes, 3, 48, 32, 16, 8));
+  TEST_ASSERT_EQUAL(FB_TEST_WIDTH, flushes.stride);
+  TEST_ASSERT_TRUE(flushes.pixels[2] == &pixels[16 * FB_TEST_WIDTH + 32]);
+  TEST_ASSERT_EQUAL(0x07E0, flushes.pixels[0][5 * FB_TEST_WIDTH + 20]);
+  TEST_ASSERT_EQUAL(0xFFFF, pixels[39 * FB_TEST_WIDTH + 63]);
+
+  // sent tiles are forgotten
+  flushes.nb = 0;
+  TEST_ASSERT_EQUAL(0, fb.flush(recordFlush, &flushes));
+  TEST_ASSERT_EQUAL(0, flushes.nb);
+}
+
+void Test_framebufferBandsClipFlushes(void)
+{
+  static uint16_t pixels[FB_TEST_WIDTH * 12];
+  DisplayFramebuffer fb(pixels, FB_TEST_WIDTH, FB_TEST_HEIGHT, 12);
+  FbTestFlushes flushes;
+  memset(&flushes, 0, sizeof(flushes));
+  TEST_ASSERT_TRUE(fb.isBanded());
+
+  // band 0, rows 0 to 11: drawing and the sent tile row are clipped to it
+  fb.startBand();
+  fb.fillScreen(0x1111);
+  fb.drawPixel(0, 12, 0x2222);
+  TEST_ASSERT_EQUAL(FB_TEST_WIDTH * 12, fb.flush(recordFlush, &flushes));
+  TEST_ASSERT_EQUAL(1, flushes.nb);
+  TEST_ASSERT_TRUE(isFlushed(flushes, 0, 0, 0, FB_TEST_WIDTH, 12));
+  TEST_ASSERT_TRUE(flushes.pixels[0] == pixels);
+
+  // band 1, rows 12 to 23: across two tile rows, the buffer starts at row 12
+  flushes.nb = 0;
+  TEST_ASSERT_TRUE(fb.nextBand());
+  TEST_ASSERT_EQUAL(12, fb.getBandY());
+  fb.fillRect(20, 0, 4, FB_TEST_HEIGHT, 0x3333);
+  TEST_ASSERT_EQUAL(16 * 12, fb.flush(recordFlush, &flushes));
+  TEST_ASSERT_EQUAL(2, flushes.nb);
+  TEST_ASSERT_TRUE(isFlushed(flushes, 0, 16, 12, 16, 4));
+  TEST_ASSERT_TRUE(isFlushed(flushes, 1, 16, 16, 16, 8));
+  TEST_ASSERT_TRUE(flushes.pixels[0] == &pixels[16]);
+  TEST_ASSERT_TRUE(flushes.pixels[1] == &pixels[4 * FB_TEST_WIDTH + 16]);
+  TEST_ASSERT_EQUAL(0x3333, flushes.pixels[1][7 * FB_TEST_WIDTH + 4]);   // x 20, y 23
+
+  // last band is shorter than the buffer
+  TEST_ASSERT_TRUE(fb.nextBand());
+  TEST_ASSERT_TRUE(fb.nextBand());
+  TEST_ASSERT_EQUAL(36, fb.getBandY());
+  flushes.nb = 0;
+  fb.fillScreen(0x4444);
+  TEST_ASSERT_EQUAL(FB_TEST_WIDTH * 4, fb.flush(recordFlush, &flushes));
+  TEST_ASSERT_TRUE(isFlushed(flushes, 0, 0, 36, FB_TEST_WIDTH, 4));
+  TEST_ASSERT_FALSE(fb.nextBand());
+}
+
+//#######################################################################
+// Flush pipeline
+//#######################################################################
+
+#define PIPE_TEST_TILE (4)
+#define PIPE_TEST_HEIGHT (72)   // 3 bands
+#define PIPE_TEST_BAND (24)
+#define PIPE_TEST_BAND_RECTS ((FB_TEST_WIDTH / PIPE_TEST_TILE / 2) * (PIPE_TEST_BAND / PIPE_TEST_TILE))
+#define PIPE_TEST_MAX_SENDS (3 * PIPE_TEST_BAND_RECTS)
+
+static uint16_t pipeTestBuffers[2][FB_TEST_WIDTH * PIPE_TEST_BAND];
+
+struct PipeTestSends
+{
+  HostAsyncBus *bus;
+  uint16_t nb;
+  DisplayRect rects[PIPE_TEST_MAX_SENDS];
+  uint8_t bufferIdx[PIPE_TEST_MAX_SENDS];
+};
+
+// sent one at a time, from the main loop for the first rect of a job, then from the bus worker
+static void recordSend(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t *pixels, uint16_t stride,
+                       void *ctx)
+{
+  PipeTestSends *sends = (PipeTestSends *)ctx;
+  if (sends->nb < PIPE_TEST_MAX_SENDS) {
+    DisplayRect rect = {x, y, w, h};
+    sends->rects[sends->nb] = rect;
+    sends->bufferIdx[sends->nb] = (pixels >= pipeTestBuffers[1]) ? 1 : 0;
+    sends->nb++;
+  }
+  HostAsyncBus::send(x, y, w, h, pixels, stride, sends->bus);
+}
+
+// every other tile, each with its own color, so that no tiles merge
+static uint16_t pipeTestColor(uint16_t tileX, uint16_t tileY, uint8_t frame)
+{
+  return (((tileX + tileY) % 2) == 0) ? (uint16_t)(0x8000 | (frame << 12) | (tileY << 5) | tileX) : 0;
+}
+
+// draws the first rowNb tile rows of each band, checks each band is queued and the buffers alternate,
+// bandIdx counts the bands submitted since the pipeline was created
+static void drawPipeTestFrame(DisplayFramebuffer &fb, DisplayFlushPipeline &pipeline, uint8_t frame, uint16_t rowNb,
+                              uint8_t &bandIdx)
+{
+  fb.startBand();
+  do {
+    for (uint16_t tileY = 0; tileY < PIPE_TEST_HEIGHT / PIPE_TEST_TILE; tileY++) {
+      for (uint16_t tileX = 0; tileX < FB_TEST_WIDTH / PIPE_TEST_TILE; tileX++) {
+        uint16_t color = pipeTestColor(tileX, tileY, frame);
+        if ((color != 0) && ((tileY % (PIPE_TEST_BAND / PIPE_TEST_TILE)) < rowNb)) {
+          fb.fillRect(tileX * PIPE_TEST_TILE, tileY * PIPE_TEST_TILE, PIPE_TEST_TILE, PIPE_TEST_TILE, color);
+        }
+      }
+    }
+    TEST_ASSERT_EQUAL(rowNb * (FB_TEST_WIDTH / PIPE_TEST_TILE / 2) * PIPE_TEST_TILE * PIPE_TEST_TILE,
+                      pipeline.submitBand());
+    bandIdx++;
+    TEST_ASSERT_TRUE(fb.getBuffer() == pipeTestBuffers[bandIdx % 2]);
+  } while (fb.nextBand());
+  pipeline.waitIdle();
+  TEST_ASSERT_FALSE(pipeline.isBusy());
+}
+
+// each rect once, in band and raster order, from the buffer its band was drawn in
+static bool isPipeTestSent(const PipeTestSends &sends, uint16_t rowNb, uint8_t firstBandIdx)
+{
+  uint16_t sendIdx = 0;
+  for (uint16_t tileY = 0; tileY < PIPE_TEST_HEIGHT / PIPE_TEST_TILE; tileY++) {
+    for (uint16_t tileX = 0; tileX < FB_TEST_WIDTH / PIPE_TEST_TILE; tileX++) {
+      if ((pipeTestColor(tileX, tileY, 0) == 0) || ((tileY % (PIPE_TEST_BAND / PIPE_TEST_TILE)) >= rowNb)) {
+        continue;
+      }
+      const DisplayRect &rect = sends.rects[sendIdx];
+      if ((sendIdx >= sends.nb) || (rect.x != tileX * PIPE_TEST_TILE) || (rect.y != tileY * PIPE_TEST_TILE) ||
+          (rect.w != PIPE_TEST_TILE) || (rect.h != PIPE_TEST_TILE) ||
+          (sends.bufferIdx[sendIdx] != (firstBandIdx + tileY * PIPE_TEST_TILE / PIPE_TEST_BAND) % 2)) {
+        return false;
+      }
+      sendIdx++;
+    }
+  }
+  return sendIdx == sends.nb;
+}
+
+void Test_pipelineSendsBandsInOrder(void)
+{
+  const uint16_t bandRowNb = PIPE_TEST_BAND / PIPE_TEST_TILE;
+  HostDisplay screen(FB_TEST_WIDTH, PIPE_TEST_HEIGHT);
+  HostAsyncBus bus(screen, 2000000);   // slow enough for a buffer reused too early to show
+  static PipeTestSends sends;
+  memset(&sends, 0, sizeof(sends));
+  sends.bus = &bus;
+  DisplayFramebuffer fb(pipeTestBuffers[0], FB_TEST_WIDTH, PIPE_TEST_HEIGHT, PIPE_TEST_BAND, PIPE_TEST_TILE);
+  DisplayFlushPipeline pipeline(fb, pipeTestBuffers[1], recordSend, &sends);
+  bus.setDoneFct(DisplayFlushPipeline::transferDone, &pipeline);
+  uint8_t bandIdx = 0;
+
+  // more rects per band than a job holds: the job is sent and refilled in the same buffer
+  TEST_ASSERT_TRUE(PIPE_TEST_BAND_RECTS > DISPLAY_PIPELINE_MAX_RECTS);
+  drawPipeTestFrame(fb, pipeline, 0, bandRowNb, bandIdx);
+  TEST_ASSERT_EQUAL(PIPE_TEST_MAX_SENDS, screen.getTransferNb());
+  TEST_ASSERT_TRUE(isPipeTestSent(sends, bandRowNb, 0));
+
+  // one job per band: band 2 is drawn into the buffer of band 0 once it is sent
+  sends.nb = 0;
+  drawPipeTestFrame(fb, pipeline, 1, 2, bandIdx);
+  TEST_ASSERT_EQUAL(6, bandIdx);
+  TEST_ASSERT_TRUE(isPipeTestSent(sends, 2, 3));
+  bus.setDoneFct(NULL, NULL);
+
+  for (uint16_t y = 0; y < PIPE_TEST_HEIGHT; y++) {
+    for (uint16_t x = 0; x < FB_TEST_WIDTH; x++) {
+      uint8_t frame = ((y % PIPE_TEST_BAND) < 2 * PIPE_TEST_TILE) ? 1 : 0;
+      TEST_ASSERT_EQUAL(pipeTestColor(x / PIPE_TEST_TILE, y / PIPE_TEST_TILE, frame), screen.getPixel(x, y));
+    }
+  }
+}
+
+//#######################################################################
+// Packed bitmaps
+//#######################################################################
+
+#define PACK_TEST_WIDTH  (77)   // not a multiple of 8
+#define PACK_TEST_HEIGHT (21)
+#define PACK_TEST_ROW_BYTES ((PACK_TEST_WIDTH + 7) / 8)
+#define PACK_TEST_SIZE (PACK_TEST_ROW_BYTES * PACK_TEST_HEIGHT)
+
+static unsigned char packTestRow[PACK_TEST_ROW_BYTES];
+
+// Rows alternate between runs, literals, and rows of a single byte, and
+// cross the 128 bytes limit of a PackBits run
+static void fillPackPattern(unsigned char *raw, uint8_t pattern)
+{
+  uint32_t seed = pattern + 1;
+  for (uint16_t i = 0; i < PACK_TEST_SIZE; i++) {
+    seed = seed * 1103515245 + 12345;
+    switch (pattern) {
+      case 0:  raw[i] = 0x00; break;
+      case 1:  raw[i] = 0xFF; break;
+      case 2:  raw[i] = (uint8_t)(seed >> 16); break;
+      case 3:  raw[i] = ((i / 7) & 1) ? 0xA5 : (uint8_t)(seed >> 16); break;
+      default: raw[i] = (i & 1) ? 0x55 : 0xAA; break;
+    }
+  }
+}
+
+static void setSpanBits(uint16_t x, uint16_t y, uint16_t len, void *ctx)
+{
+  unsigned char *bits = (unsigned char *)ctx;
+  (void)y;
+  for (uint16_t i = x; i < x + len; i++) {
+    bits[i >> 3] |= 0x80 >> (i & 7);
+  }
+}
+
+void Test_packedBitmapRoundTrip(void)
+{
+  static unsigned char raw[PACK_TEST_SIZE];
+  static unsigned char packed[PACK_TEST_SIZE * 2];
+  for (uint8_t pattern = 0; pattern < 5; pattern++) {
+    fillPackPattern(raw, pattern);
+    DisplayBitmap bmp(PACK_TEST_WIDTH, PACK_TEST_HEIGHT, raw);
+    uint16_t packedSize = DisplayPackedBitmap::pack(bmp, packed, sizeof(packed));
+    TEST_ASSERT_TRUE(packedSize > 0);
+    if (pattern < 2) {
+      TEST_ASSERT_TRUE(packedSize < PACK_TEST_SIZE / 8);
+    }
+
+    DisplayPackedBitmap packedBmp(PACK_TEST_WIDTH, PACK_TEST_HEIGHT, packed);
+    DisplayBitmapDecoder decoder(packedBmp);
+    for (uint16_t row = 0; row < PACK_TEST_HEIGHT; row++) {
+      TEST_ASSERT_TRUE(decoder.nextRow(packTestRow));
+      TEST_ASSERT_EQUAL_MEMORY(&raw[row * PACK_TEST_ROW_BYTES], packTestRow, PACK_TEST_ROW_BYTES);
+    }
+    TEST_ASSERT_FALSE(decoder.nextRow(packTestRow));
+
+    // spans give the same pixels, the padding bits of the last byte excluded
+    decoder.restart();
+    for (uint16_t row = 0; row < PACK_TEST_HEIGHT; row++) {
+      memset(packTestRow, 0, sizeof(packTestRow));
+      TEST_ASSERT_TRUE(decoder.nextRowSpans(setSpanBits, packTestRow));
+      const unsigned char *rawRow = &raw[row * PACK_TEST_ROW_BYTES];
+      for (uint16_t x = 0; x < PACK_TEST_WIDTH; x++) {
+        uint8_t mask = 0x80 >> (x & 7);
+        TEST_ASSERT_EQUAL(rawRow[x >> 3] & mask, packTestRow[x >> 3] & mask);
+      }
+    }
+  }
+}
+
+void Test_packedBitmapOutTooSmall(void)
+{
+  static unsigned char raw[PACK_TEST_SIZE];
+  unsigned char packed[16];
+  fillPackPattern(raw, 2);
+  DisplayBitmap bmp(PACK_TEST_WIDTH, PACK_TEST_HEIGHT, raw);
+  TEST_ASSERT_EQUAL(0, DisplayPackedBitmap::pack(bmp, packed, sizeof(packed)));
+}
+
+//#######################################################################
+// Bitmap row expansion
+//#######################################################################
+
+#define BLIT_TEST_MAX_WIDTH (75)
+#define BLIT_TEST_GUARD     (0xDEAD)
+
+// Every width (partial bytes and nibbles), bit offsets in the source and
+// color pairs, against a pixel per pixel expansion. The test also runs in
+// test_DisplayMenu_host_portable, built without the SIMD path.
+void Test_blitMatchesReference(void)
+{
+  static const uint16_t colors[][2] = {{0xFFFF, 0x0000}, {0x0000, 0xFFFF}, {0xF800, 0x07E0}, {0x1234, 0x1234}};
+  unsigned char bits[BLIT_TEST_MAX_WIDTH / 8 + 2];
+  uint16_t line[BLIT_TEST_MAX_WIDTH + 1];
+  uint32_t seed = 7;
+  for (uint16_t i = 0; i < sizeof(bits); i++) {
+    seed = seed * 1103515245 + 12345;
+    bits[i] = (uint8_t)(seed >> 16);
+  }
+
+  for (uint8_t c = 0; c < sizeof(colors) / sizeof(colors[0]); c++) {
+    DisplayBlit blit(colors[c][0], colors[c][1]);
+    for (uint8_t offset = 0; offset < 2; offset++) {
+      const unsigned char *row = &bits[offset];
+      for (uint16_t width = 0; width <= BLIT_TEST_MAX_WIDTH; width++) {
+        for (uint8_t isRam = 0; isRam < 2; isRam++) {
+          for (uint16_t x = 0; x <= BLIT_TEST_MAX_WIDTH; x++) {
+            line[x] = BLIT_TEST_GUARD;
+          }
+          if (isRam) {
+            blit.expandRamRow(row, width, line);
+          } else {
+            blit.expandRow(row, width, line);
+          }
+          for (uint16_t x = 0; x < width; x++) {
+            uint16_t expected = (row[x >> 3] & (0x80 >> (x & 7))) ? colors[c][0] : colors[c][1];
+            TEST_ASSERT_EQUAL(expected, line[x]);
+          }
+          TEST_ASSERT_EQUAL(BLIT_TEST_GUARD, line[width]);
+        }
+      }
+    }
+  }
+}
+
+void Test_blitColorChange(void)
+{
+  const unsigned char bits[1] = {0xF0};
+  uint16_t line[8];
+  DisplayBlit blit;
+  blit.expandRow(bits, 8, line);
+  blit.setColors(0x001F, 0xF800);
+  blit.expandRow(bits, 8, line);
+  TEST_ASSERT_EQUAL(0x001F, line[0]);
+  TEST_ASSERT_EQUAL(0xF800, line[7]);
+}
+
+//#######################################################################
+// Grid menu
+//#######################################################################
+
+static int16_t gridTestValues[6];
+static DisplayWidget gridTestWidgets[6] = {
+    DisplayWidget(&gridTestValues[0], 1, 10), DisplayWidget(&gridTestValues[1], 1, 10),
+    DisplayWidget(&gridTestValues[2], 1, 10), DisplayWidget(&gridTestValues[3], 1, 10),
+    DisplayWidget(&gridTestValues[4], 1, 10), DisplayWidget(&gridTestValues[5], 1, 10)};
+
+// Queued inputs use the DisplayMenu navigation, they must land where the
+// constant folded moves do, wrapping included
+void Test_gridMenuQueuedMatchesDirect(void)
+{
+  static const DisplayInput moves[] = {DISPLAY_INPUT_DOWN, DISPLAY_INPUT_DOWN, DISPLAY_INPUT_DOWN, DISPLAY_INPUT_RIGHT,
+                                       DISPLAY_INPUT_RIGHT, DISPLAY_INPUT_UP, DISPLAY_INPUT_LEFT, DISPLAY_INPUT_DOWN};
+  DisplayGridMenu<3, 2> direct;
+  DisplayGridMenu<3, 2> queued;
+  DisplayInputQueue queue;
+  direct.setDisplayedWidgets(gridTestWidgets);
+  queued.setDisplayedWidgets(gridTestWidgets);
+
+  for (uint8_t i = 0; i < sizeof(moves) / sizeof(moves[0]); i++) {
+    switch (moves[i]) {
+      case DISPLAY_INPUT_UP:    direct.moveUp();    break;
+      case DISPLAY_INPUT_DOWN:  direct.moveDown();  break;
+      case DISPLAY_INPUT_LEFT:  direct.moveLeft();  break;
+      default:                  direct.moveRight(); break;
+    }
+    TEST_ASSERT_TRUE(queue.push(moves[i]));
+    TEST_ASSERT_EQUAL(1, queued.processInputs(queue));
+    TEST_ASSERT_EQUAL(direct.getCursorY(), queued.getCursorY());
+    TEST_ASSERT_EQUAL(direct.getCursorX(), queued.getCursorX());
+    TEST_ASSERT_EQUAL(direct.getTargetWidgetIdx(), queued.getTargetWidgetIdx());
+  }
+}
+
+//#######################################################################
+// Queued inputs
+//#######################################################################
+
+#define INPUT_TEST_WIDGET_NB (6)
+#define INPUT_TEST_LIST_ITEM_NB (7)
+#define INPUT_TEST_LIST_ROW_NB (3)
+
+static int inputTestValues[2][INPUT_TEST_LIST_ITEM_NB];
+
+static void applyDirect(DisplayMenu &menu, DisplayInput input)
+{
+  switch (input) {
+    case DISPLAY_INPUT_UP:    menu.moveUp();    break;
+    case DISPLAY_INPUT_DOWN:  menu.moveDown();  break;
+    case DISPLAY_INPUT_LEFT:  menu.moveLeft();  break;
+    case DISPLAY_INPUT_RIGHT: menu.moveRight(); break;
+    default:                  menu.interact();  break;
+  }
+}
+
+static bool isSameMenuState(DisplayMenu &a, DisplayMenu &b)
+{
+  return (a.getCursorX() == b.getCursorX()) && (a.getCursorY() == b.getCursorY()) &&
+         (a.getTargetWidgetIdx() == b.getTargetWidgetIdx()) && (a.getTargetItem() == b.getTargetItem()) &&
+         (a.isEditingTarget() == b.isEditingTarget()) &&
+         (memcmp(inputTestValues[0], inputTestValues[1], sizeof(inputTestValues[0])) == 0);
+}
+
+static DisplayWidget inputTestRow(uint32_t itemIdx, uint16_t viewRow, void *ctx)
+{
+  (void)viewRow;
+  return DisplayWidget(&((int *)ctx)[itemIdx], 1, 3);
+}
+
+// Random bursts of inputs (long runs, direction changes, edits) give the same
+// menu as the same calls made one by one
+static bool isQueuedLikeDirect(DisplayMenu &direct, DisplayMenu &queued, uint32_t seed)
+{
+  DisplayInputQueue queue;
+  for (uint16_t burst = 0; burst < 200; burst++) {
+    seed = seed * 1103515245 + 12345;
+    uint8_t eventNb = 1 + (seed >> 16) % DISPLAY_INPUT_QUEUE_SIZE;
+    for (uint8_t i = 0; i < eventNb; i++) {
+      seed = seed * 1103515245 + 12345;
+      uint8_t r = (seed >> 16) % 16;
+      // mostly vertical, few interactions, and some repeats of the previous key
+      DisplayInput input = (r < 5) ? DISPLAY_INPUT_DOWN : (r < 9) ? DISPLAY_INPUT_UP : (r < 11) ? DISPLAY_INPUT_RIGHT :
+                           (r < 13) ? DISPLAY_INPUT_LEFT : DISPLAY_INPUT_INTERACT;
+      applyDirect(direct, input);
+      if (!queue.push(input)) {
+        return false;
+      }
+    }
+    if ((queued.processInputs(queue) != eventNb) || !isSameMenuState(direct, queued)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Test_inputQueueRejectsNone(void)
+{
+  DisplayInputQueue queue;
+  TEST_ASSERT_FALSE(queue.push(DISPLAY_INPUT_NONE));
+  TEST_ASSERT_TRUE(queue.isEmpty());
+  TEST_ASSERT_TRUE(queue.push(DISPLAY_INPUT_DOWN));
+  TEST_ASSERT_EQUAL(DISPLAY_INPUT_DOWN, queue.pop());
+  TEST_ASSERT_EQUAL(DISPLAY_INPUT_NONE, queue.pop());
+}
+
+void Test_queuedMovesWrapLikeDirect(void)
+{
+  DisplayWidget widgets[3] = {DisplayWidget(&inputTestValues[0][0], 1, 3), DisplayWidget(&inputTestValues[0][1], 1, 3),
+                              DisplayWidget(&inputTestValues[0][2], 1, 3)};
+  DisplayMenu menu;
+  DisplayInputQueue queue;
+  menu.setDisplayedWidgets(widgets, 3);
+
+  // past the last row, then around again
+  menu.setCursor(0, 2);
+  queue.push(DISPLAY_INPUT_DOWN);
+  queue.push(DISPLAY_INPUT_DOWN);
+  queue.push(DISPLAY_INPUT_DOWN);
+  TEST_ASSERT_EQUAL(3, menu.processInputs(queue));
+  TEST_ASSERT_EQUAL(2, menu.getCursorY());
+
+  // up stops on the first row, down then moves from there
+  menu.setCursor(0, 0);
+  queue.push(DISPLAY_INPUT_UP);
+  queue.push(DISPLAY_INPUT_DOWN);
+  menu.processInputs(queue);
+  TEST_ASSERT_EQUAL(1, menu.getCursorY());
+}
+
+void Test_queuedInputsGridLikeDirect(void)
+{
+  DisplayWidget widgets[2][INPUT_TEST_WIDGET_NB] = {
+      {DisplayWidget(&inputTestValues[0][0], 1, 3), DisplayWidget(&inputTestValues[0][1], 1, 3),
+       DisplayWidget(&inputTestValues[0][2], 1, 3), DisplayWidget(&inputTestValues[0][3], 1, 3),
+       DisplayWidget(&inputTestValues[0][4], 1, 3), DisplayWidget(&inputTestValues[0][5], 1, 3)},
+      {DisplayWidget(&inputTestValues[1][0], 1, 3), DisplayWidget(&inputTestValues[1][1], 1, 3),
+       DisplayWidget(&inputTestValues[1][2], 1, 3), DisplayWidget(&inputTestValues[1][3], 1, 3),
+       DisplayWidget(&inputTestValues[1][4], 1, 3), DisplayWidget(&inputTestValues[1][5], 1, 3)}};
+  DisplayMenu menus[2];
+  memset(inputTestValues, 0, sizeof(inputTestValues));
+  for (uint8_t m = 0; m < 2; m++) {
+    menus[m].setDisplayedWidgets(widgets[m], 3, 2);
+  }
+  TEST_ASSERT_TRUE(isQueuedLikeDirect(menus[0], menus[1], 3));
+
+  // edits from the sides, up and down do nothing while editing
+  menus[0].setEditFromSides(true);
+  menus[1].setEditFromSides(true);
+  TEST_ASSERT_TRUE(isQueuedLikeDirect(menus[0], menus[1], 5));
+}
+
+void Test_queuedInputsListLikeDirect(void)
+{
+  DisplayWidgetSlot rows[2][INPUT_TEST_LIST_ROW_NB];
+  DisplayMenu menus[2];
+  memset(inputTestValues, 0, sizeof(inputTestValues));
+  for (uint8_t m = 0; m < 2; m++) {
+    menus[m].setDisplayedList(rows[m], INPUT_TEST_LIST_ROW_NB, INPUT_TEST_LIST_ITEM_NB, inputTestRow,
+                              inputTestValues[m]);
+  }
+  TEST_ASSERT_TRUE(isQueuedLikeDirect(menus[0], menus[1], 11));
+}
+
+void Test_queuedOverflowLikeDirect(void)
+{
+  DisplayWidget widgets[3] = {DisplayWidget(&inputTestValues[0][0], 1, 3), DisplayWidget(&inputTestValues[0][1], 1, 3),
+                              DisplayWidget(&inputTestValues[0][2], 1, 3)};
+  DisplayMenu menu;
+  DisplayInputQueue queue;
+  menu.setDisplayedWidgets(widgets, 3);
+
+  // 40 moves down on 3 rows, the last ones in the overflow counters
+  for (uint8_t i = 0; i < 40; i++) {
+    queue.push(DISPLAY_INPUT_DOWN);
+  }
+  TEST_ASSERT_EQUAL(40, menu.processInputs(queue));
+  TEST_ASSERT_EQUAL(40 % 3, menu.getCursorY());
+  TEST_ASSERT_TRUE(queue.isEmpty());
+}
+
+//#######################################################################
+// Held keys
+//#######################################################################
+
+#define HOLD_TEST_START_US (1000000UL)
+
+// Held key at a time since the start of the test, on the host test clock
+static void holdAt(DisplayMenu &menu, DisplayInput key, unsigned long ms)
+{
+  hostSetMicros(HOLD_TEST_START_US + ms * 1000);
+  menu.holdKey(key);
+}
+
+void Test_holdKeyRampStages(void)
+{
+  int value = 0;
+  DisplayWidget widgets[1] = {DisplayWidget(&value, 1, 100000)};
+  DisplayMenu menu;
+  widgets[0].setEditRamp(EDIT_RAMP_TIERED);
+  menu.setDisplayedWidgets(widgets, 1);
+  menu.interact();
+
+  holdAt(menu, DISPLAY_INPUT_UP, 0);
+  TEST_ASSERT_EQUAL(1, value);
+  holdAt(menu, DISPLAY_INPUT_UP, KEY_REPEAT_DELAY_MS - 1);
+  TEST_ASSERT_EQUAL(1, value);
+  holdAt(menu, DISPLAY_INPUT_UP, KEY_REPEAT_DELAY_MS);
+  TEST_ASSERT_EQUAL(2, value);
+  holdAt(menu, DISPLAY_INPUT_UP, KEY_REPEAT_DELAY_MS + KEY_REPEAT_PERIOD_MS - 1);
+  TEST_ASSERT_EQUAL(2, value);
+  holdAt(menu, DISPLAY_INPUT_UP, KEY_REPEAT_DELAY_MS + KEY_REPEAT_PERIOD_MS);
+  TEST_ASSERT_EQUAL(3, value);
+
+  // first tier, a late loop does a single repeat
+  holdAt(menu, DISPLAY_INPUT_UP, EDIT_RAMP_TIER1_MS);
+  TEST_ASSERT_EQUAL(3 + EDIT_RAMP_TIER1_FACTOR, value);
+  holdAt(menu, DISPLAY_INPUT_UP, EDIT_RAMP_TIER1_MS + KEY_REPEAT_PERIOD_MS);
+  TEST_ASSERT_EQUAL(3 + 2 * EDIT_RAMP_TIER1_FACTOR, value);
+  holdAt(menu, DISPLAY_INPUT_UP, EDIT_RAMP_TIER2_MS);
+  TEST_ASSERT_EQUAL(3 + 2 * EDIT_RAMP_TIER1_FACTOR + EDIT_RAMP_TIER2_FACTOR, value);
+  holdAt(menu, DISPLAY_INPUT_DOWN, EDIT_RAMP_TIER2_MS + 1);
+  TEST_ASSERT_EQUAL(2 + 2 * EDIT_RAMP_TIER1_FACTOR + EDIT_RAMP_TIER2_FACTOR, value);
+  hostReleaseClock();
+
+  TEST_ASSERT_EQUAL(1, widgets[0].getRampMultiplier(EDIT_RAMP_TIER1_MS - 1));
+  widgets[0].setEditRamp(EDIT_RAMP_EXPONENTIAL);
+  TEST_ASSERT_EQUAL(1, widgets[0].getRampMultiplier(EDIT_RAMP_DOUBLING_MS - 1));
+  TEST_ASSERT_EQUAL(2, widgets[0].getRampMultiplier(EDIT_RAMP_DOUBLING_MS));
+  TEST_ASSERT_EQUAL(8, widgets[0].getRampMultiplier(3 * EDIT_RAMP_DOUBLING_MS));
+  TEST_ASSERT_EQUAL(EDIT_RAMP_MAX_FACTOR, widgets[0].getRampMultiplier(100 * EDIT_RAMP_DOUBLING_MS));
+  widgets[0].setEditRamp(EDIT_RAMP_NONE);
+  TEST_ASSERT_EQUAL(1, widgets[0].getRampMultiplier(100 * EDIT_RAMP_DOUBLING_MS));
+}
+
+void Test_holdKeyRampAtLimits(void)
+{
+  int value = 95;
+  DisplayWidget widget(&value, 1, 100);
+
+  // a multiplied step stops on the limit, the next one wraps once
+  widget.increment(10);
+  TEST_ASSERT_EQUAL(100, value);
+  widget.increment(10);
+  TEST_ASSERT_EQUAL(0, value);
+  widget.increment(10);
+  TEST_ASSERT_EQUAL(10, value);
+  value = 3;
+  widget.decrement(10);
+  TEST_ASSERT_EQUAL(0, value);
+  widget.decrement(10);
+  TEST_ASSERT_EQUAL(100, value);
+
+  widget.setSaturating(true);
+  value = 95;
+  widget.increment(10);
+  widget.increment(10);
+  TEST_ASSERT_EQUAL(100, value);
+  widget.decrement(1000);
+  widget.decrement(10);
+  TEST_ASSERT_EQUAL(0, value);
+
+  // steps are 16 bits, larger ones are clamped
+  int far = 0;
+  DisplayWidget clamped(&far, 100000, INT32_MAX);
+  clamped.increment();
+  TEST_ASSERT_EQUAL(UINT16_MAX, far);
+
+  // the largest step at the int limits does not overflow
+  int big = INT32_MAX - 5;
+  DisplayWidget wide(&big, UINT16_MAX, INT32_MAX, INT32_MIN);
+  wide.increment(EDIT_RAMP_MAX_FACTOR);
+  TEST_ASSERT_EQUAL(INT32_MAX, big);
+  wide.increment(EDIT_RAMP_MAX_FACTOR);
+  TEST_ASSERT_EQUAL(INT32_MIN, big);
+  wide.decrement(EDIT_RAMP_MAX_FACTOR);
+  TEST_ASSERT_EQUAL(INT32_MAX, big);
+
+  // held: the ramp lands on the ceiling, then wraps to the floor
+  DisplayWidget widgets[1] = {DisplayWidget(&value, 1, 100)};
+  DisplayMenu menu;
+  widgets[0].setEditRamp(EDIT_RAMP_TIERED);
+  menu.setDisplayedWidgets(widgets, 1);
+  menu.interact();
+  value = 50;
+  holdAt(menu, DISPLAY_INPUT_UP, 0);
+  holdAt(menu, DISPLAY_INPUT_UP, EDIT_RAMP_TIER2_MS);
+  TEST_ASSERT_EQUAL(100, value);
+  holdAt(menu, DISPLAY_INPUT_UP, EDIT_RAMP_TIER2_MS + KEY_REPEAT_PERIOD_MS);
+  TEST_ASSERT_EQUAL(0, value);
+  widgets[0].setSaturating(true);
+  holdAt(menu, DISPLAY_INPUT_DOWN, EDIT_RAMP_TIER2_MS + 2 * KEY_REPEAT_PERIOD_MS);
+  TEST_ASSERT_EQUAL(0, value);
+  hostReleaseClock();
+}
+
+void Test_holdKeyRampResetsOnRelease(void)
+{
+  int value = 0;
+  DisplayWidget widgets[1] = {DisplayWidget(&value, 1, 100000)};
+  DisplayMenu menu;
+  widgets[0].setEditRamp(EDIT_RAMP_TIERED);
+  menu.setDisplayedWidgets(widgets, 1);
+  menu.interact();
+
+  holdAt(menu, DISPLAY_INPUT_UP, 0);
+  holdAt(menu, DISPLAY_INPUT_UP, EDIT_RAMP_TIER2_MS);
+  TEST_ASSERT_EQUAL(1 + EDIT_RAMP_TIER2_FACTOR, value);
+
+  // released: the next press steps once, and waits the repeat delay at x1
+  holdAt(menu, DISPLAY_INPUT_NONE, EDIT_RAMP_TIER2_MS + 10);
+  holdAt(menu, DISPLAY_INPUT_NONE, EDIT_RAMP_TIER2_MS + 500);
+  TEST_ASSERT_EQUAL(1 + EDIT_RAMP_TIER2_FACTOR, value);
+  unsigned long pressMs = EDIT_RAMP_TIER2_MS + 600;
+  holdAt(menu, DISPLAY_INPUT_UP, pressMs);
+  TEST_ASSERT_EQUAL(2 + EDIT_RAMP_TIER2_FACTOR, value);
+  holdAt(menu, DISPLAY_INPUT_UP, pressMs + KEY_REPEAT_DELAY_MS - 1);
+  TEST_ASSERT_EQUAL(2 + EDIT_RAMP_TIER2_FACTOR, value);
+  holdAt(menu, DISPLAY_INPUT_UP, pressMs + KEY_REPEAT_DELAY_MS);
+  TEST_ASSERT_EQUAL(3 + EDIT_RAMP_TIER2_FACTOR, value);
+
+  // another key restarts the ramp too
+  holdAt(menu, DISPLAY_INPUT_DOWN, pressMs + EDIT_RAMP_TIER2_MS);
+  TEST_ASSERT_EQUAL(2 + EDIT_RAMP_TIER2_FACTOR, value);
+  holdAt(menu, DISPLAY_INPUT_DOWN, pressMs + EDIT_RAMP_TIER2_MS + KEY_REPEAT_DELAY_MS);
+  TEST_ASSERT_EQUAL(1 + EDIT_RAMP_TIER2_FACTOR, value);
+  hostReleaseClock();
+}
+
+//#######################################################################
+// Frame schedule
+//#######################################################################
+
+#define BUDGET_TEST_PRINT_US (600)   // time taken by each widget print
+#define BUDGET_TEST_WIDGET_NB (6)
+
+static int budgetTestValues[BUDGET_TEST_WIDGET_NB];
+static DisplayWidget budgetTestWidgets[BUDGET_TEST_WIDGET_NB] = {
+    DisplayWidget(&budgetTestValues[0], 1, 100), DisplayWidget(&budgetTestValues[1], 1, 100),
+    DisplayWidget(&budgetTestValues[2], 1, 100), DisplayWidget(&budgetTestValues[3], 1, 100),
+    DisplayWidget(&budgetTestValues[4], 1, 100), DisplayWidget(&budgetTestValues[5], 1, 100)};
+
+// prints the scheduled widgets, each advancing the clock, returns how many
+static uint8_t printBudgetFrame(DisplayMenu &menu, uint16_t *printed)
+{
+  uint8_t nb = 0;
+  for (bool isPrinting = menu.startDirtyPrint(); isPrinting; isPrinting = menu.nextDirtyPrint()) {
+    printed[nb++] = menu.getPrintWidgetIdx();
+    hostSetMicros(micros() + BUDGET_TEST_PRINT_US);
+  }
+  return nb;
+}
+
+// widgets 1, 3 and 4 are low priority
+static void setBudgetTestPage(DisplayMenu &menu)
+{
+  budgetTestWidgets[1].setLowPriority(true);
+  budgetTestWidgets[3].setLowPriority(true);
+  budgetTestWidgets[4].setLowPriority(true);
+  menu.setDisplayedWidgets(budgetTestWidgets, BUDGET_TEST_WIDGET_NB);
+}
+
+void Test_frameBudgetDefersLowPriority(void)
+{
+  DisplayMenu menu;
+  uint16_t printed[BUDGET_TEST_WIDGET_NB];
+  hostSetMicros(HOLD_TEST_START_US);
+  setBudgetTestPage(menu);
+  menu.setFrameSchedule(20, 1000);
+
+  // over budget from the second widget on: the others still print, then one low priority
+  TEST_ASSERT_TRUE(menu.isFrameDue());
+  TEST_ASSERT_EQUAL(4, printBudgetFrame(menu, printed));
+  TEST_ASSERT_EQUAL(0, printed[0]);
+  TEST_ASSERT_EQUAL(2, printed[1]);
+  TEST_ASSERT_EQUAL(5, printed[2]);
+  TEST_ASSERT_EQUAL(1, printed[3]);
+  TEST_ASSERT_TRUE(menu.hasDeferredWidgets());
+  TEST_ASSERT_EQUAL(3, menu.nextDirtyWidget(0));
+  TEST_ASSERT_EQUAL(4, menu.nextDirtyWidget(4));
+  TEST_ASSERT_EQUAL(NO_DIRTY_WIDGET, menu.nextDirtyWidget(5));
+
+  // the deferred widgets keep the menu changed, and print on the next frame
+  TEST_ASSERT_TRUE(menu.isChanged());
+  TEST_ASSERT_TRUE(menu.isChanged());
+  TEST_ASSERT_FALSE(menu.isFrameDue());
+  hostSetMicros(HOLD_TEST_START_US + 20000);
+  TEST_ASSERT_TRUE(menu.isFrameDue());
+  TEST_ASSERT_EQUAL(2, printBudgetFrame(menu, printed));
+  TEST_ASSERT_EQUAL(3, printed[0]);
+  TEST_ASSERT_EQUAL(4, printed[1]);
+  TEST_ASSERT_FALSE(menu.hasDeferredWidgets());
+  TEST_ASSERT_FALSE(menu.isChanged());
+  hostSetMicros(HOLD_TEST_START_US + 40000);
+  TEST_ASSERT_FALSE(menu.isFrameDue());
+
+  // within budget nothing is deferred
+  menu.markAllWidgetsDirty();
+  menu.setFrameSchedule(20, BUDGET_TEST_WIDGET_NB * BUDGET_TEST_PRINT_US);
+  TEST_ASSERT_TRUE(menu.isFrameDue());
+  TEST_ASSERT_EQUAL(BUDGET_TEST_WIDGET_NB, printBudgetFrame(menu, printed));
+  TEST_ASSERT_FALSE(menu.hasDeferredWidgets());
+  hostReleaseClock();
+}
+
+void Test_frameBudgetDoesNotStarve(void)
+{
+  DisplayMenu menu;
+  uint16_t printed[BUDGET_TEST_WIDGET_NB];
+  hostSetMicros(HOLD_TEST_START_US);
+  setBudgetTestPage(menu);
+  menu.setFrameSchedule(0, 1);   // always over budget
+
+  TEST_ASSERT_TRUE(menu.isFrameDue());
+  TEST_ASSERT_EQUAL(4, printBudgetFrame(menu, printed));
+  TEST_ASSERT_EQUAL(1, printed[3]);
+
+  // a widget changing every frame goes first, and each frame still prints one low priority widget
+  menu.flagWidgetChange(0);
+  TEST_ASSERT_TRUE(menu.isFrameDue());
+  TEST_ASSERT_EQUAL(2, printBudgetFrame(menu, printed));
+  TEST_ASSERT_EQUAL(0, printed[0]);
+  TEST_ASSERT_EQUAL(3, printed[1]);
+  TEST_ASSERT_TRUE(menu.hasDeferredWidgets());
+
+  menu.flagWidgetChange(0);
+  TEST_ASSERT_TRUE(menu.isFrameDue());
+  TEST_ASSERT_EQUAL(2, printBudgetFrame(menu, printed));
+  TEST_ASSERT_EQUAL(0, printed[0]);
+  TEST_ASSERT_EQUAL(4, printed[1]);
+  TEST_ASSERT_FALSE(menu.hasDeferredWidgets());
+  TEST_ASSERT_EQUAL(NO_DIRTY_WIDGET, menu.nextDirtyWidget(0));
+  TEST_ASSERT_FALSE(menu.isFrameDue());
+  TEST_ASSERT_FALSE(menu.startDirtyPrint());
+  hostReleaseClock();
+}
+
+void Test_deadlineFramePeriod(void)
+{
+  DisplayMenu menu;
+  uint16_t printed[BUDGET_TEST_WIDGET_NB];
+  hostSetMicros(HOLD_TEST_START_US);
+  setBudgetTestPage(menu);
+  menu.setFrameSchedule(20);
+
+  // a new page is due right away, then the menu is idle
+  TEST_ASSERT_EQUAL(0, menu.getNextDeadlineMs());
+  TEST_ASSERT_TRUE(menu.isFrameDue());
+  printBudgetFrame(menu, printed);
+  TEST_ASSERT_EQUAL(DISPLAY_DEADLINE_NEVER, menu.getNextDeadlineMs());
+  hostSetMicros(HOLD_TEST_START_US + 50000);
+  TEST_ASSERT_EQUAL(DISPLAY_DEADLINE_NEVER, menu.getNextDeadlineMs());
+
+  // a change waits for the end of the period
+  menu.flagWidgetChange(2);
+  TEST_ASSERT_TRUE(menu.isFrameDue());
+  printBudgetFrame(menu, printed);
+  hostSetMicros(HOLD_TEST_START_US + 55000);
+  menu.flagWidgetChange(2);
+  TEST_ASSERT_EQUAL(15, menu.getNextDeadlineMs());
+  hostSetMicros(HOLD_TEST_START_US + 69999);
+  TEST_ASSERT_EQUAL(1, menu.getNextDeadlineMs());
+  TEST_ASSERT_FALSE(menu.isFrameDue());
+  hostSetMicros(HOLD_TEST_START_US + 70000);
+  TEST_ASSERT_EQUAL(0, menu.getNextDeadlineMs());
+  TEST_ASSERT_TRUE(menu.isFrameDue());
+  printBudgetFrame(menu, printed);
+  TEST_ASSERT_EQUAL(DISPLAY_DEADLINE_NEVER, menu.getNextDeadlineMs());
+
+  // deferred widgets wait for the next frame too
+  hostSetMicros(HOLD_TEST_START_US + 100000);
+  menu.setFrameSchedule(20, 1);
+  menu.markAllWidgetsDirty();
+  TEST_ASSERT_TRUE(menu.isFrameDue());
+  printBudgetFrame(menu, printed);
+  TEST_ASSERT_TRUE(menu.hasDeferredWidgets());
+  menu.isChanged();
+  TEST_ASSERT_EQUAL(20 - 4 * BUDGET_TEST_PRINT_US / 1000, menu.getNextDeadlineMs());
+  hostReleaseClock();
+}
+
+void Test_deadlineHeldKey(void)
+{
+  DisplayMenu menu;
+  uint16_t printed[BUDGET_TEST_WIDGET_NB];
+  hostSetMicros(HOLD_TEST_START_US);
+  setBudgetTestPage(menu);
+  menu.setFrameSchedule(20);
+  TEST_ASSERT_TRUE(menu.isFrameDue());
+  printBudgetFrame(menu, printed);
+
+  // the repeat comes KEY_REPEAT_DELAY_MS after the first move, then every KEY_REPEAT_PERIOD_MS
+  holdAt(menu, DISPLAY_INPUT_DOWN, 20);
+  TEST_ASSERT_EQUAL(0, menu.getNextDeadlineMs());
+  TEST_ASSERT_TRUE(menu.isFrameDue());
+  printBudgetFrame(menu, printed);
+  hostSetMicros(HOLD_TEST_START_US + 25000);
+  TEST_ASSERT_EQUAL(KEY_REPEAT_DELAY_MS - 5, menu.getNextDeadlineMs());
+  holdAt(menu, DISPLAY_INPUT_DOWN, 20 + KEY_REPEAT_DELAY_MS);
+  TEST_ASSERT_TRUE(menu.isFrameDue());
+  printBudgetFrame(menu, printed);
+  hostSetMicros(HOLD_TEST_START_US + (20 + KEY_REPEAT_DELAY_MS + 30) * 1000);
+  TEST_ASSERT_EQUAL(KEY_REPEAT_PERIOD_MS - 30, menu.getNextDeadlineMs());
+
+  // a frame sooner than the repeat
+  menu.flagWidgetChange(0);
+  TEST_ASSERT_EQUAL(0, menu.getNextDeadlineMs());
+  TEST_ASSERT_TRUE(menu.isFrameDue());
+  menu.flagWidgetChange(0);
+  TEST_ASSERT_EQUAL(10, menu.getNextDeadlineMs());
+  hostSetMicros(HOLD_TEST_START_US + (20 + KEY_REPEAT_DELAY_MS + 40) * 1000);
+  TEST_ASSERT_TRUE(menu.isFrameDue());
+  printBudgetFrame(menu, printed);
+
+  // released, or held interact: no repeat to wait for
+  holdAt(menu, DISPLAY_INPUT_NONE, 20 + KEY_REPEAT_DELAY_MS + 100);
+  TEST_ASSERT_EQUAL(DISPLAY_DEADLINE_NEVER, menu.getNextDeadlineMs());
+  holdAt(menu, DISPLAY_INPUT_INTERACT, 20 + KEY_REPEAT_DELAY_MS + 100);
+  TEST_ASSERT_TRUE(menu.isFrameDue());
+  printBudgetFrame(menu, printed);
+  TEST_ASSERT_EQUAL(DISPLAY_DEADLINE_NEVER, menu.getNextDeadlineMs());
+  hostReleaseClock();
+}
+
+//#######################################################################
+// Typed values
+//#######################################################################
+
+void Test_typedValueUnsignedLimits(void)
+{
+  static uint8_t level = 0;
+  static const DisplayValueRange<uint8_t> levelRange = {&level, 1, 0, 255};
+  DisplayWidget levelWidget(levelRange);
+  levelWidget.decrement();
+  TEST_ASSERT_EQUAL(255, level);
+  levelWidget.increment();
+  TEST_ASSERT_EQUAL(0, level);
+  levelWidget.setSaturating(true);
+  levelWidget.decrement(5);
+  TEST_ASSERT_EQUAL(0, level);
+
+  // near UINT32_MAX, computed in 64 bits
+  static uint32_t count = UINT32_MAX - 10;
+  static const DisplayValueRange<uint32_t> countRange = {&count, 1000, 0, UINT32_MAX};
+  DisplayWidget countWidget(countRange);
+  countWidget.increment(1024);
+  TEST_ASSERT_TRUE(count == UINT32_MAX);
+  countWidget.increment(1024);
+  TEST_ASSERT_EQUAL(0, count);
+  countWidget.decrement();
+  TEST_ASSERT_TRUE(count == UINT32_MAX);
+  count = 999;
+  countWidget.decrement();
+  TEST_ASSERT_TRUE(count == UINT32_MAX);
+}
+
+void Test_typedValueSignedLimits(void)
+{
+  static int8_t offset = 95;
+  static const DisplayValueRange<int8_t> offsetRange = {&offset, 10, -100, 100};
+  DisplayWidget offsetWidget(offsetRange);
+  offsetWidget.increment();
+  TEST_ASSERT_EQUAL(-100, offset);
+  offsetWidget.decrement();
+  TEST_ASSERT_EQUAL(100, offset);
+  offsetWidget.setSaturating(true);
+  offsetWidget.increment();
+  TEST_ASSERT_EQUAL(100, offset);
+  offset = -95;
+  offsetWidget.decrement(3);
+  TEST_ASSERT_EQUAL(-100, offset);
+
+  static int16_t temp = INT16_MAX - 5;
+  static const DisplayValueRange<int16_t> tempRange = {&temp, 10, INT16_MIN, INT16_MAX};
+  DisplayWidget tempWidget(tempRange);
+  tempWidget.increment();
+  TEST_ASSERT_EQUAL(INT16_MIN, temp);
+  tempWidget.decrement();
+  TEST_ASSERT_EQUAL(INT16_MAX, temp);
+  tempWidget.setSaturating(true);
+  tempWidget.increment(100);
+  TEST_ASSERT_EQUAL(INT16_MAX, temp);
+  temp = INT16_MIN + 3;
+  tempWidget.decrement();
+  TEST_ASSERT_EQUAL(INT16_MIN, temp);
+
+  static int32_t pos = INT32_MIN + 1;
+  static const DisplayValueRange<int32_t> posRange = {&pos, 1000, INT32_MIN, INT32_MAX};
+  DisplayWidget posWidget(posRange);
+  posWidget.decrement(1024);
+  TEST_ASSERT_EQUAL(INT32_MIN, pos);
+  posWidget.decrement(1024);
+  TEST_ASSERT_EQUAL(INT32_MAX, pos);
+}
+
+void Test_typedValueFloatSteps(void)
+{
+  static float gain = 0.0f;
+  static const DisplayValueRange<float> gainRange = {&gain, 0.1f, 0.0f, 1.0f};
+  DisplayWidget gainWidget(gainRange);
+
+  // rounding errors of the steps do not wrap before the ceiling
+  for (uint8_t i = 0; i < 10; i++) {
+    gainWidget.increment();
+  }
+  TEST_ASSERT_TRUE(gain == 1.0f);
+  gainWidget.increment();
+  TEST_ASSERT_TRUE(gain == 0.0f);
+  gainWidget.decrement();
+  TEST_ASSERT_TRUE(gain == 1.0f);
+  for (uint8_t i = 0; i < 10; i++) {
+    gainWidget.decrement();
+  }
+  TEST_ASSERT_TRUE(fabsf(gain) < 0.001f);
+  gainWidget.decrement();
+  TEST_ASSERT_TRUE(gain == 1.0f);
+
+  gain = 0.55f;
+  gainWidget.increment(10);
+  TEST_ASSERT_TRUE(gain == 1.0f);
+  gainWidget.setSaturating(true);
+  gainWidget.increment();
+  TEST_ASSERT_TRUE(gain == 1.0f);
+}
+
+//#######################################################################
+// Page stack
+//#######################################################################
+
+#define PAGE_TEST_SLOT_NB (6)
+
+static int pageTestValues[PAGE_TEST_SLOT_NB + 1];
+static uint8_t pageTestLevel;
+static const DisplayValueRange<uint8_t> pageTestLevelRange = {&pageTestLevel, 1, 0, 100};
+static uint16_t pageTestValueNb;   // value widgets added by the next build
+static uint8_t pageTestReleaseNb;
+
+static void pageTestAction() {}
+static void releasePageTest() { pageTestReleaseNb++; }
+
+static void buildPageTestValues(DisplayPageStack &pages)
+{
+  for (uint16_t i = 0; i < pageTestValueNb; i++) {
+    pages.addWidget(DisplayWidget(&pageTestValues[i], 1, 100));
+  }
+}
+
+static void buildPageTestGrid(DisplayPageStack &pages)
+{
+  pageTestValueNb = 4;
+  buildPageTestValues(pages);
+  pages.setGrid(2, 2);
+}
+
+static void buildPageTestBar(DisplayPageStack &pages)
+{
+  pages.addWidget(DisplayWidget(pageTestLevelRange, BAR_LEFT_TO_RIGHT, 0, 0, 50, 10));
+  buildPageTestValues(pages);
+}
+
+static DisplayWidget pageTestRoot[4] = {DisplayWidget(pageTestAction), DisplayWidget(pageTestAction),
+                                        DisplayWidget(pageTestAction), DisplayWidget(pageTestAction)};
+static const DisplayPage pageTestRootPage = {NULL, NULL, pageTestRoot, 2, 2};
+
+void Test_pageStackPopRestoresCursor(void)
+{
+  static DisplayWidgetSlot slots[PAGE_TEST_SLOT_NB];
+  const DisplayPage gridPage = {buildPageTestGrid, releasePageTest, NULL, 0, 0};
+  DisplayMenu menu;
+  DisplayPageStack pages(menu, slots, PAGE_TEST_SLOT_NB);
+  pageTestReleaseNb = 0;
+
+  TEST_ASSERT_TRUE(pages.push(pageTestRootPage));
+  menu.moveDown();
+  menu.moveRight();
+  TEST_ASSERT_EQUAL(3, menu.getTargetItem());
+
+  TEST_ASSERT_TRUE(pages.push(gridPage));
+  TEST_ASSERT_EQUAL(2, pages.getDepth());
+  TEST_ASSERT_EQUAL(4, pages.getUsedSlotNb());
+  TEST_ASSERT_TRUE(menu.getWidget(0) == &slots[0].widget);
+  TEST_ASSERT_EQUAL(0, menu.getTargetItem());
+  menu.moveRight();
+
+  TEST_ASSERT_TRUE(pages.pop());
+  TEST_ASSERT_EQUAL(1, pages.getDepth());
+  TEST_ASSERT_EQUAL(0, pages.getUsedSlotNb());
+  TEST_ASSERT_EQUAL(1, pageTestReleaseNb);
+  TEST_ASSERT_TRUE(menu.getWidget(0) == &pageTestRoot[0]);
+  TEST_ASSERT_EQUAL(4, menu.getWidgetNb());
+  TEST_ASSERT_EQUAL(1, menu.getCursorX());
+  TEST_ASSERT_EQUAL(1, menu.getCursorY());
+  TEST_ASSERT_EQUAL(3, menu.getTargetItem());
+  TEST_ASSERT_FALSE(pages.pop());
+
+  // each level keeps its own cursor, popToRoot goes back to the root one
+  menu.moveUp();
+  TEST_ASSERT_TRUE(pages.push(gridPage));
+  menu.moveDown();
+  TEST_ASSERT_TRUE(pages.push(pageTestRootPage));
+  pages.popToRoot();
+  TEST_ASSERT_EQUAL(1, pages.getDepth());
+  TEST_ASSERT_EQUAL(2, menu.getTargetItem());
+  TEST_ASSERT_EQUAL(2, pageTestReleaseNb);
+}
+
+void Test_pageStackFailedPushKeepsPage(void)
+{
+  static DisplayWidgetSlot slots[PAGE_TEST_SLOT_NB];
+  const DisplayPage valuesPage = {buildPageTestValues, releasePageTest, NULL, 0, 0};
+  const DisplayPage gridPage = {buildPageTestGrid, NULL, NULL, 0, 0};
+  const DisplayPage emptyPage = {NULL, NULL, NULL, 2, 2};
+  DisplayMenu menu;
+  DisplayPageStack pages(menu, slots, PAGE_TEST_SLOT_NB);
+  pageTestReleaseNb = 0;
+
+  pages.push(pageTestRootPage);
+  menu.moveDown();
+  uint16_t pageChangeNb = menu.getPageChangeNb();
+
+  // more widgets than slots, no widget, no static widgets
+  pageTestValueNb = PAGE_TEST_SLOT_NB + 1;
+  TEST_ASSERT_FALSE(pages.push(valuesPage));
+  TEST_ASSERT_EQUAL(1, pageTestReleaseNb);
+  pageTestValueNb = 0;
+  TEST_ASSERT_FALSE(pages.push(valuesPage));
+  TEST_ASSERT_FALSE(pages.push(emptyPage));
+  TEST_ASSERT_EQUAL(1, pages.getDepth());
+  TEST_ASSERT_EQUAL(0, pages.getUsedSlotNb());
+  TEST_ASSERT_TRUE(pages.getCurrentPage() == &pageTestRootPage);
+  TEST_ASSERT_TRUE(menu.getWidget(0) == &pageTestRoot[0]);
+  TEST_ASSERT_EQUAL(4, menu.getWidgetNb());
+  TEST_ASSERT_EQUAL(1, menu.getTargetItem());
+  TEST_ASSERT_EQUAL(pageChangeNb, menu.getPageChangeNb());
+
+  // a built page over the slots left by its parent
+  TEST_ASSERT_TRUE(pages.push(gridPage));
+  pageTestValueNb = PAGE_TEST_SLOT_NB - 3;
+  TEST_ASSERT_FALSE(pages.push(valuesPage));
+  TEST_ASSERT_EQUAL(2, pages.getDepth());
+  TEST_ASSERT_EQUAL(4, pages.getUsedSlotNb());
+  TEST_ASSERT_TRUE(menu.getWidget(3) == &slots[3].widget);
+  TEST_ASSERT_EQUAL(4, menu.getWidgetNb());
+
+  // full stack
+  while (pages.getDepth() < MAX_PAGE_DEPTH) {
+    TEST_ASSERT_TRUE(pages.push(pageTestRootPage));
+  }
+  menu.moveRight();
+  pageChangeNb = menu.getPageChangeNb();
+  TEST_ASSERT_FALSE(pages.push(gridPage));
+  TEST_ASSERT_EQUAL(MAX_PAGE_DEPTH, pages.getDepth());
+  TEST_ASSERT_EQUAL(2, menu.getTargetItem());
+  TEST_ASSERT_EQUAL(pageChangeNb, menu.getPageChangeNb());
+  TEST_ASSERT_TRUE(pages.pop());
+  TEST_ASSERT_EQUAL(0, menu.getTargetItem());
+}
+
+void Test_pageStackSlotReuse(void)
+{
+  static DisplayWidgetSlot slots[PAGE_TEST_SLOT_NB];
+  const DisplayPage barPage = {buildPageTestBar, NULL, NULL, 0, 0};
+  const DisplayPage valuesPage = {buildPageTestValues, NULL, NULL, 0, 0};
+  DisplayMenu menu;
+  DisplayPageStack pages(menu, slots, PAGE_TEST_SLOT_NB);
+
+  pages.push(pageTestRootPage);
+  pageTestValueNb = 4;
+  TEST_ASSERT_TRUE(pages.push(barPage));
+  TEST_ASSERT_EQUAL(5, menu.getWidgetNb());
+  slots[0].widget.setBarDrawn(10, 0x1234);
+  menu.moveDown(4);
+  menu.interact();
+  TEST_ASSERT_TRUE(menu.isEditingTarget());
+  menu.clearDirtyWidgets();
+  menu.markWidgetDirty(4);
+  TEST_ASSERT_TRUE(pages.pop());
+  TEST_ASSERT_FALSE(menu.isEditingTarget());
+
+  // the new page gets fresh widgets, and only its own are dirty
+  pageTestValueNb = 2;
+  TEST_ASSERT_TRUE(pages.push(valuesPage));
+  TEST_ASSERT_EQUAL(2, menu.getWidgetNb());
+  TEST_ASSERT_NULL(menu.getWidget(2));
+  TEST_ASSERT_EQUAL(WIDGET_KIND_VALUE, slots[0].widget.getKind());
+  TEST_ASSERT_EQUAL(-1, slots[0].widget.getBarDrawnExtent());
+  TEST_ASSERT_TRUE(slots[0].widget.getValuePtr() == &pageTestValues[0]);
+  TEST_ASSERT_TRUE(menu.isWidgetDirty(0));
+  TEST_ASSERT_TRUE(menu.isWidgetDirty(1));
+  TEST_ASSERT_FALSE(menu.isWidgetDirty(4));
+  TEST_ASSERT_EQUAL(NO_DIRTY_WIDGET, menu.nextDirtyWidget(2));
+  TEST_ASSERT_FALSE(menu.isEditingTarget());
+  TEST_ASSERT_EQUAL(0, menu.getTargetItem());
+
+  // back on the bar page: built again, drawn from scratch
+  TEST_ASSERT_TRUE(pages.pop());
+  TEST_ASSERT_TRUE(pages.push(barPage));
+  TEST_ASSERT_EQUAL(-1, slots[0].widget.getBarDrawnExtent());
+  TEST_ASSERT_EQUAL(WIDGET_KIND_BAR, slots[0].widget.getKind());
+}
+
+//#######################################################################
+// Virtual list
+//#######################################################################
+
+#define LIST_TEST_ITEM_NB (100)
+#define LIST_TEST_ROW_NB (4)
+#define LIST_TEST_ROW_HEIGHT (16)
+
+static int listTestItems[LIST_TEST_ITEM_NB];
+static uint16_t listTestBuiltNb;
+
+static DisplayWidget listTestRow(uint32_t itemIdx, uint16_t viewRow, void *ctx)
+{
+  (void)ctx;
+  listTestBuiltNb++;
+  return DisplayWidget(&listTestItems[itemIdx], 1, 10, 0, 0, viewRow * LIST_TEST_ROW_HEIGHT, 100,
+                       LIST_TEST_ROW_HEIGHT);
+}
+
+// Each viewport row shows the item at its place, with the geometry of the row
+static bool isListViewportValid(DisplayMenu &menu)
+{
+  for (uint16_t row = 0; row < menu.getWidgetNb(); row++) {
+    DisplayWidget *wdg = menu.getWidget(row);
+    if ((wdg->getValuePtr() != &listTestItems[menu.getListFirstItem() + row]) ||
+        (wdg->getYPostion() != row * LIST_TEST_ROW_HEIGHT)) {
+      return false;
+    }
+  }
+  uint32_t item = menu.getTargetItem();
+  return (item >= menu.getListFirstItem()) && (item < menu.getListFirstItem() + menu.getWidgetNb());
+}
+
+void Test_listScrollsByEnteringRows(void)
+{
+  static DisplayWidgetSlot rows[LIST_TEST_ROW_NB];
+  DisplayMenu menu;
+  listTestBuiltNb = 0;
+  menu.setDisplayedList(rows, LIST_TEST_ROW_NB, LIST_TEST_ITEM_NB, listTestRow);
+  TEST_ASSERT_EQUAL(LIST_TEST_ROW_NB, listTestBuiltNb);
+  TEST_ASSERT_EQUAL(LIST_TEST_ROW_NB, menu.getWidgetNb());
+
+  // inside the viewport, nothing is built
+  listTestBuiltNb = 0;
+  menu.moveDown(LIST_TEST_ROW_NB - 1);
+  TEST_ASSERT_EQUAL(0, listTestBuiltNb);
+  TEST_ASSERT_EQUAL(0, menu.getListFirstItem());
+
+  // one row further, only the entering item is built
+  menu.moveDown();
+  TEST_ASSERT_EQUAL(1, listTestBuiltNb);
+  TEST_ASSERT_EQUAL(1, menu.getListFirstItem());
+  TEST_ASSERT_EQUAL(LIST_TEST_ROW_NB, menu.getTargetItem());
+  TEST_ASSERT_EQUAL(LIST_TEST_ROW_NB - 1, menu.getTargetWidgetIdx());
+  TEST_ASSERT_TRUE(isListViewportValid(menu));
+
+  // back to the top
+  listTestBuiltNb = 0;
+  menu.moveUp(LIST_TEST_ROW_NB);
+  TEST_ASSERT_EQUAL(1, listTestBuiltNb);
+  TEST_ASSERT_EQUAL(0, menu.getTargetItem());
+  TEST_ASSERT_TRUE(isListViewportValid(menu));
+
+  // a jump rebuilds the whole viewport, the target on the last row
+  listTestBuiltNb = 0;
+  menu.moveDown(50);
+  TEST_ASSERT_EQUAL(LIST_TEST_ROW_NB, listTestBuiltNb);
+  TEST_ASSERT_EQUAL(50, menu.getTargetItem());
+  TEST_ASSERT_EQUAL(50 - LIST_TEST_ROW_NB + 1, menu.getListFirstItem());
+  TEST_ASSERT_TRUE(isListViewportValid(menu));
+
+  // past the last item, back to the first one
+  menu.moveDown(LIST_TEST_ITEM_NB - 50 - 1);
+  TEST_ASSERT_EQUAL(LIST_TEST_ITEM_NB - 1, menu.getTargetItem());
+  menu.moveDown();
+  TEST_ASSERT_EQUAL(0, menu.getTargetItem());
+  TEST_ASSERT_EQUAL(0, menu.getListFirstItem());
+  TEST_ASSERT_TRUE(isListViewportValid(menu));
+}
+
+void Test_listChange(void)
+{
+  static DisplayWidgetSlot rows[LIST_TEST_ROW_NB];
+  DisplayListChange change;
+  DisplayMenu menu;
+  menu.setDisplayedList(rows, LIST_TEST_ROW_NB, LIST_TEST_ITEM_NB, listTestRow);
+  TEST_ASSERT_FALSE(menu.getListChange(change));
+
+  // scrolled by 2 rows: items 0 and 1 left, 4 and 5 entered
+  menu.moveDown(LIST_TEST_ROW_NB + 1);
+  TEST_ASSERT_TRUE(menu.getListChange(change));
+  TEST_ASSERT_EQUAL(0, change.leftFirst);
+  TEST_ASSERT_EQUAL(2, change.leftNb);
+  TEST_ASSERT_EQUAL(LIST_TEST_ROW_NB, change.enteredFirst);
+  TEST_ASSERT_EQUAL(2, change.enteredNb);
+  menu.ackListChange();
+  TEST_ASSERT_FALSE(menu.getListChange(change));
+
+  // scrolled back by more than the viewport: every row changed
+  menu.moveDown(20);
+  menu.ackListChange();
+  menu.moveUp(20);
+  TEST_ASSERT_TRUE(menu.getListChange(change));
+  TEST_ASSERT_EQUAL(LIST_TEST_ROW_NB, change.enteredNb);
+  TEST_ASSERT_EQUAL(LIST_TEST_ROW_NB, change.leftNb);
+  TEST_ASSERT_EQUAL(menu.getListFirstItem(), change.enteredFirst);
+}
+
+void Test_listItemNbChange(void)
+{
+  static DisplayWidgetSlot rows[LIST_TEST_ROW_NB];
+  DisplayMenu menu;
+  menu.setDisplayedList(rows, LIST_TEST_ROW_NB, LIST_TEST_ITEM_NB, listTestRow);
+  menu.moveDown(30);
+
+  TEST_ASSERT_EQUAL(30 - LIST_TEST_ROW_NB + 1, menu.getListFirstItem());
+
+  // the target still exists: kept, the viewport stays if it fits
+  menu.setListItemNb(31);
+  TEST_ASSERT_EQUAL(30, menu.getTargetItem());
+  TEST_ASSERT_EQUAL(30 - LIST_TEST_ROW_NB + 1, menu.getListFirstItem());
+  TEST_ASSERT_TRUE(isListViewportValid(menu));
+
+  // or moves back to end on the last item
+  menu.moveUp(2);
+  menu.setListItemNb(30);
+  TEST_ASSERT_EQUAL(28, menu.getTargetItem());
+  TEST_ASSERT_EQUAL(30 - LIST_TEST_ROW_NB, menu.getListFirstItem());
+  TEST_ASSERT_TRUE(isListViewportValid(menu));
+
+  // the target is gone: back to the first item
+  menu.setListItemNb(10);
+  TEST_ASSERT_EQUAL(0, menu.getTargetItem());
+  TEST_ASSERT_TRUE(isListViewportValid(menu));
+
+  // fewer items than rows
+  menu.setListItemNb(2);
+  TEST_ASSERT_EQUAL(2, menu.getWidgetNb());
+  TEST_ASSERT_TRUE(isListViewportValid(menu));
+  menu.setListItemNb(0);
+  TEST_ASSERT_EQUAL(0, menu.getWidgetNb());
+  menu.moveDown();
+  TEST_ASSERT_EQUAL(0, menu.getTargetItem());
+}
+
+//#######################################################################
+// Navigation table
+//#######################################################################
+
+static void noAction() {}
+
+//  +--------+ +--+
+//  |   0    | |1 |
+//  |        | +--+
+//  |        | +--+
+//  |        | |2 |
+//  +--------+ +--+
+//  +-------------+
+//  |      3      |
+//  +-------------+
+static DisplayWidget navTestWidgets[4] = {DisplayWidget(noAction, 0, 0, 100, 100), DisplayWidget(noAction, 110, 0, 50, 45),
+                                          DisplayWidget(noAction, 110, 60, 50, 40), DisplayWidget(noAction, 0, 110, 160, 30)};
+
+void Test_navTableNeighbors(void)
+{
+  // up, down, left, right. 2 is in the 90 degrees cone on the right of 3
+  static const uint8_t expected[4][DISPLAY_NAV_DIR_NB] = {{0, 3, 0, 1}, {1, 2, 0, 1}, {1, 3, 0, 2}, {0, 3, 3, 2}};
+  DisplayNavEntry table[4];
+  TEST_ASSERT_TRUE(DisplayNavTable::build(navTestWidgets, 4, table));
+  for (uint8_t i = 0; i < 4; i++) {
+    for (uint8_t dir = 0; dir < DISPLAY_NAV_DIR_NB; dir++) {
+      TEST_ASSERT_EQUAL(expected[i][dir], DisplayNavTable::getNeighbor(table, false, i, (DisplayInput)dir));
+    }
+  }
+}
+
+void Test_navTableMoves(void)
+{
+  DisplayNavEntry table[4];
+  DisplayMenu menu;
+  DisplayNavTable::build(navTestWidgets, 4, table);
+  TEST_ASSERT_TRUE(menu.setDisplayedLayout(navTestWidgets, 4, table));
+
+  menu.moveRight();
+  TEST_ASSERT_EQUAL(1, menu.getTargetWidgetIdx());
+  menu.moveDown();
+  TEST_ASSERT_EQUAL(2, menu.getTargetWidgetIdx());
+  menu.moveDown();
+  TEST_ASSERT_EQUAL(3, menu.getTargetWidgetIdx());
+  // no neighbor: stays, no wrapping
+  menu.moveDown();
+  TEST_ASSERT_EQUAL(3, menu.getTargetWidgetIdx());
+  menu.moveUp();
+  TEST_ASSERT_EQUAL(0, menu.getTargetWidgetIdx());
+  // a chain stops on the last widget
+  menu.moveRight(5);
+  TEST_ASSERT_EQUAL(1, menu.getTargetWidgetIdx());
+}
+
+void Test_navTableWidgetLimit(void)
+{
+  DisplayNavEntry table[1];
+  DisplayMenu menu;
+  TEST_ASSERT_FALSE(DisplayNavTable::build(navTestWidgets, DISPLAY_NAV_MAX_WIDGETS + 1, table));
+
+  // over the dirty mask: refused, the previous page stays
+  menu.setDisplayedWidgets(navTestWidgets, 4);
+  TEST_ASSERT_FALSE(menu.setDisplayedLayout(navTestWidgets, MAX_WIDGETS_NB + 1, table));
+  TEST_ASSERT_EQUAL(4, menu.getWidgetNb());
+}
+
+//#######################################################################
+// Render list
+//#######################################################################
+
+#define RENDER_TEST_MAX_SENT (16)
+#define RENDER_TEST_BG_COLOR (0x0000)
+#define RENDER_TEST_PAGE_COLOR (0x001F)
+
+struct RenderTestSent
+{
+  DisplayCmd cmds[RENDER_TEST_MAX_SENT];
+  uint16_t nb;
+};
+
+static void recordCmd(const DisplayCmd &cmd, void *ctx)
+{
+  RenderTestSent *sent = (RenderTestSent *)ctx;
+  if (sent->nb < RENDER_TEST_MAX_SENT) {
+    sent->cmds[sent->nb] = cmd;
+  }
+  sent->nb++;
+}
+
+// A page background, a framed value and a label
+static void recordTestPage(DisplayRenderList &list, const char *value, bool hasLabel)
+{
+  list.begin();
+  list.fillRect(0, 0, 100, 100, RENDER_TEST_PAGE_COLOR);
+  list.setGroup(1);
+  list.drawRect(10, 10, 50, 20, 0xFFFF);
+  list.drawText(12, 12, value, 0x07E0, RENDER_TEST_PAGE_COLOR);
+  if (hasLabel) {
+    list.setGroup(2);
+    list.drawText(12, 40, "Label", 0xFFFF, RENDER_TEST_PAGE_COLOR);
+  }
+}
+
+static bool isSameRect(const DisplayCmd &cmd, int16_t x, int16_t y, uint16_t w, uint16_t h)
+{
+  return (cmd.x == x) && (cmd.y == y) && (cmd.w == w) && (cmd.h == h);
+}
+
+void Test_renderListSendsChanges(void)
+{
+  static DisplayRenderList list;
+  RenderTestSent sent;
+  char value[8];
+  list.setBackgroundColor(RENDER_TEST_BG_COLOR);
+
+  // first frame: everything
+  strcpy(value, "100");
+  recordTestPage(list, value, true);
+  sent.nb = 0;
+  TEST_ASSERT_EQUAL(4, list.commit(recordCmd, &sent));
+  TEST_ASSERT_EQUAL(4, sent.nb);
+
+  // same page: nothing
+  recordTestPage(list, value, true);
+  sent.nb = 0;
+  TEST_ASSERT_EQUAL(0, list.commit(recordCmd, &sent));
+
+  // shorter text in the same buffer: the area of the old one is erased, the
+  // background under it is drawn again, the frame and label are not touched
+  strcpy(value, "9");
+  recordTestPage(list, value, true);
+  sent.nb = 0;
+  TEST_ASSERT_EQUAL(3, list.commit(recordCmd, &sent));
+  TEST_ASSERT_EQUAL(DISPLAY_CMD_FILL_RECT, sent.cmds[0].type);
+  TEST_ASSERT_EQUAL(RENDER_TEST_BG_COLOR, sent.cmds[0].color);
+  TEST_ASSERT_TRUE(isSameRect(sent.cmds[0], 12, 12, 3 * RENDER_LIST_CHAR_WIDTH, RENDER_LIST_CHAR_HEIGHT));
+  TEST_ASSERT_EQUAL(DISPLAY_CMD_FILL_RECT, sent.cmds[1].type);
+  TEST_ASSERT_EQUAL(RENDER_TEST_PAGE_COLOR, sent.cmds[1].color);
+  TEST_ASSERT_TRUE(isSameRect(sent.cmds[1], 12, 12, 3 * RENDER_LIST_CHAR_WIDTH, RENDER_LIST_CHAR_HEIGHT));
+  TEST_ASSERT_EQUAL(DISPLAY_CMD_TEXT, sent.cmds[2].type);
+  TEST_ASSERT_EQUAL_STRING("9", sent.cmds[2].getText());
+
+  // removed label: erased, the background is drawn again over it
+  recordTestPage(list, value, false);
+  sent.nb = 0;
+  TEST_ASSERT_EQUAL(2, list.commit(recordCmd, &sent));
+  TEST_ASSERT_TRUE(isSameRect(sent.cmds[0], 12, 40, 5 * RENDER_LIST_CHAR_WIDTH, RENDER_LIST_CHAR_HEIGHT));
+  TEST_ASSERT_EQUAL(RENDER_TEST_PAGE_COLOR, sent.cmds[1].color);
+}
+
+void Test_renderListTextArea(void)
+{
+  static DisplayRenderList list;
+  list.begin();
+  list.drawText(0, 0, "abcd", 0xFFFF, 0x0000, 2);
+  list.drawText(0, 20, "abcd", 0xFFFF, 0x0000, 2, 100, 30);
+
+  RenderTestSent sent;
+  sent.nb = 0;
+  list.commit(recordCmd, &sent);
+  TEST_ASSERT_EQUAL(2, sent.nb);
+  TEST_ASSERT_TRUE(isSameRect(sent.cmds[0], 0, 0, 4 * RENDER_LIST_CHAR_WIDTH * 2, RENDER_LIST_CHAR_HEIGHT * 2));
+  TEST_ASSERT_TRUE(isSameRect(sent.cmds[1], 0, 20, 100, 30));
+}
+
+//#######################################################################
+// Bar rendering
+//#######################################################################
+
+#define BAR_TEST_MAX_CMDS (8)
+#define BAR_TEST_FILL (0xAAAA)
+#define BAR_TEST_BG (0x0F0F)
+#define BAR_TEST_IDLE (0x1111)
+#define BAR_TEST_TARGET (0x2222)
+
+struct BarTestCmd
+{
+  char op;   // 'F' fillRect, 'R' drawRect, 'T' drawText
+  int16_t x;
+  int16_t y;
+  uint16_t w;
+  uint16_t h;
+  uint16_t color;
+};
+
+// Backend that records the calls made by the renderer
+class BarTestBackend
+{
+public:
+  uint8_t nb = 0;
+  BarTestCmd cmds[BAR_TEST_MAX_CMDS];
+
+  void fillRect(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t color) { _record('F', x, y, w, h, color); }
+  void drawRect(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t color) { _record('R', x, y, w, h, color); }
+  void drawBitmap(int16_t x, int16_t y, const DisplayBitmap &bmp, uint16_t color, uint16_t bgColor)
+  {
+    (void)bmp;
+    (void)bgColor;
+    _record('B', x, y, 0, 0, color);
+  }
+  void drawText(int16_t x, int16_t y, const char *text, uint16_t color, uint16_t bgColor, uint8_t size)
+  {
+    (void)text;
+    (void)bgColor;
+    (void)size;
+    _record('T', x, y, 0, 0, color);
+  }
+  void pushPixels(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t *pixels, uint16_t stride)
+  {
+    (void)pixels;
+    (void)stride;
+    _record('P', x, y, w, h, 0);
+  }
+  void flush() {}
+
+  bool isCmd(uint8_t idx, char op, int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t color)
+  {
+    const BarTestCmd &cmd = cmds[idx];
+    return (idx < nb) && (cmd.op == op) && (cmd.x == x) && (cmd.y == y) && (cmd.w == w) && (cmd.h == h) &&
+           (cmd.color == color);
+  }
+
+private:
+  void _record(char op, int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t color)
+  {
+    if (nb < BAR_TEST_MAX_CMDS) {
+      BarTestCmd cmd = {op, x, y, w, h, color};
+      cmds[nb++] = cmd;
+    }
+  }
+};
+
+static uint8_t barTestLevels[2];
+static const DisplayValueRange<uint8_t> barTestRanges[2] = {{&barTestLevels[0], 1, 0, 100},
+                                                            {&barTestLevels[1], 1, 0, 100}};
+
+// fill area 50 x 10 at (12, 22) for the horizontal bar, 10 x 50 at (2, 42) for the vertical one
+static DisplayWidget barTestWidgets[2] = {DisplayWidget(barTestRanges[0], BAR_LEFT_TO_RIGHT, 10, 20, 54, 14),
+                                          DisplayWidget(barTestRanges[1], BAR_BOTTOM_TO_TOP, 0, 40, 14, 54)};
+
+void Test_barDrawsOnlyChanges(void)
+{
+  BarTestBackend backend;
+  DisplayRenderer<BarTestBackend> renderer(backend);
+  DisplayMenu menu;
+  menu.setColors(BAR_TEST_IDLE, BAR_TEST_TARGET, 0x3333, BAR_TEST_BG);
+  renderer.setBarColor(BAR_TEST_FILL);
+  barTestLevels[0] = 20;
+  menu.setDisplayedWidgets(barTestWidgets, 2);
+  barTestWidgets[0].invalidateBar();
+
+  // first draw: frame, fill, then the empty part
+  renderer.printWidget(menu, 0);
+  TEST_ASSERT_EQUAL(3, backend.nb);
+  TEST_ASSERT_TRUE(backend.isCmd(0, 'R', 10, 20, 54, 14, BAR_TEST_TARGET));
+  TEST_ASSERT_TRUE(backend.isCmd(1, 'F', 12, 22, 10, 10, BAR_TEST_FILL));
+  TEST_ASSERT_TRUE(backend.isCmd(2, 'F', 22, 22, 40, 10, BAR_TEST_BG));
+  TEST_ASSERT_EQUAL(10, barTestWidgets[0].getBarDrawnExtent());
+
+  // growing fills [drawn, extent[, shrinking clears [extent, drawn[
+  backend.nb = 0;
+  barTestLevels[0] = 60;
+  renderer.printWidget(menu, 0);
+  TEST_ASSERT_EQUAL(1, backend.nb);
+  TEST_ASSERT_TRUE(backend.isCmd(0, 'F', 22, 22, 20, 10, BAR_TEST_FILL));
+  backend.nb = 0;
+  barTestLevels[0] = 40;
+  renderer.printWidget(menu, 0);
+  TEST_ASSERT_EQUAL(1, backend.nb);
+  TEST_ASSERT_TRUE(backend.isCmd(0, 'F', 32, 22, 10, 10, BAR_TEST_BG));
+  backend.nb = 0;
+  renderer.printWidget(menu, 0);
+  TEST_ASSERT_EQUAL(0, backend.nb);
+
+  // another state color: the frame only
+  menu.moveDown();
+  renderer.printWidget(menu, 0);
+  TEST_ASSERT_EQUAL(1, backend.nb);
+  TEST_ASSERT_TRUE(backend.isCmd(0, 'R', 10, 20, 54, 14, BAR_TEST_IDLE));
+  TEST_ASSERT_EQUAL(BAR_TEST_IDLE, barTestWidgets[0].getBarDrawnColor());
+
+  // frame and value change together
+  backend.nb = 0;
+  menu.moveUp();
+  barTestLevels[0] = 50;
+  renderer.printWidget(menu, 0);
+  TEST_ASSERT_EQUAL(2, backend.nb);
+  TEST_ASSERT_TRUE(backend.isCmd(0, 'R', 10, 20, 54, 14, BAR_TEST_TARGET));
+  TEST_ASSERT_TRUE(backend.isCmd(1, 'F', 32, 22, 5, 10, BAR_TEST_FILL));
+}
+
+void Test_barBottomToTop(void)
+{
+  BarTestBackend backend;
+  DisplayRenderer<BarTestBackend> renderer(backend);
+  DisplayMenu menu;
+  menu.setColors(BAR_TEST_IDLE, BAR_TEST_TARGET, 0x3333, BAR_TEST_BG);
+  renderer.setBarColor(BAR_TEST_FILL);
+  barTestLevels[0] = 0;
+  barTestLevels[1] = 20;
+  menu.setDisplayedWidgets(barTestWidgets, 2);
+
+  // the fill starts from the bottom of the area, rows 42 to 91. The empty bar has no fill.
+  renderer.printMenu(menu);
+  TEST_ASSERT_EQUAL(5, backend.nb);
+  TEST_ASSERT_TRUE(backend.isCmd(1, 'F', 12, 22, 50, 10, BAR_TEST_BG));
+  TEST_ASSERT_TRUE(backend.isCmd(2, 'R', 0, 40, 14, 54, BAR_TEST_IDLE));
+  TEST_ASSERT_TRUE(backend.isCmd(3, 'F', 2, 82, 10, 10, BAR_TEST_FILL));
+  TEST_ASSERT_TRUE(backend.isCmd(4, 'F', 2, 42, 10, 40, BAR_TEST_BG));
+
+  backend.nb = 0;
+  barTestLevels[1] = 60;
+  renderer.printWidget(menu, 1);
+  TEST_ASSERT_EQUAL(1, backend.nb);
+  TEST_ASSERT_TRUE(backend.isCmd(0, 'F', 2, 62, 10, 20, BAR_TEST_FILL));
+  backend.nb = 0;
+  barTestLevels[1] = 40;
+  renderer.printWidget(menu, 1);
+  TEST_ASSERT_EQUAL(1, backend.nb);
+  TEST_ASSERT_TRUE(backend.isCmd(0, 'F', 2, 62, 10, 10, BAR_TEST_BG));
+
+  // printMenu draws the bars entirely, the display may have been cleared
+  backend.nb = 0;
+  renderer.printMenu(menu);
+  TEST_ASSERT_EQUAL(5, backend.nb);
+  TEST_ASSERT_TRUE(backend.isCmd(3, 'F', 2, 72, 10, 20, BAR_TEST_FILL));
+  TEST_ASSERT_TRUE(backend.isCmd(4, 'F', 2, 42, 10, 30, BAR_TEST_BG));
+}
+
+//#######################################################################
+// Glyph cache
+//#######################################################################
+
+#define GLYPH_TEST_TEXT "-12.50V"
+#define GLYPH_TEST_WIDTH (8 * GLYPH_CACHE_CHAR_WIDTH * GLYPH_CACHE_MAX_TEXT_SIZE + 4)
+#define GLYPH_TEST_HEIGHT (GLYPH_CACHE_CHAR_HEIGHT * GLYPH_CACHE_MAX_TEXT_SIZE + 4)
+#define GLYPH_TEST_GUARD (0x5555)
+
+// Adafruit_GFX glcdfont columns of the test text, LSB is the top row
+static const char glyphTestChars[] = "-12.50V";
+static const unsigned char glyphTestFont[][5] = {
+    {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x42, 0x7F, 0x40, 0x00}, {0x72, 0x49, 0x49, 0x49, 0x46},
+    {0x00, 0x60, 0x60, 0x00, 0x00}, {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3E, 0x51, 0x49, 0x45, 0x3E},
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}};
+
+// Adafruit_GFX::drawChar with a background color: the display library text path
+static void drawGfxText(DisplayFramebuffer &fb, int16_t x, int16_t y, const char *text, uint16_t color,
+                        uint16_t bgColor, uint8_t size)
+{
+  for (; *text != '\0'; text++, x += GLYPH_CACHE_CHAR_WIDTH * size) {
+    const unsigned char *columns = glyphTestFont[strchr(glyphTestChars, *text) - glyphTestChars];
+    for (int8_t i = 0; i < GLYPH_CACHE_CHAR_WIDTH; i++) {
+      uint8_t line = (i < 5) ? columns[i] : 0;
+      for (int8_t j = 0; j < GLYPH_CACHE_CHAR_HEIGHT; j++, line >>= 1) {
+        fb.fillRect(x + i * size, y + j * size, size, size, (line & 1) ? color : bgColor);
+      }
+    }
+  }
+}
+
+static uint8_t glyphTestMaxRows;
+
+static void pushToFramebuffer(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t *pixels, uint16_t stride,
+                              void *ctx)
+{
+  ((DisplayFramebufferBackend *)ctx)->pushPixels(x, y, w, h, pixels, stride);
+  if (h > glyphTestMaxRows) {
+    glyphTestMaxRows = h;
+  }
+}
+
+void Test_glyphCacheMatchesFontText(void)
+{
+  static uint16_t cachePixels[GLYPH_TEST_WIDTH * GLYPH_TEST_HEIGHT];
+  static uint16_t fontPixels[GLYPH_TEST_WIDTH * GLYPH_TEST_HEIGHT];
+  static DisplayGlyphCache cache;
+  const uint16_t colors[GLYPH_CACHE_STATE_NB] = {0xFFFF, 0xF81F, 0xF800};
+  const uint16_t bgColor = 0x0841;
+  DisplayFramebuffer cacheFb(cachePixels, GLYPH_TEST_WIDTH, GLYPH_TEST_HEIGHT);
+  DisplayFramebuffer fontFb(fontPixels, GLYPH_TEST_WIDTH, GLYPH_TEST_HEIGHT);
+  DisplayFramebufferBackend cacheBackend(cacheFb);
+
+  for (uint8_t size = 1; size <= GLYPH_CACHE_MAX_TEXT_SIZE; size++) {
+    TEST_ASSERT_TRUE(cache.build(size, colors, bgColor));
+    for (uint8_t state = 0; state < GLYPH_CACHE_STATE_NB; state++) {
+      cacheFb.fillScreen(GLYPH_TEST_GUARD);
+      fontFb.fillScreen(GLYPH_TEST_GUARD);
+      glyphTestMaxRows = 0;
+      TEST_ASSERT_TRUE(cache.drawText(2, 1, GLYPH_TEST_TEXT, colors[state], pushToFramebuffer, &cacheBackend));
+      drawGfxText(fontFb, 2, 1, GLYPH_TEST_TEXT, colors[state], bgColor, size);
+      TEST_ASSERT_EQUAL_MEMORY(fontPixels, cachePixels, sizeof(cachePixels));
+      TEST_ASSERT_EQUAL(GLYPH_CACHE_STRIP_ROWS, glyphTestMaxRows);
+    }
+  }
+
+  // other colors and characters go through the display library
+  TEST_ASSERT_FALSE(cache.canDraw(GLYPH_TEST_TEXT, 0x07E0));
+  TEST_ASSERT_FALSE(cache.canDraw("x", colors[0]));
+  TEST_ASSERT_FALSE(cache.canDraw("123456789", colors[0]));
+  TEST_ASSERT_FALSE(cache.build(GLYPH_CACHE_MAX_TEXT_SIZE + 1, colors, bgColor));
+  TEST_ASSERT_FALSE(cache.canDraw("1", colors[0]));
+}
+
+//#######################################################################
+// Value formatting
+//#######################################################################
+
+#define FORMAT_TEST_TEXT_SIZE (24)
+
+void Test_formatInt(void)
+{
+  char text[FORMAT_TEST_TEXT_SIZE];
+  DisplayValueFormat plain = {0, 0, NULL, 0, false};
+  DisplayValueFormat volts = {6, 1, "V", 0, true};
+  DisplayValueFormat small = {0, 3, NULL, 0, false};
+
+  TEST_ASSERT_EQUAL(1, displayFormatInt(0, plain, text, sizeof(text)));
+  TEST_ASSERT_EQUAL_STRING("0", text);
+  displayFormatInt(-42, plain, text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("-42", text);
+  displayFormatInt(INT32_MIN, plain, text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("-2147483648", text);
+  displayFormatUInt(UINT32_MAX, plain, text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("4294967295", text);
+
+  // fixed point, the unit counts in the width
+  TEST_ASSERT_EQUAL(6, displayFormatInt(125, volts, text, sizeof(text)));
+  TEST_ASSERT_EQUAL_STRING(" 12.5V", text);
+  displayFormatInt(-5, small, text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("-0.005", text);
+
+  // does not fit: empty text
+  TEST_ASSERT_EQUAL(0, displayFormatInt(125, volts, text, 6));
+  TEST_ASSERT_EQUAL_STRING("", text);
+}
+
+void Test_formatPadding(void)
+{
+  char text[FORMAT_TEST_TEXT_SIZE];
+  DisplayValueFormat rightZeros = {6, 0, "V", '0', true};
+  DisplayValueFormat leftZeros = {6, 0, "V", '0', false};
+  DisplayValueFormat leftStars = {6, 0, "V", '*', false};
+
+  // zeros between the sign and the digits
+  displayFormatInt(-12, rightZeros, text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("-0012V", text);
+  // left aligned: spaces, not "12V000"
+  displayFormatInt(12, leftZeros, text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("12V   ", text);
+  displayFormatInt(12, leftStars, text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("12V***", text);
+}
+
+void Test_formatFloat(void)
+{
+  char text[FORMAT_TEST_TEXT_SIZE];
+  DisplayValueFormat twoDecimals = {0, 2, NULL, 0, false};
+  DisplayValueFormat volts = {6, 1, "V", 0, true};
+
+  displayFormatFloat(3.14159f, twoDecimals, text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("3.14", text);
+  displayFormatFloat(-2.006f, twoDecimals, text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("-2.01", text);
+  displayFormatFloat(-0.001f, twoDecimals, text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("0.00", text);
+  displayFormatFloat(1e20f, twoDecimals, text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("21474836.47", text);
+
+  // no number for NaN, padded with spaces
+  TEST_ASSERT_EQUAL(3, displayFormatFloat(NAN, twoDecimals, text, sizeof(text)));
+  TEST_ASSERT_EQUAL_STRING("nan", text);
+  displayFormatFloat(NAN, volts, text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("   nan", text);
+  TEST_ASSERT_EQUAL(0, displayFormatFloat(NAN, volts, text, 4));
+}
+
+//#######################################################################
+// Tweens
+//#######################################################################
+
+#define TWEEN_TEST_HALF (32768)
+#define TWEEN_TEST_ONE (65536)
+
+struct TweenTestSteps
+{
+  uint16_t nb;
+  int32_t last;
+  bool isDone;
+};
+
+static void recordTweenStep(int32_t previous, int32_t current, bool isDone, void *ctx)
+{
+  TweenTestSteps *steps = (TweenTestSteps *)ctx;
+  (void)previous;
+  steps->nb++;
+  steps->last = current;
+  steps->isDone = isDone;
+}
+
+void Test_tweenEasing(void)
+{
+  TEST_ASSERT_EQUAL(0, DisplayAnimator::ease(0, 100, 0, EASE_IN_OUT));
+  TEST_ASSERT_EQUAL(100, DisplayAnimator::ease(0, 100, TWEEN_TEST_ONE, EASE_IN_OUT));
+  TEST_ASSERT_EQUAL(-100, DisplayAnimator::ease(100, -100, TWEEN_TEST_ONE, EASE_OUT));
+  TEST_ASSERT_EQUAL(50, DisplayAnimator::ease(0, 100, TWEEN_TEST_HALF, EASE_LINEAR));
+  TEST_ASSERT_EQUAL(25, DisplayAnimator::ease(0, 100, TWEEN_TEST_HALF, EASE_IN));
+  TEST_ASSERT_EQUAL(75, DisplayAnimator::ease(0, 100, TWEEN_TEST_HALF, EASE_OUT));
+  TEST_ASSERT_EQUAL(50, DisplayAnimator::ease(0, 100, TWEEN_TEST_HALF, EASE_IN_OUT));
+  // wide ranges take the 64 bit path
+  TEST_ASSERT_EQUAL(INT32_MAX, DisplayAnimator::ease(INT32_MIN, INT32_MAX, TWEEN_TEST_ONE, EASE_LINEAR));
+
+  TEST_ASSERT_EQUAL(0xF800, DisplayAnimator::easeColor(0xF800, 0x001F, 0, EASE_LINEAR));
+  TEST_ASSERT_EQUAL(0x001F, DisplayAnimator::easeColor(0xF800, 0x001F, TWEEN_TEST_ONE, EASE_LINEAR));
+  TEST_ASSERT_EQUAL(0x780F, DisplayAnimator::easeColor(0xF800, 0x001F, TWEEN_TEST_HALF, EASE_LINEAR));
+}
+
+void Test_tweenVariable(void)
+{
+  DisplayAnimator animator;
+  TweenTestSteps steps = {0, 0, false};
+  int16_t level = 0;
+  unsigned long startMs = millis();
+  int8_t handle = animator.animate(&level, 100, 100, EASE_LINEAR, recordTweenStep, &steps);
+  TEST_ASSERT_TRUE(animator.isRunning(handle));
+
+  TEST_ASSERT_EQUAL(1, animator.update(startMs + 50));
+  TEST_ASSERT_TRUE((level >= 45) && (level <= 50));
+  TEST_ASSERT_EQUAL(level, steps.last);
+  TEST_ASSERT_FALSE(steps.isDone);
+
+  // within the step period: nothing
+  TEST_ASSERT_EQUAL(0, animator.update(startMs + 51));
+
+  // animated again: restarts from where it is, same handle
+  int16_t restartFrom = level;
+  TEST_ASSERT_EQUAL(handle, animator.animate(&level, 0, 100, EASE_LINEAR, recordTweenStep, &steps));
+  TEST_ASSERT_EQUAL(1, animator.getRunningNb());
+  TEST_ASSERT_EQUAL(restartFrom, level);
+
+  TEST_ASSERT_EQUAL(1, animator.update(startMs + 1000));
+  TEST_ASSERT_EQUAL(0, level);
+  TEST_ASSERT_TRUE(steps.isDone);
+  TEST_ASSERT_FALSE(animator.isRunning(handle));
+  TEST_ASSERT_EQUAL(DISPLAY_DEADLINE_NEVER, animator.getNextDeadlineMs(startMs + 1000));
+
+  // stopped on its final value
+  handle = animator.animate(&level, 30, 1000);
+  animator.stop(handle, true);
+  TEST_ASSERT_EQUAL(30, level);
+  TEST_ASSERT_EQUAL(0, animator.getRunningNb());
+}
+
+void Test_tweenWidget(void)
+{
+  int values[2] = {0, 0};
+  DisplayWidget widgets[2] = {DisplayWidget(&values[0], 1, 100, 0, 0, 0, 50, 20),
+                              DisplayWidget(&values[1], 1, 100, 0, 0, 20, 50, 20)};
+  DisplayAnimator animator;
+  DisplayMenu menu;
+  menu.setDisplayedWidgets(widgets, 2);
+  menu.clearDirtyWidgets();
+  unsigned long startMs = millis();
+
+  TEST_ASSERT_EQUAL(DISPLAY_TWEEN_NONE, animator.animateWidget(menu, 2, TWEEN_KIND_WIDGET_VALUE, 50, 100));
+  TEST_ASSERT_TRUE(animator.animateWidget(menu, 1, TWEEN_KIND_WIDGET_VALUE, 50, 0) != DISPLAY_TWEEN_NONE);
+  TEST_ASSERT_TRUE(animator.animateWidget(menu, 0, TWEEN_KIND_WIDGET_X, 30, 0) != DISPLAY_TWEEN_NONE);
+  TEST_ASSERT_EQUAL(2, animator.update(startMs + 1));
+  TEST_ASSERT_EQUAL(50, values[1]);
+  TEST_ASSERT_EQUAL(30, widgets[0].getXPostion());
+  TEST_ASSERT_TRUE(menu.isWidgetDirty(0));
+  TEST_ASSERT_TRUE(menu.isWidgetDirty(1));
+}
+
+void Test_tweenDeadline(void)
+{
+  int values[2] = {0, 0};
+  DisplayWidget widgets[2] = {DisplayWidget(&values[0], 1, 100), DisplayWidget(&values[1], 1, 100)};
+  DisplayAnimator animator;
+  DisplayMenu menu;
+  menu.setDisplayedWidgets(widgets, 2);
+  unsigned long startMs = millis();
+  TEST_ASSERT_EQUAL(DISPLAY_DEADLINE_NEVER, animator.getNextDeadlineMs(startMs));
+
+  // first step right away, then one per step period
+  animator.setStepPeriod(16);
+  animator.animateWidget(menu, 0, TWEEN_KIND_WIDGET_VALUE, 50, 100, EASE_LINEAR);
+  TEST_ASSERT_EQUAL(0, animator.getNextDeadlineMs(startMs));
+  animator.update(startMs + 1);
+  TEST_ASSERT_EQUAL(16, animator.getNextDeadlineMs(startMs + 1));
+  TEST_ASSERT_EQUAL(6, animator.getNextDeadlineMs(startMs + 11));
+  TEST_ASSERT_EQUAL(0, animator.getNextDeadlineMs(startMs + 40));
+  TEST_ASSERT_EQUAL(1, animator.update(startMs + 40));
+  TEST_ASSERT_EQUAL(16, animator.getNextDeadlineMs(startMs + 40));
+
+  // done: nothing left
+  TEST_ASSERT_EQUAL(1, animator.update(startMs + 200));
+  TEST_ASSERT_EQUAL(DISPLAY_DEADLINE_NEVER, animator.getNextDeadlineMs(startMs + 200));
+
+  // a tween whose widget left the page has no step to wake up for
+  animator.animateWidget(menu, 1, TWEEN_KIND_WIDGET_VALUE, 50, 100, EASE_LINEAR);
+  menu.setDisplayedWidgets(widgets, 2);
+  TEST_ASSERT_EQUAL(1, animator.getRunningNb());
+  TEST_ASSERT_EQUAL(DISPLAY_DEADLINE_NEVER, animator.getNextDeadlineMs(startMs + 300));
+  TEST_ASSERT_EQUAL(0, animator.update(startMs + 300));
+  TEST_ASSERT_EQUAL(0, animator.getRunningNb());
+}
+
+void Test_tweenWidgetLeavesPage(void)
+{
+  int values[2] = {0, 0};
+  DisplayWidget widgets[2] = {DisplayWidget(&values[0], 1, 100), DisplayWidget(&values[1], 1, 100)};
+  DisplayWidget other[1] = {DisplayWidget(&values[1], 1, 100)};
+  DisplayAnimator animator;
+  DisplayMenu menu;
+  unsigned long startMs = millis();
+
+  // another page, even at the same address, stops the tween untouched
+  menu.setDisplayedWidgets(widgets, 2);
+  int8_t handle = animator.animateWidget(menu, 0, TWEEN_KIND_WIDGET_VALUE, 50, 0);
+  menu.setDisplayedWidgets(widgets, 2);
+  TEST_ASSERT_EQUAL(0, animator.update(startMs + 1));
+  TEST_ASSERT_EQUAL(0, values[0]);
+  TEST_ASSERT_FALSE(animator.isRunning(handle));
+
+  menu.setDisplayedWidgets(widgets, 2);
+  handle = animator.animateWidget(menu, 1, TWEEN_KIND_WIDGET_VALUE, 50, 1000);
+  menu.setDisplayedWidgets(other, 1);
+  animator.stop(handle, true);
+  TEST_ASSERT_EQUAL(0, values[1]);
+
+  // list scroll: the row holds another item
+  static DisplayWidgetSlot rows[LIST_TEST_ROW_NB];
+  memset(listTestItems, 0, sizeof(listTestItems));
+  menu.setDisplayedList(rows, LIST_TEST_ROW_NB, LIST_TEST_ITEM_NB, listTestRow);
+  handle = animator.animateWidget(menu, 0, TWEEN_KIND_WIDGET_VALUE, 9, 0);
+  menu.moveDown(LIST_TEST_ROW_NB);
+  TEST_ASSERT_EQUAL(0, animator.update(startMs + 100));
+  TEST_ASSERT_EQUAL(0, listTestItems[0]);
+  TEST_ASSERT_EQUAL(0, listTestItems[1]);
+  TEST_ASSERT_EQUAL(0, animator.getRunningNb());
+}
+
+//#######################################################################
+// Shared values
+//#######################################################################
+
+void Test_sharedValueStoreReprints(void)
+{
+  static uint8_t level = 10;
+  static float gain = 1.5f;
+  static const DisplayValueRange<uint8_t> levelRange = {&level, 1, 0, 100};
+  static const DisplayValueRange<float> gainRange = {&gain, 0.5f, 0.0f, 10.0f};
+  DisplayWidget mainWidgets[2] = {DisplayWidget(levelRange, 0, 0, 50, 20), DisplayWidget(gainRange, 0, 20, 50, 20)};
+  DisplayWidget statusWidgets[1] = {DisplayWidget(levelRange, BAR_LEFT_TO_RIGHT, 0, 0, 100, 10)};
+  DisplayMenu mainMenu, statusMenu;
+  DisplayInputQueue mainQueue, statusQueue;
+  DisplayMenuGroup group;
+  const DisplayValueFormat format = {0, 1, NULL, ' ', true};
+  char text[8];
+
+  mainMenu.setDisplayedWidgets(mainWidgets, 2);
+  statusMenu.setDisplayedWidgets(statusWidgets, 1);
+  uint8_t mainIdx = group.addMenu(mainMenu, mainQueue);
+  uint8_t statusIdx = group.addMenu(statusMenu, statusQueue);
+  group.addSharedValue(&level);
+  mainMenu.clearDirtyWidgets();
+  statusMenu.clearDirtyWidgets();
+
+  // application side
+  displayValueStore(&level, (uint8_t)40);
+  group.notifyValueChange(&level);
+  TEST_ASSERT_EQUAL(1, group.syncValues(mainIdx));
+  TEST_ASSERT_EQUAL(1, group.syncValues(statusIdx));
+  TEST_ASSERT_TRUE(mainMenu.isWidgetDirty(0));
+  TEST_ASSERT_FALSE(mainMenu.isWidgetDirty(1));
+  TEST_ASSERT_EQUAL(40, statusWidgets[0].getBarExtent(100));
+
+  // edits go through the same accesses, floats included
+  mainWidgets[1].increment();
+  TEST_ASSERT_TRUE(displayValueLoad(&gain) == 2.0f);
+  mainWidgets[1].formatValue(text, sizeof(text), format);
+  TEST_ASSERT_EQUAL_STRING("2.0", text);
+  mainWidgets[0].decrement(5);
+  TEST_ASSERT_EQUAL(35, displayValueLoad(&level));
+}
+
+//#######################################################################
+// Render statistics
+//#######################################################################
+
+#if DISPLAY_MENU_STATS
+void Test_statsFrameEndsWithPrinting(void)
+{
+  int values[3] = {0, 0, 0};
+  DisplayWidget widgets[3] = {DisplayWidget(&values[0], 1, 3), DisplayWidget(&values[1], 1, 3),
+                              DisplayWidget(&values[2], 1, 3)};
+  DisplayMenu menu;
+  menu.setDisplayedWidgets(widgets, 3);
+
+  // full page, nextPrint() after each widget as in the examples
+  menu.startPrint();
+  for (uint8_t i = 0; i < 3; i++) {
+    TEST_ASSERT_EQUAL(0, menu.getStats().frameNb);
+    menu.nextPrint();
+  }
+  TEST_ASSERT_EQUAL(1, menu.getStats().frameNb);
+  TEST_ASSERT_EQUAL(3, menu.getStats().redrawnWidgetNb);
+
+  // dirty print: previous and new target
+  menu.moveDown();
+  TEST_ASSERT_TRUE(menu.startDirtyPrint());
+  while (menu.nextDirtyPrint()) {
+  }
+  TEST_ASSERT_EQUAL(2, menu.getStats().frameNb);
+  TEST_ASSERT_EQUAL(5, menu.getStats().redrawnWidgetNb);
+  TEST_ASSERT_EQUAL(1, menu.getStats().skippedWidgetNb);
+
+  // the renderer clearDamage() after its flush is the same frame
+  delay(2);
+  menu.clearDamage();
+  TEST_ASSERT_EQUAL(2, menu.getStats().frameNb);
+  TEST_ASSERT_TRUE(menu.getStats().lastFrameUs >= 2000);
+  TEST_ASSERT_TRUE(menu.getStats().worstFrameUs >= 2000);
+}
+#endif
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(Test_hostClock);
+  RUN_TEST(Test_hostString);
+  RUN_TEST(Test_damageMergesOverlaps);
+  RUN_TEST(Test_damageMergesAdjacent);
+  RUN_TEST(Test_damageFullList);
+  RUN_TEST(Test_framebufferFlushMergesTiles);
+  RUN_TEST(Test_framebufferBandsClipFlushes);
+  RUN_TEST(Test_pipelineSendsBandsInOrder);
+  RUN_TEST(Test_packedBitmapRoundTrip);
+  RUN_TEST(Test_packedBitmapOutTooSmall);
+  RUN_TEST(Test_blitMatchesReference);
+  RUN_TEST(Test_blitColorChange);
+  RUN_TEST(Test_gridMenuQueuedMatchesDirect);
+  RUN_TEST(Test_inputQueueRejectsNone);
+  RUN_TEST(Test_queuedMovesWrapLikeDirect);
+  RUN_TEST(Test_queuedInputsGridLikeDirect);
+  RUN_TEST(Test_queuedInputsListLikeDirect);
+  RUN_TEST(Test_queuedOverflowLikeDirect);
+  RUN_TEST(Test_holdKeyRampStages);
+  RUN_TEST(Test_holdKeyRampAtLimits);
+  RUN_TEST(Test_holdKeyRampResetsOnRelease);
+  RUN_TEST(Test_frameBudgetDefersLowPriority);
+  RUN_TEST(Test_frameBudgetDoesNotStarve);
+  RUN_TEST(Test_deadlineFramePeriod);
+  RUN_TEST(Test_deadlineHeldKey);
+  RUN_TEST(Test_typedValueUnsignedLimits);
+  RUN_TEST(Test_typedValueSignedLimits);
+  RUN_TEST(Test_typedValueFloatSteps);
+  RUN_TEST(Test_pageStackPopRestoresCursor);
+  RUN_TEST(Test_pageStackFailedPushKeepsPage);
+  RUN_TEST(Test_pageStackSlotReuse);
+  RUN_TEST(Test_listScrollsByEnteringRows);
+  RUN_TEST(Test_listChange);
+  RUN_TEST(Test_listItemNbChange);
+  RUN_TEST(Test_navTableNeighbors);
+  RUN_TEST(Test_navTableMoves);
+  RUN_TEST(Test_navTableWidgetLimit);
+  RUN_TEST(Test_renderListSendsChanges);
+  RUN_TEST(Test_renderListTextArea);
+  RUN_TEST(Test_barDrawsOnlyChanges);
+  RUN_TEST(Test_barBottomToTop);
+  RUN_TEST(Test_glyphCacheMatchesFontText);
+  RUN_TEST(Test_formatInt);
+  RUN_TEST(Test_formatPadding);
+  RUN_TEST(Test_formatFloat);
+  RUN_TEST(Test_tweenEasing);
+  RUN_TEST(Test_tweenVariable);
+  RUN_TEST(Test_tweenWidget);
+  RUN_TEST(Test_tweenDeadline);
+  RUN_TEST(Test_tweenWidgetLeavesPage);
+  RUN_TEST(Test_sharedValueStoreReprints);
+#if DISPLAY_MENU_STATS
+  RUN_TEST(Test_statsFrameEndsWithPrinting);
+#endif
+  return UNITY_END();
+}
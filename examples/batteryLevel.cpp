@@ -15,6 +15,8 @@
 // Description:
 //    This file is used as an example for the DisplayBitmap class that is part of this library.
 //    This file contains a demonstration of a battery logo that slowly reduces in percentage
+//    The level slides to its new value with a DisplayAnimator tween, only the columns of the
+//    level that changed are drawn at each step.
 //    This example uses a ST7789 TFT display with the TFT_eSPI, and the Arduino framework.
 //
 //***********************************************************************************
@@ -24,9 +26,13 @@
 
 // This library
 #include "DisplayBitmap.h"
+#include "DisplayTween.h"
 
 #define TFT_SIDE_PIXEL_MAX (240)
 #define MAX_BATTERY_PERCENTAGE (100)
+#define BATTERY_LEVEL_STEP (10)           // percentage change at each level update
+#define LEVEL_CHANGE_PERIOD_MS (1000)
+#define LEVEL_ANIMATION_MS (600)
 
 
 //############################################################
@@ -50,62 +56,79 @@ const unsigned char batteryBmp[] PROGMEM = {
 DisplayBitmap batteryLogo = DisplayBitmap(BATTERY_BMP_WIDTH, BATTERY_BMP_HEIGHT, batteryBmp);
 
 
-const unsigned char chargeBmp [] PROGMEM = {
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x00, 0x10, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x00, 0x00, 0x1f, 0xc0, 0x00, 0x00, 0x0f, 0xf8, 0x00, 
-	0x3f, 0xfc, 0x00, 0x00, 0x07, 0xfc, 0x00, 0x00, 0x00, 0x7e, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x00, 
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x00, 0x00, 0x00, 0x00
+// The charge logo is mostly empty, it is stored compressed (PackBits) to save flash: 34 bytes instead of 68.
+// Generated with DisplayPackedBitmap::pack() from the raw bitmap.
+const unsigned char chargeBmpPacked[] PROGMEM = {
+  0xf0, 0x00, 0x00, 0x10, 0xfe, 0x00, 0x00, 0x1e, 0xfe, 0x00, 0x0c, 0x1f, 0xc0, 0x00, 0x00, 0x0f,
+  0xf8, 0x00, 0x3f, 0xfc, 0x00, 0x00, 0x07, 0xfc, 0xfe, 0x00, 0x00, 0x7e, 0xfe, 0x00, 0x00, 0x1e,
+  0xeb, 0x00
 };
 
-DisplayBitmap chargeLogo = DisplayBitmap(BATTERY_BMP_WIDTH, BATTERY_BMP_HEIGHT, chargeBmp);
+DisplayPackedBitmap chargeLogo = DisplayPackedBitmap(BATTERY_BMP_WIDTH, BATTERY_BMP_HEIGHT, chargeBmpPacked);
 
 //############################################################
 
 TFT_eSPI tft;
+DisplayAnimator animator;
+
+#define BATTERY_X (TFT_SIDE_PIXEL_MAX - BATTERY_BMP_WIDTH)
+#define BATT_JUICE_X (BATTERY_X + 2)   // inside the 2 pixels border of the bitmap
+#define BATT_JUICE_Y (2)
+#define CHARGE_LOGO_X (BATTERY_X - BATTERY_BMP_WIDTH - 4)
 
 int8_t battPercentage = 100;
 bool charging = false;
+int16_t juiceW = BATT_JUICE_RECT_MAX_W;   // width of the green rectangle, animated
+unsigned long lastLevelChangeMs = 0;
+
+// Draws a span of set pixels of the packed charge logo, called by the bitmap decoder
+void drawChargeSpan(uint16_t x, uint16_t y, uint16_t len, void *ctx)
+{
+  tft.drawFastHLine(CHARGE_LOGO_X + x, y, len, TFT_WHITE);
+}
 
+/***************************************************************************/
+/*!
+    @brief Called by the animator at each step of the level animation: only
+     the columns between the previous and the new width are drawn
+*/
+/***************************************************************************/
+void drawJuiceStep(int32_t previous, int32_t current, bool isDone, void *ctx)
+{
+  if (current > previous) {
+    tft.fillRect(BATT_JUICE_X + previous, BATT_JUICE_Y, current - previous, BATT_JUICE_RECT_MAX_H, TFT_GREEN);
+  } else {
+    tft.fillRect(BATT_JUICE_X + current, BATT_JUICE_Y, previous - current, BATT_JUICE_RECT_MAX_H, TFT_BLACK);
+  }
+}
 
 /***************************************************************************/
 /*!
-    @brief Prints the battery animation on screen with the current power level
+    @brief Prints the battery with the current power level, once: the level
+     is then updated by drawJuiceStep()
     @param none
 */
 /***************************************************************************/
 void printBattery()
 {
-int rectW = (batteryLogo.width * battPercentage)/100;
-
-//clear battery area by covering it with a black rectangle
-tft.fillRect(TFT_SIDE_PIXEL_MAX - batteryLogo.width,
-               0,
-               batteryLogo.width,
-               batteryLogo.height,
-               TFT_BLACK);
-
-  // draw battery
-  tft.drawBitmap(TFT_SIDE_PIXEL_MAX - batteryLogo.width,
-                 0,
-                 batteryLogo.bitmap, batteryLogo.width,
-                 batteryLogo.height, TFT_WHITE);
-
-  // draw green rectangle with variable size inside the battery bitmap
-  tft.fillRect(TFT_SIDE_PIXEL_MAX - batteryLogo.width,
-               2,
-               rectW,
-               BATT_JUICE_RECT_MAX_H,
-               TFT_GREEN);
-
-  // draw charging spark logo when battery level is increasing
-  if(charging) {
-    tft.drawBitmap(TFT_SIDE_PIXEL_MAX - chargeLogo.width,
-                  0,
-                  chargeLogo.bitmap, chargeLogo.width, 
-                  chargeLogo.height, TFT_WHITE);
+  tft.drawBitmap(BATTERY_X, 0, batteryLogo.bitmap, batteryLogo.width, batteryLogo.height, TFT_WHITE);
+  tft.fillRect(BATT_JUICE_X, BATT_JUICE_Y, juiceW, BATT_JUICE_RECT_MAX_H, TFT_GREEN);
+}
+
+/***************************************************************************/
+/*!
+    @brief Shows the charging spark logo next to the battery, or erases it
+    @param none
+*/
+/***************************************************************************/
+void printChargeLogo()
+{
+  if (charging) {
+    DisplayBitmapDecoder decoder(chargeLogo);
+    while (decoder.nextRowSpans(drawChargeSpan)) {}
+  } else {
+    tft.fillRect(CHARGE_LOGO_X, 0, chargeLogo.width, chargeLogo.height, TFT_BLACK);
   }
-  Serial.println("Battery level green rectangle width:" + String(rectW));
 }
 
 void setup()
@@ -118,27 +141,40 @@ void setup()
   tft.fillScreen(TFT_BLACK);
   tft.setCursor(TFT_SIDE_PIXEL_MAX/4, TFT_SIDE_PIXEL_MAX/2);
   tft.print("Battery animation");
+  printBattery();
 }
 
 void loop()
 {
-  Serial.println("Battery %: " + String(battPercentage));
+  // steps the level animation, if one is running
+  animator.update();
 
-  printBattery();
+  if (millis() - lastLevelChangeMs < LEVEL_CHANGE_PERIOD_MS) {
+    return;
+  }
+  lastLevelChangeMs = millis();
 
   // Change battery level
+  bool wasCharging = charging;
   if (!charging) {
-    battPercentage--;
-    if(!battPercentage)
+    battPercentage -= BATTERY_LEVEL_STEP;
+    if (battPercentage <= 0)
       charging = true;
   } else {
-    battPercentage++;
-    if(battPercentage >= 100) {
+    battPercentage += BATTERY_LEVEL_STEP;
+    if(battPercentage >= MAX_BATTERY_PERCENTAGE) {
       charging = false;
     }
   }
-  
-  battPercentage = constrain(battPercentage, 0, 100);
+  battPercentage = constrain(battPercentage, 0, MAX_BATTERY_PERCENTAGE);
 
-  delay(200);
-}
\ No newline at end of file
+  Serial.print("Battery %: ");
+  Serial.println(battPercentage);
+
+  // the rectangle slides to its new width, drawJuiceStep() draws the difference
+  animator.animate(&juiceW, (int16_t)((BATT_JUICE_RECT_MAX_W * battPercentage) / MAX_BATTERY_PERCENTAGE),
+                   LEVEL_ANIMATION_MS, EASE_OUT, drawJuiceStep);
+  if (charging != wasCharging) {
+    printChargeLogo();
+  }
+}
@@ -0,0 +1,188 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file is used as an example for the DisplayMenuGroup class.
+//    Two displays on a dual core ESP32, each rendered by its own FreeRTOS task:
+//    a main TFT (TFT_eSPI) with the settings, and a small SSD1351 status OLED
+//    with the volume and battery levels as bars. A slow status refresh never
+//    delays the main display.
+//    The buttons are read in loop() and sent to the menu that has the focus.
+//    The volume is edited on the main display and shown on both, the battery
+//    level is measured by the application and also shown on both.
+//
+//    To setup this example, you need 3 buttons (next, enter, focus), a TFT
+//    screen configured for TFT_eSPI, and a SSD1351 OLED on the same SPI bus.
+//
+//***********************************************************************************
+
+#include <Arduino.h>
+#include <SPI.h>
+#include "TFT_eSPI.h"
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1351.h>
+
+#include "DisplayMenuGroup.h"
+#include "DisplayRenderer.h"
+#include "DisplayTftEspiBackend.h"
+#include "DisplayGfxBackend.h"
+
+#define NEXT_BUTTON_PIN   0
+#define ENTER_BUTTON_PIN  36
+#define FOCUS_BUTTON_PIN  39
+#define BATTERY_ADC_PIN   34
+
+#define OLED_CS_PIN       5
+#define OLED_DC_PIN       16
+#define OLED_RST_PIN      17
+
+#define MAIN_FRAME_PERIOD_MS    (20)
+#define STATUS_FRAME_PERIOD_MS  (100)
+#define BATTERY_PERIOD_MS       (1000)
+#define DISPLAY_TASK_STACK      (4096)
+
+// Global objects
+TFT_eSPI tft;
+Adafruit_SSD1351 oled = Adafruit_SSD1351(128, 128, &SPI, OLED_CS_PIN, OLED_DC_PIN, OLED_RST_PIN);
+DisplayTftEspiBackend<TFT_eSPI> mainBackend(tft);
+DisplayGfxBackend<Adafruit_SSD1351> statusBackend(oled);
+DisplayRenderer<DisplayTftEspiBackend<TFT_eSPI> > mainRenderer(mainBackend);
+DisplayRenderer<DisplayGfxBackend<Adafruit_SSD1351> > statusRenderer(statusBackend);
+
+DisplayMenu mainMenu;
+DisplayMenu statusMenu;
+DisplayInputQueue mainInputs;
+DisplayInputQueue statusInputs;
+DisplayMenuGroup displays;
+int8_t mainIdx;
+int8_t statusIdx;
+
+// values shown on both displays
+uint8_t volume = 5;
+uint8_t battery = 100;
+const DisplayValueRange<uint8_t> volumeRange = {&volume, 1, 0, 10};
+const DisplayValueRange<uint8_t> batteryRange = {&battery, 1, 0, 100};
+
+void mute();
+
+DisplayWidget mainWidgets[2] = {
+  DisplayWidget(volumeRange, 10, 10, 100, 40),
+  DisplayWidget(batteryRange, 10, 60, 100, 40)
+};
+
+DisplayWidget statusWidgets[3] = {
+  DisplayWidget(volumeRange, BAR_LEFT_TO_RIGHT, 4, 4, 120, 24),
+  DisplayWidget(batteryRange, BAR_LEFT_TO_RIGHT, 4, 36, 120, 24),
+  DisplayWidget(mute, 4, 68, 120, 24)
+};
+
+/***************************************************************************/
+/*!
+    @brief Status display action, runs in the status display task
+*/
+/***************************************************************************/
+void mute() {
+  displayValueStore(&volume, (uint8_t)0);
+  displays.notifyValueChange(&volume);
+}
+
+/***************************************************************************/
+/*!
+    @brief Render loops, one per display. Each task is the only one using its
+     menu, renderer and display.
+*/
+/***************************************************************************/
+void mainDisplayTask(void *param) {
+  for (;;) {
+    displays.processInputs(mainIdx);
+    mainRenderer.printDirty(mainMenu);
+    vTaskDelay(pdMS_TO_TICKS(MAIN_FRAME_PERIOD_MS));
+  }
+}
+
+void statusDisplayTask(void *param) {
+  for (;;) {
+    displays.processInputs(statusIdx);
+    statusRenderer.printDirty(statusMenu);
+    vTaskDelay(pdMS_TO_TICKS(STATUS_FRAME_PERIOD_MS));
+  }
+}
+
+/***************************************************************************/
+/*!
+    @brief True once when a button goes down
+*/
+/***************************************************************************/
+bool isPressed(uint8_t pin, bool &wasDown) {
+  bool isDown = (digitalRead(pin) == LOW);
+  bool isPress = isDown && !wasDown;
+  wasDown = isDown;
+  return isPress;
+}
+
+void setup() {
+  pinMode(NEXT_BUTTON_PIN, INPUT);
+  pinMode(ENTER_BUTTON_PIN, INPUT);
+  pinMode(FOCUS_BUTTON_PIN, INPUT);
+
+  // initialize menus, before the display tasks start
+  mainMenu.setColors(TFT_WHITE, TFT_MAGENTA, TFT_RED, TFT_BLACK);
+  mainMenu.setDisplayedWidgets(mainWidgets, 2);
+  statusMenu.setColors(TFT_WHITE, TFT_MAGENTA, TFT_RED, TFT_BLACK);
+  statusMenu.setDisplayedWidgets(statusWidgets, 3);
+  mainIdx = displays.addMenu(mainMenu, mainInputs);
+  statusIdx = displays.addMenu(statusMenu, statusInputs);
+  displays.addSharedValue(&volume);
+  displays.addSharedValue(&battery);
+
+  // initialize screens
+  tft.init();
+  tft.fillScreen(mainMenu.getBackgroundColor());
+  oled.begin();
+  oled.fillScreen(statusMenu.getBackgroundColor());
+  mainRenderer.setTextStyle(3, 10, 10, 3);
+  statusRenderer.setBarColor(TFT_GREEN);
+  mainRenderer.printMenu(mainMenu);
+  statusRenderer.printMenu(statusMenu);
+
+  // one display per core, so neither waits for the other
+  xTaskCreatePinnedToCore(mainDisplayTask, "mainDisplay", DISPLAY_TASK_STACK, NULL, 1, NULL, 1);
+  xTaskCreatePinnedToCore(statusDisplayTask, "statusDisplay", DISPLAY_TASK_STACK, NULL, 1, NULL, 0);
+}
+
+void loop() {
+  static bool wasNextDown = false;
+  static bool wasEnterDown = false;
+  static bool wasFocusDown = false;
+  static unsigned long lastBatteryMs = 0;
+
+  // inputs go to the display that has the focus
+  if (isPressed(NEXT_BUTTON_PIN, wasNextDown)) {
+    displays.push(DISPLAY_INPUT_DOWN);
+  }
+  if (isPressed(ENTER_BUTTON_PIN, wasEnterDown)) {
+    displays.push(DISPLAY_INPUT_INTERACT);
+  }
+  if (isPressed(FOCUS_BUTTON_PIN, wasFocusDown)) {
+    displays.setFocus(displays.isFocused(mainIdx) ? statusIdx : mainIdx);
+  }
+
+  // the application changes a shared value, both displays reprint it
+  if (millis() - lastBatteryMs >= BATTERY_PERIOD_MS) {
+    lastBatteryMs = millis();
+    displayValueStore(&battery, (uint8_t)map(analogRead(BATTERY_ADC_PIN), 0, 4095, 0, 100));
+    displays.notifyValueChange(&battery);
+  }
+  delay(5);
+}
@@ -44,8 +44,10 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_ST7789.h>
 
-#include "DisplayMenu.h"
+#include "DisplayGridMenu.h"
 #include "DisplayWidget.h"
+#include "DisplayRenderer.h"
+#include "DisplayGfxBackend.h"
 
 #define UP_BUTTON_PIN 0
 #define LEFT_BUTTON_PIN 1
@@ -67,6 +69,8 @@
 #define MAIN_MENU_WIDGET_NB 4
 #define MAIN_MENU_X_WIDGET_NB 2
 #define MAIN_MENU_Y_WIDGET_NB 2
+#define FRAME_PERIOD_MS (33)      // about 30 frames per second
+#define FRAME_BUDGET_US (20000)   // time a frame can take before low priority widgets wait
 
 // Calculate widget positions
 #define LEFT_QUARTER_X_PIX (0)
@@ -94,8 +98,11 @@
 
 // Global objects
 
-DisplayMenu menu;
+// layout is known at compile time, the widget array size is checked against it
+DisplayGridMenu<MAIN_MENU_Y_WIDGET_NB, MAIN_MENU_X_WIDGET_NB> menu;
 Adafruit_ST7789 tft = Adafruit_ST7789(TFT_CS_PIN, TFT_DC_PIN, TFT_RST_PIN);
+DisplayGfxBackend<Adafruit_ST7789> backend(tft);
+DisplayRenderer<DisplayGfxBackend<Adafruit_ST7789> > renderer(backend);
 
 int nbOne = 1;
 int nbTwo = 1;
@@ -103,45 +110,12 @@ int nbThree = 1;
 int nbFour = 1;
 
 DisplayWidget nbMenuWidgets[MAIN_MENU_WIDGET_NB] = {
-    DisplayWidget(&nbOne, 1, 20, 0, WDG1_X_POS, WDG1_Y_POS),
-    DisplayWidget(&nbTwo, 1, 20, 0, WDG2_X_POS, WDG2_Y_POS),
-    DisplayWidget(&nbThree, 1, 20, 0, WDG3_X_POS, WDG3_Y_POS),
-    DisplayWidget(&nbFour, 1, 20, 0, WDG4_X_POS, WDG4_Y_POS)
+    DisplayWidget(&nbOne, 1, 20, 0, WDG1_X_POS, WDG1_Y_POS, WDG_SQUARE_LEN, WDG_SQUARE_LEN),
+    DisplayWidget(&nbTwo, 1, 20, 0, WDG2_X_POS, WDG2_Y_POS, WDG_SQUARE_LEN, WDG_SQUARE_LEN),
+    DisplayWidget(&nbThree, 1, 20, 0, WDG3_X_POS, WDG3_Y_POS, WDG_SQUARE_LEN, WDG_SQUARE_LEN),
+    DisplayWidget(&nbFour, 1, 20, 0, WDG4_X_POS, WDG4_Y_POS, WDG_SQUARE_LEN, WDG_SQUARE_LEN)
 };
 
-/***************************************************************************/
-/*!
-    @brief Prints the menu page with the help of ScreenMenu to manage
-     widgets, order and color
-    @param none
-*/
-/***************************************************************************/
-void passToPrintNextWidget(bool isFirstWidget) {
-  if(isFirstWidget) {
-    menu.startPrint();
-  } else {
-    menu.nextPrint(); // called to tell the menu that we are printing the next widget
-  } 
-  tft.setTextColor(menu.getPrintColor(), menu.getBackgroundColor());
-  tft.setCursor(menu.getPrintX() + WDG_TEXT_TO_SQUARE_OFFSET, menu.getPrintY() + WDG_TEXT_TO_SQUARE_OFFSET);
-  tft.drawRect(menu.getPrintX(), menu.getPrintY(), WDG_SQUARE_LEN, WDG_SQUARE_LEN, menu.getPrintColor());
-}
-
-void printNumbersPage()
-{
-  passToPrintNextWidget(1);
-  tft.println(nbOne + String(" "));
-
-  passToPrintNextWidget(0);
-  tft.println(nbTwo + String(" "));
-
-  passToPrintNextWidget(0);
-  tft.println(nbThree + String(" "));
-
-  passToPrintNextWidget(0);
-  tft.println(nbFour + String(" "));
-}
-
 void setup()
 {
   pinMode(CENTER_BUTTON_PIN, INPUT);
@@ -152,52 +126,51 @@ void setup()
 
   // initialize menu
   menu.setColors(ST77XX_WHITE, ST77XX_ORANGE, ST77XX_GREEN, ST77XX_BLACK); // sets the desired colors for the widgets and menu background
-  menu.setDisplayedWidgets(nbMenuWidgets, MAIN_MENU_X_WIDGET_NB, MAIN_MENU_Y_WIDGET_NB);
+  menu.setDisplayedWidgets(nbMenuWidgets);
 
   // initialize screen
   tft.init(ST7789_X_PIXEL_NB, ST7789_Y_PIXEL_NB, SPI_MODE2); // Init ST7789 display 240x240 pixel
   tft.setRotation(1);
   tft.fillScreen(menu.getBackgroundColor());
   tft.setTextWrap(true);
-  tft.setTextSize(3);
 
-  printNumbersPage();
+  // widgets are drawn as squares in their state color, with their number inside
+  renderer.setTextStyle(3, WDG_TEXT_TO_SQUARE_OFFSET, WDG_TEXT_TO_SQUARE_OFFSET, 2);
+  renderer.printMenu(menu);
+
+  // changes are drawn together every 33 ms, whatever the input rate
+  menu.setFrameSchedule(FRAME_PERIOD_MS, FRAME_BUDGET_US);
 }
 
 void loop()
 {
-
-  // check if buttons were pressed
+  // key currently held, the menu repeats it while it stays pressed
+  DisplayInput key = DISPLAY_INPUT_NONE;
   if (digitalRead(CENTER_BUTTON_PIN) == LOW)
   {
-    menu.interact();
+    key = DISPLAY_INPUT_INTERACT;
   }
-
-  if (digitalRead(DOWN_BUTTON_PIN) == LOW)
+  else if (digitalRead(DOWN_BUTTON_PIN) == LOW)
   {
-    menu.moveDown();
+    key = DISPLAY_INPUT_DOWN;
   }
-
-  if (digitalRead(UP_BUTTON_PIN) == LOW)
+  else if (digitalRead(UP_BUTTON_PIN) == LOW)
   {
-    menu.moveUp();
+    key = DISPLAY_INPUT_UP;
   }
-
-  if (digitalRead(LEFT_BUTTON_PIN) == LOW)
+  else if (digitalRead(LEFT_BUTTON_PIN) == LOW)
   {
-    menu.moveLeft();
+    key = DISPLAY_INPUT_LEFT;
   }
-
-  if (digitalRead(RIGHT_BUTTON_PIN) == LOW)
+  else if (digitalRead(RIGHT_BUTTON_PIN) == LOW)
   {
-    menu.moveRight();
+    key = DISPLAY_INPUT_RIGHT;
   }
+  menu.holdKey(key);
 
-  delay(50); // artificially slow button response
-
-  // reprint menu page if it needs to be updated
-  if (menu.isChanged())
+  // reprint the widgets that changed, at most once per frame period
+  if (menu.isFrameDue())
   {
-    printNumbersPage();
+    renderer.printDirty(menu);
   }
-}
\ No newline at end of file
+}
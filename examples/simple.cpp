@@ -76,6 +76,10 @@ DisplayWidget danceMenuWidgets[DANCE_MENU_WIDGET_NB] = {
   DisplayWidget(startDancing)
 };
 
+// 2 chars, a shorter value is padded with spaces to erase the previous one
+const DisplayValueFormat dancersFormat = {2, 0, NULL, ' ', false};
+char valueText[8];
+
 /***************************************************************************/
 /*!
     @brief Prints the menu page with the help of ScreenMenu to manage
@@ -89,12 +93,14 @@ void printDancingPage() {
   menu.startPrint();
   tft.setTextColor(menu.getPrintColor(), menu.getBackgroundColor());
   tft.print("Dancers: ");
-  tft.print(nbDancers);
-  tft.println("  "); // fills smaller numbers
+  danceMenuWidgets[0].formatValue(valueText, sizeof(valueText), dancersFormat);
+  tft.println(valueText);
 
   menu.nextPrint(); // called to tell the menu that we are printing the next widget
   tft.setTextColor(menu.getPrintColor(), menu.getBackgroundColor()); 
   tft.println("Dance!");
+
+  menu.nextPrint(); // last widget printed, ends the frame
 }
 
 
@@ -0,0 +1,50 @@
+#include "Arduino.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+static std::atomic<bool> isClockSet(false);
+static std::atomic<unsigned long> setMicros(0);
+
+void delay(unsigned long ms)
+{
+  if (isClockSet) {
+    setMicros += ms * 1000;
+    return;
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void yield()
+{
+  std::this_thread::yield();
+}
+
+unsigned long millis()
+{
+  if (isClockSet) {
+    return setMicros / 1000;
+  }
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long micros()
+{
+  if (isClockSet) {
+    return setMicros;
+  }
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void hostSetMicros(unsigned long us)
+{
+  setMicros = us;
+  isClockSet = true;
+}
+
+void hostReleaseClock()
+{
+  isClockSet = false;
+}
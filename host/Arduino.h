@@ -0,0 +1,68 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    Minimal stand-in for the Arduino core, used to build the library on a host
+//    computer (benchmarks, tests). Only provides what the library and its host
+//    programs use. Never added to the include path of a target build.
+//
+//***********************************************************************************
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <string>
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+
+#define LOW  (0)
+#define HIGH (1)
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+void delay(unsigned long ms);
+void yield();
+unsigned long millis();
+unsigned long micros();
+
+// Host tests: millis() and micros() stay on a set time, and only move with
+// hostSetMicros() or delay(), until hostReleaseClock() goes back to real time
+void hostSetMicros(unsigned long us);
+void hostReleaseClock();
+
+class String
+{
+public:
+  String(const char *str = "") : _str(str) {}
+  String(int value) : _str(std::to_string(value)) {}
+  String(unsigned int value) : _str(std::to_string(value)) {}
+  String(long value) : _str(std::to_string(value)) {}
+
+  const char *c_str() const { return _str.c_str(); }
+  unsigned int length() const { return _str.length(); }
+
+  String &operator+=(const String &rhs) { _str += rhs._str; return *this; }
+  friend String operator+(String lhs, const String &rhs) { return lhs += rhs; }
+  bool operator==(const String &rhs) const { return _str == rhs._str; }
+
+private:
+  std::string _str;
+};
+
+#endif
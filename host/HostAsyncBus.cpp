@@ -0,0 +1,69 @@
+#include "HostAsyncBus.h"
+
+#include <chrono>
+
+#define BITS_PER_PIXEL (16)
+
+HostAsyncBus::HostAsyncBus(HostDisplay &display, uint32_t bitsPerSecond)
+    : _display(display), _bitsPerSecond(bitsPerSecond), _worker(&HostAsyncBus::_run, this)
+{
+}
+
+HostAsyncBus::~HostAsyncBus()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _isStopping = true;
+  }
+  _cond.notify_one();
+  _worker.join();
+}
+
+void HostAsyncBus::setDoneFct(HostBusDoneFct doneFct, void *ctx)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _doneFct = doneFct;
+  _doneCtx = ctx;
+}
+
+void HostAsyncBus::send(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t *pixels, uint16_t stride,
+                        void *ctx)
+{
+  HostAsyncBus *bus = (HostAsyncBus *)ctx;
+  {
+    std::lock_guard<std::mutex> lock(bus->_mutex);
+    Transfer t = {x, y, w, h, pixels, stride, bus->_doneFct, bus->_doneCtx};
+    bus->_transfer = t;
+    bus->_hasTransfer = true;
+  }
+  bus->_cond.notify_one();
+}
+
+void HostAsyncBus::_run()
+{
+  typedef std::chrono::steady_clock clock;
+
+  for (;;) {
+    Transfer t;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _cond.wait(lock, [this]() { return _hasTransfer || _isStopping; });
+      if (_isStopping && !_hasTransfer) {
+        return;
+      }
+      t = _transfer;
+      _hasTransfer = false;
+    }
+
+    // the bus is busy for the whole transfer time, the CPU is not
+    if (_bitsPerSecond > 0) {
+      uint64_t ns = (uint64_t)t.w * t.h * BITS_PER_PIXEL * 1000000000ULL / _bitsPerSecond;
+      std::this_thread::sleep_until(clock::now() + std::chrono::nanoseconds(ns));
+      _busyNs += ns;
+    }
+    _display.pushRect(t.x, t.y, t.w, t.h, t.pixels, t.stride);
+    if (t.doneFct != NULL) {
+      t.doneFct(t.doneCtx);
+    }
+  }
+}
@@ -0,0 +1,97 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    Simulated display bus for host builds, stands for SPI + DMA. Transfers are
+//    started with send() (DisplayAsyncSendFct compatible) and done by a worker
+//    thread, which takes the time the bus would take at the configured rate,
+//    copies the pixels to a HostDisplay and calls the completion function, as
+//    a DMA complete interrupt would. The completion function is read under the
+//    bus lock when a transfer starts, and called without it (it may send).
+//
+//***********************************************************************************
+
+#ifndef HOST_ASYNC_BUS_H
+#define HOST_ASYNC_BUS_H
+
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "HostDisplay.h"
+
+typedef void (*HostBusDoneFct)(void *ctx);
+
+class HostAsyncBus
+{
+public:
+  /***************************************************************************/
+  /*!
+      @brief Ctor, starts the worker thread
+      @param display receives the pixels
+      @param bitsPerSecond bus rate, 16 bits per pixel. 0 for an instant bus.
+  */
+  /***************************************************************************/
+  HostAsyncBus(HostDisplay &display, uint32_t bitsPerSecond);
+  ~HostAsyncBus();
+
+  /***************************************************************************/
+  /*!
+      @brief Set the completion function, for the next transfers. A transfer
+      already started completes with the previous one.
+  */
+  /***************************************************************************/
+  void setDoneFct(HostBusDoneFct doneFct, void *ctx);
+
+  /***************************************************************************/
+  /*!
+      @brief DisplayAsyncSendFct compatible function, ctx must point to a
+      HostAsyncBus. One transfer at a time, as a DMA channel.
+  */
+  /***************************************************************************/
+  static void send(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t *pixels, uint16_t stride, void *ctx);
+
+  uint64_t getBusyNs() const { return _busyNs.load(); }
+
+private:
+  struct Transfer
+  {
+    int16_t x;
+    int16_t y;
+    uint16_t w;
+    uint16_t h;
+    const uint16_t *pixels;
+    uint16_t stride;
+    HostBusDoneFct doneFct;
+    void *doneCtx;
+  };
+
+  HostDisplay &_display;
+  uint32_t _bitsPerSecond;
+  HostBusDoneFct _doneFct = NULL;
+  void *_doneCtx = NULL;
+  std::atomic<uint64_t> _busyNs{0};
+
+  std::mutex _mutex;
+  std::condition_variable _cond;
+  Transfer _transfer;
+  bool _hasTransfer = false;
+  bool _isStopping = false;
+  std::thread _worker;
+
+  void _run();
+};
+
+#endif
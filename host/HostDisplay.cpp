@@ -0,0 +1,43 @@
+#include "HostDisplay.h"
+
+#include <stdio.h>
+
+void HostDisplay::flush(int16_t x, int16_t y, uint16_t w, uint16_t h,
+                        const uint16_t *pixels, uint16_t stride, void *ctx)
+{
+  ((HostDisplay *)ctx)->pushRect(x, y, w, h, pixels, stride);
+}
+
+void HostDisplay::pushRect(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t *pixels, uint16_t stride)
+{
+  _transferNb++;
+  _pixelNb += (uint32_t)w * h;
+  for (uint16_t j = 0; j < h; j++) {
+    if ((y + j < 0) || (y + j >= _height)) {
+      continue;
+    }
+    for (uint16_t i = 0; i < w; i++) {
+      if ((x + i >= 0) && (x + i < _width)) {
+        _pixels[(size_t)(y + j) * _width + x + i] = pixels[(size_t)j * stride + i];
+      }
+    }
+  }
+}
+
+bool HostDisplay::writePpm(const char *path) const
+{
+  FILE *f = fopen(path, "wb");
+  if (f == NULL) {
+    return false;
+  }
+  fprintf(f, "P6\n%u %u\n255\n", _width, _height);
+  for (size_t i = 0; i < _pixels.size(); i++) {
+    uint16_t c = _pixels[i];
+    unsigned char rgb[3] = {
+        (unsigned char)(((c >> 11) & 0x1F) * 255 / 31),
+        (unsigned char)(((c >> 5) & 0x3F) * 255 / 63),
+        (unsigned char)((c & 0x1F) * 255 / 31)};
+    fwrite(rgb, 1, sizeof(rgb), f);
+  }
+  return fclose(f) == 0;
+}
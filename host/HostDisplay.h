@@ -0,0 +1,69 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    In-memory RGB565 screen for host builds. Receives DisplayFramebuffer
+//    flushes like a real display would, counts what it receives, and can be
+//    saved as a PPM image to look at the result.
+//
+//***********************************************************************************
+
+#ifndef HOST_DISPLAY_H
+#define HOST_DISPLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+class HostDisplay
+{
+public:
+  HostDisplay(uint16_t width, uint16_t height) : _width(width), _height(height), _pixels((size_t)width * height, 0) {}
+
+  /***************************************************************************/
+  /*!
+      @brief DisplayFlushFct compatible function, ctx must point to a HostDisplay
+  */
+  /***************************************************************************/
+  static void flush(int16_t x, int16_t y, uint16_t w, uint16_t h,
+                    const uint16_t *pixels, uint16_t stride, void *ctx);
+
+  void pushRect(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t *pixels, uint16_t stride);
+
+  uint16_t getPixel(uint16_t x, uint16_t y) const { return _pixels[(size_t)y * _width + x]; }
+  uint16_t getWidth() const { return _width; }
+  uint16_t getHeight() const { return _height; }
+
+  // Transfer counters, reset with resetCounters()
+  uint32_t getTransferNb() const { return _transferNb; }
+  uint32_t getPixelNb() const { return _pixelNb; }
+  void resetCounters() { _transferNb = 0; _pixelNb = 0; }
+
+  /***************************************************************************/
+  /*!
+      @brief Save the screen content as a binary PPM (P6) image
+      @return false if the file could not be written
+  */
+  /***************************************************************************/
+  bool writePpm(const char *path) const;
+
+private:
+  uint16_t _width;
+  uint16_t _height;
+  std::vector<uint16_t> _pixels;
+  uint32_t _transferNb = 0;
+  uint32_t _pixelNb = 0;
+};
+
+#endif
@@ -0,0 +1,12 @@
+#include "unity.h"
+
+// Runs a PlatformIO test sketch on host: setup() runs the tests, loop() ends them
+void setup();
+void loop();
+
+int main()
+{
+  setup();
+  loop();
+  return unityGetFailedNb();
+}
@@ -0,0 +1,71 @@
+#include "unity.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char *unityFile = "";
+static const char *unityTestName = "";
+static bool unityIsTestFailed = false;
+static int unityTestNb = 0;
+static int unityFailedNb = 0;
+
+void unityBegin(const char *file)
+{
+  unityFile = file;
+  unityTestNb = 0;
+  unityFailedNb = 0;
+}
+
+int unityEnd()
+{
+  printf("%s: %d tests, %d failures\n", unityFile, unityTestNb, unityFailedNb);
+  printf(unityFailedNb == 0 ? "OK\n" : "FAIL\n");
+  return unityFailedNb;
+}
+
+int unityGetFailedNb()
+{
+  return unityFailedNb;
+}
+
+void unityRun(UnityTestFct test, const char *name)
+{
+  unityTestName = name;
+  unityIsTestFailed = false;
+  test();
+  unityTestNb++;
+  if (unityIsTestFailed) {
+    unityFailedNb++;
+  } else {
+    printf("%s:PASS\n", name);
+  }
+}
+
+bool unityCheck(bool isOk, const char *file, int line, const char *text)
+{
+  if (!isOk) {
+    printf("%s:%d:%s:FAIL: %s\n", file, line, unityTestName, text);
+    unityIsTestFailed = true;
+  }
+  return isOk;
+}
+
+bool unityCheckEqual(long long expected, long long actual, const char *file, int line, const char *text)
+{
+  if (expected != actual) {
+    printf("%s:%d:%s:FAIL: %s is %lld, expected %lld\n", file, line, unityTestName, text, actual, expected);
+    unityIsTestFailed = true;
+    return false;
+  }
+  return true;
+}
+
+bool unityCheckString(const char *expected, const char *actual, const char *file, int line, const char *text)
+{
+  if (strcmp(expected, actual) != 0) {
+    printf("%s:%d:%s:FAIL: %s is \"%s\", expected \"%s\"\n", file, line, unityTestName, text, actual, expected);
+    unityIsTestFailed = true;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,64 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    Minimal stand-in for the Unity test framework used by PlatformIO, so the
+//    tests written for the target (test/) and the host tests (bench/) build and
+//    run on a host computer. Only provides the macros these tests use.
+//
+// Implementation:
+//    A failed assertion prints its line and returns from the test function,
+//    like Unity does. UNITY_END() returns the number of failed tests.
+//
+//***********************************************************************************
+
+#ifndef HOST_UNITY_H
+#define HOST_UNITY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef void (*UnityTestFct)(void);
+
+void unityBegin(const char *file);
+int unityEnd();
+int unityGetFailedNb();
+void unityRun(UnityTestFct test, const char *name);
+bool unityCheck(bool isOk, const char *file, int line, const char *text);
+bool unityCheckEqual(long long expected, long long actual, const char *file, int line, const char *text);
+bool unityCheckString(const char *expected, const char *actual, const char *file, int line, const char *text);
+
+#define UNITY_BEGIN() unityBegin(__FILE__)
+#define UNITY_END() unityEnd()
+#define RUN_TEST(fct) unityRun(fct, #fct)
+
+#define TEST_ASSERT_TRUE(condition)                                                                                   \
+  do {                                                                                                                \
+    if (!unityCheck((condition), __FILE__, __LINE__, #condition)) return;                                             \
+  } while (0)
+#define TEST_ASSERT_FALSE(condition) TEST_ASSERT_TRUE(!(condition))
+#define TEST_ASSERT(condition) TEST_ASSERT_TRUE(condition)
+#define TEST_ASSERT_NULL(pointer) TEST_ASSERT_TRUE((pointer) == NULL)
+#define TEST_ASSERT_NOT_NULL(pointer) TEST_ASSERT_TRUE((pointer) != NULL)
+#define TEST_ASSERT_EQUAL(expected, actual)                                                                           \
+  do {                                                                                                                \
+    if (!unityCheckEqual((long long)(expected), (long long)(actual), __FILE__, __LINE__, #actual)) return;            \
+  } while (0)
+#define TEST_ASSERT_EQUAL_STRING(expected, actual)                                                                    \
+  do {                                                                                                                \
+    if (!unityCheckString((expected), (actual), __FILE__, __LINE__, #actual)) return;                                 \
+  } while (0)
+#define TEST_ASSERT_EQUAL_MEMORY(expected, actual, len) TEST_ASSERT_TRUE(memcmp((expected), (actual), (len)) == 0)
+
+#endif
@@ -0,0 +1,119 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file describes the render backends, the glue between the menu
+//    renderer (see DisplayRenderer.h) and a display library, and contains the
+//    in-memory backend, which draws into a DisplayFramebuffer.
+//
+//    A backend is any class with these functions (no base class, the renderer
+//    is a template on the backend type, so calls are direct and can be inlined):
+//      void fillRect(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t color);
+//      void drawRect(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t color);
+//      void drawBitmap(int16_t x, int16_t y, const DisplayBitmap &bmp, uint16_t color, uint16_t bgColor);
+//      void drawText(int16_t x, int16_t y, const char *text, uint16_t color, uint16_t bgColor, uint8_t size);
+//      void pushPixels(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t *pixels, uint16_t stride);
+//      void flush();
+//    Bitmaps are opaque (0 bits drawn with bgColor), texts too. pushPixels sends
+//    a rectangle of RGB565 pixels through a single address window. flush() ends
+//    the frame (sends buffered pixels, waits for DMA, ... or does nothing).
+//
+//    Adapters: DisplayGfxBackend.h (Adafruit_GFX displays), DisplayTftEspiBackend.h
+//    (TFT_eSPI), DisplayFramebufferBackend below (headless, host tests).
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_BACKEND_H
+#define DISPLAY_BACKEND_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "DisplayBitmap.h"
+#include "DisplayBlit.h"
+#include "DisplayFramebuffer.h"
+
+// Widest bitmap row expanded in a line buffer and sent in one burst by the adapters
+#ifndef DISPLAY_BACKEND_LINE_PIXELS
+#define DISPLAY_BACKEND_LINE_PIXELS (320)
+#endif
+
+// Text cell of the in-memory backend, same as the Adafruit_GFX classic font
+#define DISPLAY_BACKEND_CHAR_WIDTH (6)
+#define DISPLAY_BACKEND_CHAR_HEIGHT (8)
+
+class DisplayFramebufferBackend
+{
+public:
+  /***************************************************************************/
+  /*!
+      @brief Ctor
+      @param fb framebuffer drawn into
+      @param flushFct receives the modified areas on flush(), can be NULL
+      @param ctx passed to flushFct
+  */
+  /***************************************************************************/
+  DisplayFramebufferBackend(DisplayFramebuffer &fb, DisplayFlushFct flushFct = NULL, void *ctx = NULL)
+      : _fb(fb), _flushFct(flushFct), _flushCtx(ctx) {}
+
+  void fillRect(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t color) { _fb.fillRect(x, y, w, h, color); }
+  void drawRect(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t color) { _fb.drawRect(x, y, w, h, color); }
+
+  void drawBitmap(int16_t x, int16_t y, const DisplayBitmap &bmp, uint16_t color, uint16_t bgColor)
+  {
+    _fb.drawBitmap(x, y, bmp, color, bgColor, false);
+  }
+
+  /***************************************************************************/
+  /*!
+      @brief No font: every character is drawn as a filled block in its cell,
+      spaces as background, so text position, size and colors can be checked.
+  */
+  /***************************************************************************/
+  void drawText(int16_t x, int16_t y, const char *text, uint16_t color, uint16_t bgColor, uint8_t size)
+  {
+    uint16_t cellW = DISPLAY_BACKEND_CHAR_WIDTH * size;
+    uint16_t cellH = DISPLAY_BACKEND_CHAR_HEIGHT * size;
+    for (; *text != '\0'; text++, x += cellW) {
+      _fb.fillRect(x, y, cellW, cellH, bgColor);
+      if (*text != ' ') {
+        _fb.fillRect(x, y, cellW - size, cellH - size, color);
+      }
+    }
+  }
+
+  void pushPixels(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t *pixels, uint16_t stride)
+  {
+    for (uint16_t j = 0; j < h; j++) {
+      if ((y + j < 0) || (y + j >= _fb.getHeight())) {
+        continue;
+      }
+      for (uint16_t i = 0; i < w; i++) {
+        _fb.drawPixel(x + i, y + j, pixels[(uint32_t)j * stride + i]);
+      }
+    }
+  }
+
+  void flush() { _pixelNb += _fb.flush(_flushFct, _flushCtx); }
+
+  DisplayFramebuffer &getFramebuffer() { return _fb; }
+  uint32_t getFlushedPixelNb() { return _pixelNb; }
+
+private:
+  DisplayFramebuffer &_fb;
+  DisplayFlushFct _flushFct;
+  void *_flushCtx;
+  uint32_t _pixelNb = 0;
+};
+
+#endif
@@ -14,6 +14,18 @@
 //
 // Description:
 //    This file contains a structure for generating a 2 dimensional bitmap object.
+//    Bitmaps are 1 bit per pixel, rows padded to full bytes, MSB first (same
+//    format as Adafruit_GFX drawBitmap).
+//    DisplayPackedBitmap holds the same bitmap compressed with PackBits, and
+//    DisplayBitmapDecoder decompresses it row by row while drawing, so icons take
+//    less flash without needing a RAM buffer for the whole bitmap.
+//
+// PackBits format:
+//    The row bytes of the bitmap are packed as one stream (runs can continue on
+//    the next row). A header byte n is followed by:
+//      0 to 127:    n+1 literal bytes
+//      -1 to -127:  one byte, repeated 1-n times
+//      -128:        nothing, skipped
 //
 //***********************************************************************************
 
@@ -21,6 +33,14 @@
 #define DISPLAY_BITMAP_H
 
 #include "stdint.h"
+#include <stddef.h>
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define DISPLAY_BITMAP_READ(addr) pgm_read_byte(addr)
+#else
+#define DISPLAY_BITMAP_READ(addr) (*(const uint8_t *)(addr))
+#endif
 
 struct DisplayBitmap
 {
@@ -33,6 +53,88 @@ struct DisplayBitmap
     unsigned int width;
     unsigned int height;
     const unsigned char* bitmap;
+
+    uint16_t getRowBytes() const { return (width + 7) / 8; }
+};
+
+struct DisplayPackedBitmap
+{
+    DisplayPackedBitmap(unsigned int w, unsigned int h, const unsigned char* packedBm)
+    {
+        width = w;
+        height = h;
+        packed = packedBm;
+    }
+    unsigned int width;
+    unsigned int height;
+    const unsigned char* packed;
+
+    uint16_t getRowBytes() const { return (width + 7) / 8; }
+
+    /***************************************************************************/
+    /*!
+      @brief  Compress a bitmap with PackBits, to generate packed bitmap tables
+      (for instance from a host program)
+      @param  bmp     bitmap to compress
+      @param  out     destination of the packed data
+      @param  outSize size of out, in bytes
+      @return size of the packed data, 0 if it does not fit in out
+    */
+    /***************************************************************************/
+    static uint16_t pack(const DisplayBitmap &bmp, unsigned char *out, uint16_t outSize);
+};
+
+/***************************************************************************/
+/*!
+    @brief Function called for each span of set pixels in a row
+    @param x    first pixel of the span, from the left of the bitmap
+    @param y    row of the span, from the top of the bitmap
+    @param len  number of set pixels
+    @param ctx  user pointer
+*/
+/***************************************************************************/
+typedef void (*DisplaySpanFct)(uint16_t x, uint16_t y, uint16_t len, void *ctx);
+
+class DisplayBitmapDecoder
+{
+public:
+    DisplayBitmapDecoder(const DisplayPackedBitmap &bmp) : _bmp(bmp) { restart(); }
+
+    /***************************************************************************/
+    /*!
+      @brief  Go back to the first row of the bitmap
+    */
+    /***************************************************************************/
+    void restart();
+
+    /***************************************************************************/
+    /*!
+      @brief  Decode the next row into rowBytes, getRowBytes() bytes long
+      @return false if every row was decoded
+    */
+    /***************************************************************************/
+    bool nextRow(unsigned char *rowBytes);
+
+    /***************************************************************************/
+    /*!
+      @brief  Decode the next row and call spanFct for each run of set pixels,
+      without any row buffer
+      @return false if every row was decoded
+    */
+    /***************************************************************************/
+    bool nextRowSpans(DisplaySpanFct spanFct, void *ctx = NULL);
+
+    uint16_t getRow() { return _row; }
+
+private:
+    const DisplayPackedBitmap &_bmp;
+    const unsigned char *_src;
+    uint16_t _row;
+    uint8_t _runLeft;       // bytes left in the current literal or repeat run
+    bool _isRepeatRun;
+    uint8_t _repeatByte;
+
+    uint8_t _nextByte();
 };
 
 
@@ -0,0 +1,91 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file contains a kernel that expands 1 bit per pixel bitmap rows into
+//    RGB565 foreground/background pixels, in a line buffer given by the user.
+//    The line buffer can then be pushed to the display in one transfer, or
+//    copied in a DisplayFramebuffer.
+//
+// Implementation:
+//    Each nibble of the bitmap is looked up in a 16 entries table holding the 4
+//    matching pixels as one 64 bit word, written at once (no test per pixel).
+//    The table is rebuilt when colors change. On x86 host builds, SSE2 expands
+//    a whole byte (8 pixels) per instruction sequence instead, define
+//    DISPLAY_BLIT_NO_SIMD to use the portable path everywhere.
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_BLIT_H
+#define DISPLAY_BLIT_H
+
+#include <stdint.h>
+#include "DisplayBitmap.h"
+
+#if defined(__SSE2__) && !defined(DISPLAY_BLIT_NO_SIMD) && !defined(ARDUINO)
+#define DISPLAY_BLIT_SSE2
+#endif
+
+class DisplayBlit
+{
+public:
+  DisplayBlit(uint16_t fgColor = 0xFFFF, uint16_t bgColor = 0x0000) { setColors(fgColor, bgColor); }
+
+  /***************************************************************************/
+  /*!
+      @brief Set the colors of the set (fg) and cleared (bg) bits
+  */
+  /***************************************************************************/
+  void setColors(uint16_t fgColor, uint16_t bgColor);
+  uint16_t getFgColor() { return _fgColor; }
+  uint16_t getBgColor() { return _bgColor; }
+
+  /***************************************************************************/
+  /*!
+      @brief Expand one bitmap row into RGB565 pixels
+      @param bits  row of the bitmap, MSB first (can be in PROGMEM)
+      @param width number of pixels to expand
+      @param line  destination, at least width pixels
+  */
+  /***************************************************************************/
+  void expandRow(const unsigned char *bits, uint16_t width, uint16_t *line) { _expandRow(bits, width, line, true); }
+
+  /***************************************************************************/
+  /*!
+      @brief Same for a row built at run time: bits are always read from RAM,
+      also on AVR where expandRow() reads PROGMEM
+  */
+  /***************************************************************************/
+  void expandRamRow(const unsigned char *bits, uint16_t width, uint16_t *line) { _expandRow(bits, width, line, false); }
+
+  /***************************************************************************/
+  /*!
+      @brief Expand one row of a bitmap
+      @param row row index, from the top of the bitmap
+  */
+  /***************************************************************************/
+  void expandRow(const DisplayBitmap &bmp, uint16_t row, uint16_t *line)
+  {
+    expandRow(&bmp.bitmap[(uint32_t)row * bmp.getRowBytes()], bmp.width, line);
+  }
+
+private:
+  uint16_t _fgColor;
+  uint16_t _bgColor;
+  uint64_t _nibbleLut[16];   // 4 pixels for every nibble value
+
+  void _expandRow(const unsigned char *bits, uint16_t width, uint16_t *line, bool isProgmem);
+};
+
+#endif
@@ -0,0 +1,185 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file contains a rectangle structure and a damage region object, that
+//    accumulates the screen areas that need to be refreshed.
+//    Rectangles that overlap are always merged, so no pixel is in two of them
+//    and none is pushed twice. Rectangles that only touch are merged when
+//    their union covers no more pixels than both of them, so the list stays
+//    small without growing the area to push.
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_DAMAGE_H
+#define DISPLAY_DAMAGE_H
+
+#include "stdint.h"
+
+#define MAX_DAMAGE_RECTS_NB (4)
+
+struct DisplayRect
+{
+  int16_t x;
+  int16_t y;
+  uint16_t w;
+  uint16_t h;
+
+  bool isEmpty() const { return (w == 0) || (h == 0); }
+  uint32_t area() const { return (uint32_t)w * h; }
+
+  /***************************************************************************/
+  /*!
+    @brief  Check if two rectangles overlap or share an edge
+    @param  other rectangle to compare with
+  */
+  /***************************************************************************/
+  bool touches(const DisplayRect &other) const
+  {
+    return (x <= other.x + (int32_t)other.w) && (other.x <= x + (int32_t)w) &&
+           (y <= other.y + (int32_t)other.h) && (other.y <= y + (int32_t)h);
+  }
+
+  bool overlaps(const DisplayRect &other) const
+  {
+    return !isEmpty() && !other.isEmpty() &&
+           (x < other.x + (int32_t)other.w) && (other.x < x + (int32_t)w) &&
+           (y < other.y + (int32_t)other.h) && (other.y < y + (int32_t)h);
+  }
+
+  // Common area of two overlapping rectangles
+  DisplayRect intersect(const DisplayRect &other) const
+  {
+    int16_t x0 = (x > other.x) ? x : other.x;
+    int16_t y0 = (y > other.y) ? y : other.y;
+    int32_t x1 = ((x + (int32_t)w) < (other.x + (int32_t)other.w)) ? (x + (int32_t)w) : (other.x + (int32_t)other.w);
+    int32_t y1 = ((y + (int32_t)h) < (other.y + (int32_t)other.h)) ? (y + (int32_t)h) : (other.y + (int32_t)other.h);
+    DisplayRect r = {x0, y0, (uint16_t)((x1 > x0) ? x1 - x0 : 0), (uint16_t)((y1 > y0) ? y1 - y0 : 0)};
+    return r;
+  }
+
+  DisplayRect unite(const DisplayRect &other) const
+  {
+    int16_t x0 = (x < other.x) ? x : other.x;
+    int16_t y0 = (y < other.y) ? y : other.y;
+    int32_t x1 = ((x + (int32_t)w) > (other.x + (int32_t)other.w)) ? (x + (int32_t)w) : (other.x + (int32_t)other.w);
+    int32_t y1 = ((y + (int32_t)h) > (other.y + (int32_t)other.h)) ? (y + (int32_t)h) : (other.y + (int32_t)other.h);
+    DisplayRect r = {x0, y0, (uint16_t)(x1 - x0), (uint16_t)(y1 - y0)};
+    return r;
+  }
+};
+
+class DisplayDamage
+{
+private:
+  DisplayRect _rects[MAX_DAMAGE_RECTS_NB];
+  uint8_t _rectNb = 0;
+
+  void _remove(uint8_t idx)
+  {
+    _rects[idx] = _rects[--_rectNb];
+  }
+
+  /***************************************************************************/
+  /*!
+    @brief  Merge rectangle at idx with every other rectangle it can be merged
+    with, until the list is stable (a merge can make it touch another one)
+  */
+  /***************************************************************************/
+  void _coalesce(uint8_t idx)
+  {
+    bool merged = true;
+    while (merged) {
+      merged = false;
+      for (uint8_t i = 0; i < _rectNb; i++) {
+        if ((i != idx) && _isWorthMerging(_rects[idx], _rects[i])) {
+          _rects[idx] = _rects[idx].unite(_rects[i]);
+          _remove(i);
+          if (idx == _rectNb) {
+            idx = i; // merged rect was moved in the removed slot
+          }
+          merged = true;
+          break;
+        }
+      }
+    }
+  }
+
+  // Overlapping rects are always merged, touching ones only when the union
+  // does not cover more pixels than both rects separately
+  static bool _isWorthMerging(const DisplayRect &a, const DisplayRect &b)
+  {
+    return a.overlaps(b) || (a.touches(b) && (a.unite(b).area() <= (a.area() + b.area())));
+  }
+
+public:
+  /***************************************************************************/
+  /*!
+    @brief  Add an area to refresh. If the list is full, the rectangle is merged
+    with the one that grows the least.
+    @param  rect area in pixels
+  */
+  /***************************************************************************/
+  void add(const DisplayRect &rect)
+  {
+    if (rect.isEmpty()) {
+      return;
+    }
+    for (uint8_t i = 0; i < _rectNb; i++) {
+      if (_isWorthMerging(_rects[i], rect)) {
+        _rects[i] = _rects[i].unite(rect);
+        _coalesce(i);
+        return;
+      }
+    }
+    if (_rectNb < MAX_DAMAGE_RECTS_NB) {
+      _rects[_rectNb++] = rect;
+      return;
+    }
+
+    uint8_t best = 0;
+    uint32_t bestGrowth = 0xFFFFFFFF;
+    for (uint8_t i = 0; i < _rectNb; i++) {
+      uint32_t growth = _rects[i].unite(rect).area() - _rects[i].area();
+      if (growth < bestGrowth) {
+        bestGrowth = growth;
+        best = i;
+      }
+    }
+    _rects[best] = _rects[best].unite(rect);
+    _coalesce(best);
+  }
+
+  void add(int16_t x, int16_t y, uint16_t w, uint16_t h)
+  {
+    DisplayRect r = {x, y, w, h};
+    add(r);
+  }
+
+  void clear() { _rectNb = 0; }
+  uint8_t getRectNb() const { return _rectNb; }
+  const DisplayRect &getRect(uint8_t idx) const { return _rects[idx]; }
+
+  bool overlaps(const DisplayRect &rect) const
+  {
+    for (uint8_t i = 0; i < _rectNb; i++) {
+      if (_rects[i].overlaps(rect)) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+#endif
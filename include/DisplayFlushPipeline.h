@@ -0,0 +1,167 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file contains an asynchronous flush for a banded DisplayFramebuffer.
+//    The framebuffer alternates between two band buffers: while the touched
+//    tiles of band N are sent to the display (DMA, SPI interrupt, another
+//    task, ...), band N+1 is drawn in the other buffer. Drawing and transfers
+//    overlap, so a frame takes about the longest of the two instead of their sum.
+//
+//        fb.startBand();
+//        do {
+//          drawPage(fb);
+//          pipeline.submitBand();
+//        } while (fb.nextBand());
+//
+// Implementation:
+//    Each buffer has a job: the list of rectangles to send from it. Transfers are
+//    started by a user function that returns right away, and the end of each one
+//    is reported with transferDone() (DMA complete interrupt). Jobs are sent one
+//    rectangle at a time. The main loop and the completion side share
+//    a busy flag taken with compare and swap, so whichever side finds the bus
+//    free starts the next job, with no lock.
+//    A buffer is only drawn into again once its job is completely sent.
+//    The main loop waits for it by polling, calling the wait function (yield()
+//    by default) between polls. The pipeline has no timeout of its own: if
+//    transferDone() is never called (lost interrupt, bus error), submitBand()
+//    and waitIdle() never return. A wait function can detect it, i.e. reset the
+//    bus and call transferDone() after a timeout.
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_FLUSH_PIPELINE_H
+#define DISPLAY_FLUSH_PIPELINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Arduino.h"
+#include "DisplayFramebuffer.h"
+
+#ifndef DISPLAY_PIPELINE_MAX_RECTS
+#define DISPLAY_PIPELINE_MAX_RECTS (32)   // per band, more rects make submitBand() wait
+#endif
+#define DISPLAY_PIPELINE_BUFFER_NB (2)
+
+/***************************************************************************/
+/*!
+    @brief Function that starts sending a rectangle of pixels and returns
+    without waiting. Same parameters as DisplayFlushFct. The pixels stay
+    unchanged until DisplayFlushPipeline::transferDone() is called.
+*/
+/***************************************************************************/
+typedef DisplayFlushFct DisplayAsyncSendFct;
+
+/***************************************************************************/
+/*!
+    @brief Function called while the main loop waits for a buffer or for the
+    end of the transfers, i.e. to yield to other tasks, sleep until the next
+    interrupt, or watch for a transfer that never ends.
+    @param ctx user pointer given to DisplayFlushPipeline::setWaitFct()
+*/
+/***************************************************************************/
+typedef void (*DisplayPipelineWaitFct)(void *ctx);
+
+class DisplayFlushPipeline
+{
+public:
+  /***************************************************************************/
+  /*!
+      @brief Ctor
+      @param fb framebuffer, its current buffer is the first one of the pipeline
+      @param secondBuffer buffer of the same size as the framebuffer one
+      @param sendFct starts a transfer
+      @param ctx passed to sendFct
+  */
+  /***************************************************************************/
+  DisplayFlushPipeline(DisplayFramebuffer &fb, uint16_t *secondBuffer, DisplayAsyncSendFct sendFct, void *ctx = NULL);
+
+  /***************************************************************************/
+  /*!
+      @brief Queue the touched tiles of the current band for sending, then give
+      the framebuffer the other buffer, once it is free, to draw the next band.
+      @return number of pixels queued
+  */
+  /***************************************************************************/
+  uint32_t submitBand();
+
+  /***************************************************************************/
+  /*!
+      @brief To call when a transfer started by sendFct is complete. Can be
+      called from an interrupt or another thread, it may start the next transfer.
+  */
+  /***************************************************************************/
+  void transferDone();
+  static void transferDone(void *pipeline) { ((DisplayFlushPipeline *)pipeline)->transferDone(); }
+
+  bool isBusy() { return __atomic_load_n(&_isBusSending, __ATOMIC_ACQUIRE) != 0; }
+
+  /***************************************************************************/
+  /*!
+      @brief Set the function called between polls while waiting for the bus,
+      yield() when none is set
+      @param waitFct called from the main loop only, NULL for yield()
+      @param ctx passed to waitFct
+  */
+  /***************************************************************************/
+  void setWaitFct(DisplayPipelineWaitFct waitFct, void *ctx = NULL) { _waitFct = waitFct; _waitCtx = ctx; }
+
+  /***************************************************************************/
+  /*!
+      @brief Wait until every queued band is sent, i.e. before reading the
+      display back or sleeping. Never returns if a transfer is not reported
+      done, see setWaitFct().
+  */
+  /***************************************************************************/
+  void waitIdle();
+
+private:
+  enum JobState : uint8_t
+  {
+    JOB_FREE = 0,   // buffer can be drawn into
+    JOB_PENDING,    // waiting for the bus
+    JOB_SENDING
+  };
+
+  struct Job
+  {
+    DisplayRect rects[DISPLAY_PIPELINE_MAX_RECTS];
+    const uint16_t *pixels[DISPLAY_PIPELINE_MAX_RECTS];
+    uint8_t rectNb;
+    uint8_t sentNb;     // written by the completion side only once submitted
+    uint8_t state;
+  };
+
+  DisplayFramebuffer &_fb;
+  uint16_t *_buffers[DISPLAY_PIPELINE_BUFFER_NB];
+  DisplayAsyncSendFct _sendFct;
+  void *_sendCtx;
+  Job _jobs[DISPLAY_PIPELINE_BUFFER_NB];
+  uint8_t _drawIdx = 0;         // buffer drawn into, main loop only
+  uint8_t _sendIdx = 0;         // job being sent, owned by the side holding the bus
+  uint8_t _isBusSending = 0;    // taken with compare and swap
+  DisplayPipelineWaitFct _waitFct = NULL;
+  void *_waitCtx = NULL;
+
+  static void _collect(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t *pixels, uint16_t stride,
+                       void *ctx);
+  void _submit(uint8_t jobIdx);
+  void _waitFree(uint8_t jobIdx);
+  void _wait();
+  int8_t _findPending();
+  void _kick();
+  void _sendNextRect(Job &job);
+};
+
+#endif
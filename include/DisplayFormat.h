@@ -0,0 +1,68 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file contains the text formatting of widget values, written in a
+//    buffer given by the caller: fixed width with padding, fixed point decimals
+//    and a unit suffix (i.e. " 12.5V"). No heap and no printf, so printing a
+//    page does not allocate and takes the same time every frame.
+//
+// Implementation:
+//    Digits are written from the end of a small stack buffer, then the sign,
+//    padding and unit are placed around them. Integers are printed from their
+//    magnitude, so INT32_MIN and values over INT32_MAX (uint32_t) are correct.
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_FORMAT_H
+#define DISPLAY_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Widest value text: sign, 10 digits, point, leading 0 of small fixed point values
+#define DISPLAY_FORMAT_NUMBER_LEN (14)
+
+struct DisplayValueFormat
+{
+  uint8_t width;          // minimum text length, unit included, padded up to it
+  uint8_t decimals;       // digits after the point. Integers are fixed point raw values in 1/10^decimals units
+  const char *unit;       // appended after the number, NULL for none
+  char padChar;           // ' ' if 0. '0' pads between the sign and the digits, right aligned only (' ' if left aligned)
+  bool isRightAligned;    // padding before the value instead of after it
+};
+
+/***************************************************************************/
+/*!
+    @brief Write an integer value
+    @param value    raw value, in 1/10^decimals units
+    @param format   output format, {} for the value alone
+    @param text     destination, always NUL terminated
+    @param textSize size of text, NUL included
+    @return text length, 0 (empty text) if it does not fit
+*/
+/***************************************************************************/
+uint8_t displayFormatInt(int32_t value, const DisplayValueFormat &format, char *text, uint8_t textSize);
+uint8_t displayFormatUInt(uint32_t value, const DisplayValueFormat &format, char *text, uint8_t textSize);
+
+/***************************************************************************/
+/*!
+    @brief Write a float value, rounded to format.decimals digits after the
+    point. Values out of the int32 range after scaling are clamped. NaN is
+    written "nan", padded with spaces, without the unit.
+*/
+/***************************************************************************/
+uint8_t displayFormatFloat(float value, const DisplayValueFormat &format, char *text, uint8_t textSize);
+
+#endif
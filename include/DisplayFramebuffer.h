@@ -0,0 +1,176 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file contains an off-screen RGB565 framebuffer. Drawing happens in RAM,
+//    then flush() sends to the display only the tiles that were drawn into, as
+//    few rectangles as possible (consecutive tiles of a row are sent together).
+//
+// Implementation:
+//    The pixel buffer is provided by the user (no dynamic allocation). It can
+//    hold the full screen, or a band of rows only when RAM is short. In banded
+//    mode, the page is drawn once per band (see startBand() and nextBand()),
+//    drawing is clipped to the current band, and every tile that is sent must be
+//    fully redrawn during the band pass since the buffer is shared by all bands.
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_FRAMEBUFFER_H
+#define DISPLAY_FRAMEBUFFER_H
+
+#include <stdint.h>
+#include <string.h>
+#include "DisplayBitmap.h"
+#include "DisplayBlit.h"
+#include "DisplayDamage.h"
+
+#ifndef FRAMEBUFFER_MAX_TILES_NB
+#define FRAMEBUFFER_MAX_TILES_NB (1024)
+#endif
+#define FRAMEBUFFER_DFLT_TILE_SIZE (16)
+
+/***************************************************************************/
+/*!
+    @brief Function called by flush() for every rectangle to send to the display.
+    @param x,y,w,h  area on the display, in pixels
+    @param pixels   first pixel of the area, in native RGB565 (byte swap for SPI
+                    is left to the display driver)
+    @param stride   number of pixels between two rows of pixels
+    @param ctx      user pointer given to flush()
+*/
+/***************************************************************************/
+typedef void (*DisplayFlushFct)(int16_t x, int16_t y, uint16_t w, uint16_t h,
+                                const uint16_t *pixels, uint16_t stride, void *ctx);
+
+class DisplayFramebuffer
+{
+public:
+  /***************************************************************************/
+  /*!
+      @brief Ctor for DisplayFramebuffer
+      @param buffer      pixel storage, width * bandHeight pixels
+      @param width       screen width in pixels
+      @param height      screen height in pixels
+      @param bandHeight  rows held by the buffer. 0 (default) means full screen.
+      @param tileSize    side of the square tiles tracked for flush, in pixels.
+        Doubled if the screen needs more than FRAMEBUFFER_MAX_TILES_NB tiles.
+  */
+  /***************************************************************************/
+  DisplayFramebuffer(uint16_t *buffer, uint16_t width, uint16_t height, uint16_t bandHeight = 0,
+                     uint16_t tileSize = FRAMEBUFFER_DFLT_TILE_SIZE);
+
+  uint16_t getWidth() { return _width; }
+  uint16_t getHeight() { return _height; }
+  uint16_t getTileSize() { return _tileSize; }
+  bool isBanded() { return _bandHeight < _height; }
+
+  /***************************************************************************/
+  /*!
+      @brief Banded mode: go back to the first band, drawing is clipped to it.
+      Does nothing special in full screen mode.
+      @param none
+  */
+  /***************************************************************************/
+  void startBand();
+
+  /***************************************************************************/
+  /*!
+      @brief Banded mode: move to the next band, once the current one is flushed
+      @return false when every band of the screen was drawn
+  */
+  /***************************************************************************/
+  bool nextBand();
+  uint16_t getBandY() { return _bandY; }
+  uint16_t getBandHeight() { return _bandHeight; }
+
+  // Drawing, clipped to the screen and to the current band
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) { fillRect(x, y, w, 1, color); }
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) { fillRect(x, y, 1, h, color); }
+  void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+
+  /***************************************************************************/
+  /*!
+      @brief Draw a 1 bit per pixel bitmap, rows padded to full bytes, MSB first
+      (same format as Adafruit_GFX drawBitmap)
+      @param transparent if true, 0 bits leave the framebuffer untouched,
+        otherwise they are drawn with bgColor
+  */
+  /***************************************************************************/
+  void drawBitmap(int16_t x, int16_t y, const DisplayBitmap &bmp, uint16_t color,
+                  uint16_t bgColor = 0, bool transparent = true);
+
+  /***************************************************************************/
+  /*!
+      @brief Draw a PackBits compressed bitmap, decoded while drawing. Set pixels
+      are drawn as horizontal spans, 0 bits are transparent.
+  */
+  /***************************************************************************/
+  void drawBitmap(int16_t x, int16_t y, const DisplayPackedBitmap &bmp, uint16_t color);
+
+  uint16_t *getBuffer() { return _buffer; }
+
+  /***************************************************************************/
+  /*!
+      @brief Draw into another pixel buffer of the same size, i.e. while the
+      previous one is being sent (see DisplayFlushPipeline)
+  */
+  /***************************************************************************/
+  void setBuffer(uint16_t *buffer) { _buffer = buffer; }
+
+  /***************************************************************************/
+  /*!
+      @brief Mark an area as modified, for drawing done directly into getBuffer()
+  */
+  /***************************************************************************/
+  void touch(int16_t x, int16_t y, int16_t w, int16_t h);
+  bool isTileTouched(uint16_t tileX, uint16_t tileY);
+
+  /***************************************************************************/
+  /*!
+      @brief Send the touched tiles of the current band to the display, then
+      forget them.
+      @param flushFct function that sends a rectangle of pixels to the display
+      @param ctx      user pointer passed to flushFct
+      @return number of pixels sent
+  */
+  /***************************************************************************/
+  uint32_t flush(DisplayFlushFct flushFct, void *ctx = NULL);
+
+private:
+  uint16_t *_buffer;
+  uint16_t _width;
+  uint16_t _height;
+  uint16_t _bandHeight;
+  uint16_t _bandY = 0;
+
+  uint16_t _tileSize;
+  uint16_t _tilesPerRow;
+  uint8_t _touchedTiles[FRAMEBUFFER_MAX_TILES_NB / 8];
+  DisplayBlit _blit;      // expands opaque bitmaps straight into the buffer
+
+  // Clip rect to the screen and the current band, false if nothing is left
+  bool _clip(int16_t &x, int16_t &y, int16_t &w, int16_t &h);
+  void _touchClipped(int16_t x, int16_t y, int16_t w, int16_t h);
+  static void _drawSpan(uint16_t x, uint16_t y, uint16_t len, void *ctx);
+  int16_t _spanX = 0;     // origin and color of the packed bitmap being drawn
+  int16_t _spanY = 0;
+  uint16_t _spanColor = 0;
+
+  uint16_t *_pixelAt(int16_t x, int16_t y) { return &_buffer[(uint32_t)(y - _bandY) * _width + x]; }
+};
+
+#endif
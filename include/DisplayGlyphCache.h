@@ -0,0 +1,125 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file contains a cache of the characters printed by numeric widgets
+//    (digits, sign, decimal point and a few units), rasterized once at the menu
+//    text size. Printing a value then copies ready made glyph rows instead of
+//    going through the display library font renderer, which draws scaled text
+//    one pixel block at a time. Edits with a held key stay smooth on slow MCUs.
+//
+// Implementation:
+//    Glyphs come from the Adafruit_GFX classic 5x7 font, so cached text looks
+//    the same as text printed by the display library. They are stored scaled,
+//    1 bit per pixel, and expanded to RGB565 with one DisplayBlit per widget
+//    state color (idle, target, editing), whose tables are built with the
+//    cache. A text is expanded in a strip buffer, a few rows at a time, and each
+//    strip is sent in a single transfer.
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_GLYPH_CACHE_H
+#define DISPLAY_GLYPH_CACHE_H
+
+#include <stdint.h>
+#include "DisplayBlit.h"
+#include "DisplayFramebuffer.h"
+
+class DisplayMenu;
+
+// Largest text size the cache can be built for
+#ifndef GLYPH_CACHE_MAX_TEXT_SIZE
+#define GLYPH_CACHE_MAX_TEXT_SIZE (3)
+#endif
+
+// Longest text drawn by the cache
+#ifndef GLYPH_CACHE_MAX_CHARS
+#define GLYPH_CACHE_MAX_CHARS (8)
+#endif
+
+// Pixel rows expanded before each transfer
+#ifndef GLYPH_CACHE_STRIP_ROWS
+#define GLYPH_CACHE_STRIP_ROWS (4)
+#endif
+
+#define GLYPH_CACHE_CHARS "0123456789-+. %VACms"
+#define GLYPH_CACHE_GLYPH_NB (20)
+#define GLYPH_CACHE_STATE_NB (3)   // idle, target, editing
+
+#define GLYPH_CACHE_CHAR_WIDTH (6)   // classic font cell
+#define GLYPH_CACHE_CHAR_HEIGHT (8)
+
+#define GLYPH_CACHE_ROW_BYTES ((GLYPH_CACHE_CHAR_WIDTH * GLYPH_CACHE_MAX_TEXT_SIZE + 7) / 8)
+#define GLYPH_CACHE_GLYPH_BYTES (GLYPH_CACHE_ROW_BYTES * GLYPH_CACHE_CHAR_HEIGHT * GLYPH_CACHE_MAX_TEXT_SIZE)
+
+class DisplayGlyphCache
+{
+public:
+  /***************************************************************************/
+  /*!
+      @brief Rasterize the glyphs and prepare the state colors
+      @param textSize scale of the 6x8 font cell, up to GLYPH_CACHE_MAX_TEXT_SIZE
+      @param colors   idle, target and editing text colors
+      @param bgColor  background of the text cells
+      @return false if the text size is not supported, the cache is then empty
+  */
+  /***************************************************************************/
+  bool build(uint8_t textSize, const uint16_t colors[GLYPH_CACHE_STATE_NB], uint16_t bgColor);
+
+  /***************************************************************************/
+  /*!
+      @brief Same with the colors of a menu (see DisplayMenu::setColors), to be
+      called again when they change
+  */
+  /***************************************************************************/
+  bool build(DisplayMenu &menu, uint8_t textSize);
+
+  bool isBuilt() { return _textSize != 0; }
+  uint8_t getTextSize() { return _textSize; }
+  uint16_t getCharWidth() { return GLYPH_CACHE_CHAR_WIDTH * _textSize; }
+  uint16_t getCharHeight() { return GLYPH_CACHE_CHAR_HEIGHT * _textSize; }
+
+  /***************************************************************************/
+  /*!
+      @brief Check if a text can be drawn from the cache with a color
+      @return false if a character is not cached, the text is too long or the
+      color is not one of the state colors
+  */
+  /***************************************************************************/
+  bool canDraw(const char *text, uint16_t color);
+
+  /***************************************************************************/
+  /*!
+      @brief Draw a text with opaque cells, like the display library would
+      @param x,y     top left of the first cell
+      @param text    cached characters only (see canDraw)
+      @param color   one of the state colors
+      @param pushFct receives the text, GLYPH_CACHE_STRIP_ROWS rows at a time
+      @param ctx     passed to pushFct
+      @return false if nothing was drawn (see canDraw)
+  */
+  /***************************************************************************/
+  bool drawText(int16_t x, int16_t y, const char *text, uint16_t color, DisplayFlushFct pushFct, void *ctx = NULL);
+
+private:
+  uint8_t _textSize = 0;
+  uint8_t _glyphs[GLYPH_CACHE_GLYPH_NB][GLYPH_CACHE_GLYPH_BYTES];
+  DisplayBlit _blits[GLYPH_CACHE_STATE_NB];
+  uint16_t _strip[GLYPH_CACHE_MAX_CHARS * GLYPH_CACHE_CHAR_WIDTH * GLYPH_CACHE_MAX_TEXT_SIZE * GLYPH_CACHE_STRIP_ROWS];
+
+  static int8_t _glyphIdx(char c);
+  int8_t _stateIdx(uint16_t color);
+};
+
+#endif
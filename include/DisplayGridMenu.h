@@ -0,0 +1,113 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file contains a DisplayMenu for pages with a layout known at compile
+//    time. The number of widgets on each axis are template parameters, so index
+//    and wrapping math are constant folded, and a widget array that does not
+//    match the grid is a compile error.
+//
+// Implementation:
+//    Same behavior as DisplayMenu, which it extends. The move functions are
+//    hidden (not virtual, DisplayMenu has no vtable) by constant folded ones,
+//    everything else (printing, colors, dirty widgets) is shared. Queued inputs
+//    (processInputs) and held keys (holdKey), as well as calls through a
+//    DisplayMenu reference, go through the DisplayMenu navigation: same cursor
+//    positions, since the grid is given to DisplayMenu, without the folding.
+//    The layout and virtual list pages of DisplayMenu are not available.
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_GRID_MENU_H
+#define DISPLAY_GRID_MENU_H
+
+#include <stddef.h>
+#include "DisplayMenu.h"
+
+template <uint16_t Y_NB, uint16_t X_NB = 1>
+class DisplayGridMenu : public DisplayMenu
+{
+  static_assert((Y_NB > 0) && (X_NB > 0), "a menu grid needs at least one widget");
+  static_assert((Y_NB <= MAX_SINGLE_AXIS_NB_WIDGETS) && (X_NB <= MAX_SINGLE_AXIS_NB_WIDGETS),
+                "menu grid is larger than MAX_SINGLE_AXIS_NB_WIDGETS");
+
+public:
+  static const uint16_t WIDGET_NB = Y_NB * X_NB;
+
+  /***************************************************************************/
+  /*!
+      @brief Set the widgets of the current page, the array size must match
+      the menu grid.
+      @param wdgList array of Y_NB * X_NB widgets, column after column
+  */
+  /***************************************************************************/
+  template <size_t N>
+  void setDisplayedWidgets(DisplayWidget (&wdgList)[N])
+  {
+    static_assert(N == WIDGET_NB, "widget array size does not match the menu grid");
+    DisplayMenu::setDisplayedWidgets(wdgList, Y_NB, X_NB);
+  }
+
+  uint16_t getWidgetNb() { return WIDGET_NB; }
+
+  void moveUp(int amount = 1)
+  {
+    if (_prepareMove(false, true)) {
+      _moveCursor<Y_COORD_INDEX>(-amount);
+    }
+  }
+
+  void moveDown(int amount = 1)
+  {
+    if (_prepareMove(false, false)) {
+      _moveCursor<Y_COORD_INDEX>(amount);
+    }
+  }
+
+  void moveLeft(int amount = 1)
+  {
+    if (_prepareMove(true, false)) {
+      _moveCursor<X_COORD_INDEX>(-amount);
+    }
+  }
+
+  void moveRight(int amount = 1)
+  {
+    if (_prepareMove(true, true)) {
+      _moveCursor<X_COORD_INDEX>(amount);
+    }
+  }
+
+private:
+  // a grid page only, the array size is checked by setDisplayedWidgets()
+  using DisplayMenu::setDisplayedLayout;
+  using DisplayMenu::setDisplayedList;
+  using DisplayMenu::setListItemNb;
+  using DisplayMenu::reloadList;
+
+  // Same wrapping as DisplayMenu::_encloseCursor(): out of the grid goes back to 0
+  template <uint8_t DIM>
+  void _moveCursor(int amount)
+  {
+    const uint16_t axisNb = (DIM == X_COORD_INDEX) ? X_NB : Y_NB;
+    uint16_t pos = _cursorPos[DIM] + amount;
+
+    markWidgetDirty(_targetIdx);
+    _cursorPos[DIM] = (pos >= axisNb) ? 0 : pos;
+    _targetIdx = (Y_NB * _cursorPos[X_COORD_INDEX]) + _cursorPos[Y_COORD_INDEX];
+    markWidgetDirty(_targetIdx);
+  }
+};
+
+#endif
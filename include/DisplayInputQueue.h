@@ -0,0 +1,151 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file contains a queue of user navigation events (move, interact).
+//    Events can be pushed from an interrupt or another task while the main loop
+//    renders, the menu then applies them all at once (see
+//    DisplayMenu::processInputs).
+//
+// Implementation:
+//    Lock free ring buffer, for one producer (push) and one consumer (pop) only.
+//    The producer only writes _head and the consumer only writes _tail, with
+//    acquire/release ordering so it is also safe between cores.
+//    When the ring is full, events are counted in per input overflow counters
+//    instead of being dropped, and are applied after the queued events (their
+//    order is lost). Counters
+//    are also written by a single side with native size stores, so no atomic
+//    read-modify-write is needed on small MCUs.
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_INPUT_QUEUE_H
+#define DISPLAY_INPUT_QUEUE_H
+
+#include <stdint.h>
+
+#ifndef DISPLAY_INPUT_QUEUE_SIZE
+#define DISPLAY_INPUT_QUEUE_SIZE (32)   // must be a power of 2, 128 max
+#endif
+
+// Overflow counters must be written with a single store
+#if defined(__AVR__)
+typedef uint8_t DisplayInputCount;
+#else
+typedef uint32_t DisplayInputCount;
+#endif
+
+enum DisplayInput : uint8_t
+{
+  DISPLAY_INPUT_UP = 0,
+  DISPLAY_INPUT_DOWN,
+  DISPLAY_INPUT_LEFT,
+  DISPLAY_INPUT_RIGHT,
+  DISPLAY_INPUT_INTERACT,
+  DISPLAY_INPUT_NONE
+};
+
+class DisplayInputQueue
+{
+  static_assert((DISPLAY_INPUT_QUEUE_SIZE & (DISPLAY_INPUT_QUEUE_SIZE - 1)) == 0,
+                "DISPLAY_INPUT_QUEUE_SIZE must be a power of 2");
+  static_assert(DISPLAY_INPUT_QUEUE_SIZE <= 128, "DISPLAY_INPUT_QUEUE_SIZE must fit the 8 bit indexes");
+
+public:
+  /***************************************************************************/
+  /*!
+      @brief Producer side: add an event, can be called from an ISR
+      @param input event to add, DISPLAY_INPUT_NONE is rejected (it marks the
+      end of the events for pop())
+      @return false if the event went to the overflow counters (ring full),
+      or was rejected
+  */
+  /***************************************************************************/
+  bool push(DisplayInput input)
+  {
+    if (input >= DISPLAY_INPUT_NONE) {
+      return false;
+    }
+    uint8_t head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+    uint8_t tail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+    if ((uint8_t)(head - tail) >= DISPLAY_INPUT_QUEUE_SIZE) {
+      _addOverflow(input);
+      return false;
+    }
+    _events[head & (DISPLAY_INPUT_QUEUE_SIZE - 1)] = input;
+    __atomic_store_n(&_head, (uint8_t)(head + 1), __ATOMIC_RELEASE);
+    return true;
+  }
+
+  /***************************************************************************/
+  /*!
+      @brief Consumer side: take the oldest queued event
+      @return DISPLAY_INPUT_NONE if the ring is empty
+  */
+  /***************************************************************************/
+  DisplayInput pop()
+  {
+    uint8_t tail = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+    uint8_t head = __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+      return DISPLAY_INPUT_NONE;
+    }
+    DisplayInput input = (DisplayInput)_events[tail & (DISPLAY_INPUT_QUEUE_SIZE - 1)];
+    __atomic_store_n(&_tail, (uint8_t)(tail + 1), __ATOMIC_RELEASE);
+    return input;
+  }
+
+  /***************************************************************************/
+  /*!
+      @brief Consumer side: take the events of one kind that did not fit in the
+      ring (up to 255 between two calls on AVR)
+      @param input kind of event
+      @return number of events
+  */
+  /***************************************************************************/
+  DisplayInputCount popOverflow(DisplayInput input)
+  {
+    DisplayInputCount count = __atomic_load_n(&_overflowCount[input], __ATOMIC_ACQUIRE);
+    DisplayInputCount pending = count - _overflowTaken[input];
+    _overflowTaken[input] = count;
+    return pending;
+  }
+
+  bool isEmpty()
+  {
+    if (__atomic_load_n(&_head, __ATOMIC_ACQUIRE) != __atomic_load_n(&_tail, __ATOMIC_RELAXED)) {
+      return false;
+    }
+    for (uint8_t i = 0; i < DISPLAY_INPUT_NONE; i++) {
+      if (__atomic_load_n(&_overflowCount[i], __ATOMIC_ACQUIRE) != _overflowTaken[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  uint8_t _events[DISPLAY_INPUT_QUEUE_SIZE];
+  uint8_t _head = 0;    // written by producer only
+  uint8_t _tail = 0;    // written by consumer only
+  DisplayInputCount _overflowCount[DISPLAY_INPUT_NONE] = {0};   // written by producer only
+  DisplayInputCount _overflowTaken[DISPLAY_INPUT_NONE] = {0};   // written by consumer only
+
+  void _addOverflow(DisplayInput input)
+  {
+    __atomic_store_n(&_overflowCount[input], (DisplayInputCount)(_overflowCount[input] + 1), __ATOMIC_RELEASE);
+  }
+};
+
+#endif
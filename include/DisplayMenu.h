@@ -28,9 +28,40 @@
 #include <string.h>
 #include "Arduino.h"
 #include "DisplayWidget.h"
+#include "DisplayDamage.h"
+#include "DisplayInputQueue.h"
+#include "DisplayNavTable.h"
+#include "DisplayStats.h"
 
 #define MAX_SINGLE_AXIS_NB_WIDGETS (12)
+#define MAX_WIDGETS_NB (MAX_SINGLE_AXIS_NB_WIDGETS * MAX_SINGLE_AXIS_NB_WIDGETS)
 #define X_Y_AXES_NB (2)
+#define X_COORD_INDEX (0)
+#define Y_COORD_INDEX (1)
+
+#define KEY_REPEAT_DELAY_MS (400)   // hold time before a held key repeats
+#define KEY_REPEAT_PERIOD_MS (80)   // time between two repeats of a held key
+
+#define DIRTY_MASK_BYTES_NB ((MAX_WIDGETS_NB + 7) / 8)
+#define DISPLAY_DEADLINE_NEVER (0xFFFFFFFFUL)   // see DisplayMenu::getNextDeadlineMs()
+#define NO_DIRTY_WIDGET (-1)
+
+static_assert(DISPLAY_NAV_MAX_WIDGETS <= MAX_WIDGETS_NB, "layout pages must not have more widgets than the dirty mask");
+
+// Builds the widget of a list item when it enters the viewport of a virtual
+// list (see DisplayMenu::setDisplayedList). viewRow is the row of the viewport
+// it is displayed on, to position the widget.
+typedef DisplayWidget (*DisplayRowProviderFct)(uint32_t itemIdx, uint16_t viewRow, void *ctx);
+typedef void (*DisplayValueEditFct)(DisplayWidget &wdg, void *ctx);
+
+// Items that left and entered the viewport of a virtual list
+struct DisplayListChange
+{
+  uint32_t leftFirst;
+  uint32_t leftNb;
+  uint32_t enteredFirst;
+  uint32_t enteredNb;
+};
 
 class DisplayMenu
 {
@@ -82,6 +113,44 @@ public:
 
   bool isEditingTarget() { return _isEditingTarget; }
 
+  /***************************************************************************/
+  /*!
+      @brief Apply every event waiting in an input queue, typically once per
+      frame. Consecutive moves in the same direction are applied as one move
+      (or edit) with the same result as moving step by step, wrapping past the
+      last widget included. Moves in different directions are never merged.
+      Events that overflowed the queue have lost their order: they are applied
+      after the queued ones, one run per direction (up, down, left, right),
+      then the interactions.
+      @param queue events pushed by button ISRs or an input task
+      @return number of events taken from the queue
+  */
+  /***************************************************************************/
+  uint32_t processInputs(DisplayInputQueue &queue);
+
+  /***************************************************************************/
+  /*!
+      @brief Auto repeat for held keys. Call at every loop with the key that is
+      currently held, DISPLAY_INPUT_NONE once released. A newly pressed key acts
+      right away, then repeats every KEY_REPEAT_PERIOD_MS once held for
+      KEY_REPEAT_DELAY_MS. When editing, repeats speed up following the edit
+      ramp of the widget (see DisplayWidget::setEditRamp). Interact does not repeat.
+      @param key key held by the user
+  */
+  /***************************************************************************/
+  void holdKey(DisplayInput key);
+
+  /***************************************************************************/
+  /*!
+      @brief Set a function called each time the menu edits the value of a
+      widget (edit keys, held or queued), i.e. to save a setting or to tell
+      another menu showing the same value (see DisplayMenuGroup)
+      @param fct called with the edited widget, NULL for none
+      @param ctx passed to fct
+  */
+  /***************************************************************************/
+  void setValueEditFct(DisplayValueEditFct fct, void *ctx = NULL) { _valueEditFct = fct; _valueEditCtx = ctx; }
+
   /***************************************************************************/
   /*!
       @brief Set the flag that tell the menu object that something changed
@@ -89,26 +158,138 @@ public:
       @param none
   */
   /***************************************************************************/
-  void flagChange() { _isChanged = true; }
+  void flagChange() { _isChanged = true; markAllWidgetsDirty(); }
+
+  /***************************************************************************/
+  /*!
+      @brief Same as flagChange(), but only the given widget is marked as needing
+      a reprint (i.e. the value bound to it changed outside of user navigation)
+      @param widgetIdx index of the widget in the current widget list
+  */
+  /***************************************************************************/
+  void flagWidgetChange(uint16_t widgetIdx) { _isChanged = true; markWidgetDirty(widgetIdx); }
 
   /***************************************************************************/
   /*!
       @brief Check if something changed (user input, data change, ...) and menu 
-      needs to reprint
+      needs to reprint, also true while widgets deferred by the frame budget
+      wait for their print (see setFrameSchedule)
       @param none
   */
   /***************************************************************************/
   bool isChanged();
 
+  /***************************************************************************/
+  /*!
+      @brief Render at a bounded rate: changes are accumulated between frames
+      and isFrameDue() tells when to render them.
+      @param periodMs minimum time between two frames, 0 to render as soon as
+        something changed
+      @param budgetUs time given to a dirty print, 0 for no limit. With a
+        budget, widgets are printed before low priority ones (see
+        DisplayWidget::setLowPriority), and once the budget is spent
+        nextDirtyPrint() stops before the next low priority widget: it stays
+        dirty for the next frame. At least one low priority widget is printed
+        per frame, so none waits forever.
+  */
+  /***************************************************************************/
+  void setFrameSchedule(uint16_t periodMs, uint32_t budgetUs = 0);
+
+  /***************************************************************************/
+  /*!
+      @brief Replaces isChanged() in the loop when a frame schedule is set
+      @return true if something changed or was deferred, and the frame period
+      elapsed since the last frame
+  */
+  /***************************************************************************/
+  bool isFrameDue();
+  bool hasDeferredWidgets() { return _hasDeferredWidgets; }
+
+  /***************************************************************************/
+  /*!
+      @brief Time until the menu needs the loop again: next repeat of a held
+      key, or next frame when something is waiting to be printed (dirty or
+      deferred widgets, isChanged()). The application can sleep that long, or
+      until the next input event.
+      @return delay in ms, 0 if it is already due, DISPLAY_DEADLINE_NEVER if
+      the menu is idle
+  */
+  /***************************************************************************/
+  uint32_t getNextDeadlineMs();
+
   /***************************************************************************/
   /*!
       @brief Resets a counter that counts which widget we are currently printing
-      when printing a menu page. must call nextPrint() between each subsequent
+      when printing a menu page. must call nextPrint() after each printed
+      widget, the call after the last one ends the frame (see getStats())
+      @param none
+  */
+  /***************************************************************************/
+  void startPrint() { DISPLAY_STATS(_startFrameStats(getWidgetNb())); _currWdgToPrint = 0; _hasDeferredWidgets = false; clearDirtyWidgets(); }
+  void nextPrint()
+  {
+    if (_currWdgToPrint < getWidgetNb()) {
+      _currWdgToPrint++;
+      DISPLAY_STATS(if (_currWdgToPrint == getWidgetNb()) { _endFrameStats(false); })
+    }
+  }
+
+  /***************************************************************************/
+  /*!
+      @brief Partial reprint: place the print counter on the first widget that
+      needs a reprint. getPrintColor(), getPrintX() and getPrintY() then refer to
+      that widget. Call nextDirtyPrint() once it is printed.
+      @return false if no widget needs to be reprinted
+  */
+  /***************************************************************************/
+  bool startDirtyPrint();
+
+  /***************************************************************************/
+  /*!
+      @brief Mark the widget currently printed as clean and move the print
+      counter to the next widget that needs a reprint.
+      @return false once every dirty widget was printed
+  */
+  /***************************************************************************/
+  bool nextDirtyPrint();
+
+  uint16_t getPrintWidgetIdx() { return _currWdgToPrint; }
+
+  /***************************************************************************/
+  /*!
+      @brief Iterate over the widgets that need a reprint, without clearing them.
+      @param fromIdx first widget index to look at
+      @return index of the first dirty widget at or after fromIdx, or
+      NO_DIRTY_WIDGET if there is none.
+  */
+  /***************************************************************************/
+  int16_t nextDirtyWidget(uint16_t fromIdx = 0);
+
+  bool isWidgetDirty(uint16_t widgetIdx);
+  void markWidgetDirty(uint16_t widgetIdx);
+  void markAllWidgetsDirty();
+  void clearDirtyWidgets() { memset(_dirtyWidgets, 0, sizeof(_dirtyWidgets)); }
+
+  /***************************************************************************/
+  /*!
+      @brief Get the screen areas covered by the widgets marked dirty since the
+      last clearDamage(). Only widgets with a size (see DisplayWidget::setSize)
+      are accounted for. The rectangles never overlap, adjacent areas are
+      merged when it does not grow them, the list holds at most
+      MAX_DAMAGE_RECTS_NB rectangles.
       @param none
   */
   /***************************************************************************/
-  void startPrint() { _currWdgToPrint = 0; }
-  void nextPrint() { if (_currWdgToPrint < getWidgetNb()) {_currWdgToPrint++; } }
+  const DisplayDamage &getDamage() { return _damage; }
+  void addDamage(int16_t x, int16_t y, uint16_t w, uint16_t h) { _damage.add(x, y, w, h); }
+  void clearDamage()
+  {
+    DISPLAY_STATS(_endFrameStats(true));
+    _damage.clear();
+    if (_hasDeferredWidgets) {
+      _addDirtyDamage();
+    }
+  }
   
   /***************************************************************************/
   /*!
@@ -124,10 +305,36 @@ public:
   uint16_t getTargetWidgetColor();
   uint16_t getWidgetColor(uint16_t widgetIdx);
   uint16_t getBackgroundColor() {return _backgroundColor; }
+  uint16_t getIdleColor() { return _idleColor; }
+  uint16_t getTargetColor() { return _targetColor; }
+  uint16_t getEditingColor() { return _editingColor; }
 
   uint16_t getWidgetNb() { return (_mapDimensions[0] * _mapDimensions[1]); }
+  DisplayWidget *getWidget(uint16_t widgetIdx) { return ((_menuWidgets != NULL) && (widgetIdx < getWidgetNb())) ? &_menuWidgets[widgetIdx] : NULL; }
   uint16_t getTargetWidgetIdx() { return _targetIdx; }
 
+  /***************************************************************************/
+  /*!
+      @brief Counts the changes of the widgets behind the widget indexes: a new
+      page (setDisplayedWidgets(), layout, list) or a list scroll. A widget
+      index or pointer kept with the same count still names the same widget.
+  */
+  /***************************************************************************/
+  uint16_t getPageChangeNb() { return _pageChangeNb; }
+  uint16_t getCursorX() { return _cursorPos[X_COORD_INDEX]; }
+  uint16_t getCursorY() { return _cursorPos[Y_COORD_INDEX]; }
+
+  /***************************************************************************/
+  /*!
+      @brief Place the cursor on a widget of the current page, i.e. to restore
+      the position the user had on a page. Out of the page goes back to 0, as
+      with the move functions.
+      @param xPos column of the widget
+      @param yPos row of the widget
+  */
+  /***************************************************************************/
+  void setCursor(uint16_t xPos, uint16_t yPos);
+
   // need fct that calls a void ptr, check what type of widget, and either edits or activates it.
   // pass an argument of which direction is pressed, could set custom codes for each, and call that
   // fct inside the UI callback from button presses
@@ -143,6 +350,92 @@ public:
   /***************************************************************************/
   void setDisplayedWidgets(DisplayWidget *wdgList, uint16_t yNbWdg, uint16_t xNbWdg = 1);
 
+  /***************************************************************************/
+  /*!
+      @brief Set the widgets of a page that is not a regular grid. Moves follow
+      the navigation table instead of the grid, keys with no neighbor in their
+      direction do not move the cursor.
+      @param wdgList Pointer to the array of widgets for current page
+      @param wdgNb number of widgets
+      @param navTable wdgNb entries, from DisplayNavTable::build() or generated
+      beforehand
+      @param isProgmem true if navTable is stored with PROGMEM (AVR)
+      @return false if wdgNb is over DISPLAY_NAV_MAX_WIDGETS, the page is not
+      changed
+  */
+  /***************************************************************************/
+  bool setDisplayedLayout(DisplayWidget *wdgList, uint16_t wdgNb, const DisplayNavEntry *navTable,
+                          bool isProgmem = false);
+
+  /***************************************************************************/
+  /*!
+      @brief Virtual list: display a single column list of any number of items,
+      only the rows of the viewport exist as widgets. Moving the cursor past the
+      viewport scrolls it, the row provider is called for the items that enter
+      it only. The target widget index is its row in the viewport.
+      @param viewRows storage for the widgets of the viewport rows
+      @param viewRowNb number of rows displayed at once (MAX_WIDGETS_NB max)
+      @param itemNb number of items in the list
+      @param rowProvider builds the widget of an item
+      @param ctx passed to rowProvider
+  */
+  /***************************************************************************/
+  void setDisplayedList(DisplayWidgetSlot *viewRows, uint16_t viewRowNb, uint32_t itemNb,
+                        DisplayRowProviderFct rowProvider, void *ctx = NULL);
+
+  /***************************************************************************/
+  /*!
+      @brief Change the number of items of the virtual list (i.e. a log that
+      grows), the targeted item is kept if it still exists. The viewport rows are
+      built again.
+  */
+  /***************************************************************************/
+  void setListItemNb(uint32_t itemNb);
+  void reloadList() { setListItemNb(_listItemNb); }
+
+  bool isListDisplayed() { return _rowProvider != NULL; }
+  uint32_t getListItemNb() { return _listItemNb; }
+  uint32_t getListFirstItem() { return _listFirstItem; }
+  uint32_t getTargetItem() { return (_rowProvider != NULL) ? _listFirstItem + _cursorPos[Y_COORD_INDEX] : _targetIdx; }
+
+  /***************************************************************************/
+  /*!
+      @brief Items that left and entered the viewport since the last
+      ackListChange(), i.e. to scroll the screen in hardware and only draw the
+      entered rows.
+      @param change filled with the left and entered item ranges
+      @return false if the viewport did not move
+  */
+  /***************************************************************************/
+  bool getListChange(DisplayListChange &change);
+  void ackListChange() { _listAckFirstItem = _listFirstItem; }
+
+  /***************************************************************************/
+  /*!
+      @brief Render statistics since the last resetStats(), zeros unless built
+      with DISPLAY_MENU_STATS (see DisplayStats.h). A frame goes from
+      startPrint() or startDirtyPrint() to the end of the printing (nextPrint()
+      past the last widget, nextDirtyPrint() returning false). A clearDamage()
+      after it, as DisplayRenderer does after its flush, extends the frame time
+      up to that call.
+  */
+  /***************************************************************************/
+  const DisplayRenderStats &getStats();
+  void resetStats();
+
+  /***************************************************************************/
+  /*!
+      @brief For renderers: count pixels sent to the display in the stats
+      @param bytesPerPixel 2 for RGB565
+  */
+  /***************************************************************************/
+  void addPushedPixels(uint32_t pixelNb, uint8_t bytesPerPixel = 2)
+  {
+    DISPLAY_STATS(_stats.pushedPixelNb += pixelNb; _stats.pushedByteNb += pixelNb * bytesPerPixel;)
+    (void)pixelNb;
+    (void)bytesPerPixel;
+  }
+
   /***************************************************************************/
   /*!
       @brief Set if user edits widgets values from side arrows rather than up
@@ -152,7 +445,7 @@ public:
   /***************************************************************************/
   void setEditFromSides(bool sidesEdit) { _editsFromSides = sidesEdit; }
 
-private:
+protected:
 
   class _widgetPrinter {
     private:
@@ -168,28 +461,107 @@ private:
 
   uint16_t _mapDimensions[X_Y_AXES_NB] = {0, 0}; 
 
-  uint16_t _targetIdx;
+  uint16_t _targetIdx = 0;
   bool _isChanged = false;      // marks when something changed on the menu and it needs refresh
+  // held key auto repeat
+  DisplayInput _heldKey = DISPLAY_INPUT_NONE;
+  unsigned long _holdStartMs = 0;
+  unsigned long _nextRepeatMs = 0;
+
+  uint8_t _dirtyWidgets[DIRTY_MASK_BYTES_NB] = {0};  // one bit per widget that needs a reprint
+  DisplayDamage _damage;        // screen areas of the widgets marked dirty
 
   DisplayWidget *_menuWidgets = NULL;  // pointer to array of widgets for current menu
-  bool _isEditingTarget;
+  uint16_t _pageChangeNb = 0;          // see getPageChangeNb()
+
+  // irregular layout, moves follow the table
+  const DisplayNavEntry *_navTable = NULL;
+  bool _isNavTableProgmem = false;
+
+  // virtual list, the widgets are the viewport rows
+  DisplayRowProviderFct _rowProvider = NULL;
+  void *_rowProviderCtx = NULL;
+  DisplayWidgetSlot *_listRows = NULL;
+  uint16_t _listViewRowNb = 0;
+  uint32_t _listItemNb = 0;
+  uint32_t _listFirstItem = 0;      // item displayed on the first viewport row
+  uint32_t _listAckFirstItem = 0;   // first item at the last ackListChange()
+  bool _isEditingTarget = false;
+  DisplayValueEditFct _valueEditFct = NULL;
+  void *_valueEditCtx = NULL;
 
   // usage settings
-  bool _editsFromSides;         // left and right buttons edit selected widget instead of up and down buttons
+  bool _editsFromSides = false;         // left and right buttons edit selected widget instead of up and down buttons
 
   // printing widgets
   // class widgetPrinter with curr target (private), nb of widgets, colors, gettarget which is enclosed, 
   uint16_t _currWdgToPrint = 0;   // default printing target for fcts that take a widget as argument
 
-  int16_t _idleColor;
-  int16_t _targetColor;
-  int16_t _editingColor;
-  int16_t _backgroundColor;
+  // frame schedule
+  uint16_t _framePeriodMs = 0;
+  uint32_t _frameBudgetUs = 0;
+  unsigned long _nextFrameMs = 0;
+  unsigned long _printStartUs = 0;
+  bool _isPrintingLowPriority = false;
+  bool _hasPrintedLowPriority = false;
+  bool _hasDeferredWidgets = false;
+
+  int16_t _nextScheduledWidget(uint16_t fromIdx);
+  void _addDirtyDamage();
+
+#if DISPLAY_MENU_STATS
+  DisplayRenderStats _stats = {};
+  unsigned long _frameStartUs = 0;
+  uint16_t _frameRedrawnNb = 0;
+  uint16_t _frameWidgetNb = 0;
+  bool _isInFrame = false;
+  bool _isFrameTimed = false;   // frame counted, its time still extended by clearDamage()
+
+  void _startFrameStats(uint16_t redrawnNb);
+  void _endFrameStats(bool isFlushed);
+#endif
+
+  int16_t _idleColor = 0;
+  int16_t _targetColor = 0;
+  int16_t _editingColor = 0;
+  int16_t _backgroundColor = 0;
 
   void _moveCursor(uint8_t dim, int amount);
   void _encloseCursor();
   void _updateTarget();
 
+  /***************************************************************************/
+  /*!
+      @brief Common part of the move functions: edits the target if it is in
+      edit mode and the key is an edit key (see setEditFromSides).
+      @param isSideKey true for left/right keys, false for up/down keys
+      @param isIncrease true for up/right keys
+      @param editSteps number of increments/decrements to apply when editing
+      @param editMultiplier increment sizes applied by each step
+      @return true if the cursor must be moved
+  */
+  /***************************************************************************/
+  bool _prepareMove(bool isSideKey, bool isIncrease, uint16_t editSteps = 1, uint16_t editMultiplier = 1);
+
+  /***************************************************************************/
+  /*!
+      @brief Apply a single key press, moving by one widget or editing by
+      editMultiplier increment sizes
+  */
+  /***************************************************************************/
+  void _applyKey(DisplayInput key, uint16_t editMultiplier);
+
+  /***************************************************************************/
+  /*!
+      @brief Apply a run of identical moves, with the same result as applying
+      them one by one
+      @param input direction of the moves
+      @param steps number of moves
+      @return false if the run is empty
+  */
+  /***************************************************************************/
+  bool _applyMoveRun(DisplayInput input, uint32_t steps);
+
     /***************************************************************************/
   /*!
       @brief For editable widgets: Set the flag that tell the menu object 
@@ -198,12 +570,19 @@ private:
       @param none
   */
   /***************************************************************************/
-  void _startEditingTarget() { _isEditingTarget = true; }
-  void _stopEditingTarget() { _isEditingTarget = false; }
+  void _startEditingTarget() { _isEditingTarget = true; markWidgetDirty(_targetIdx); }
+  void _stopEditingTarget() { _isEditingTarget = false; markWidgetDirty(_targetIdx); }
 
 
 
   void _updateMapDimensions(int x_count, int y_count);
+  void _moveNavCursor(uint8_t dim, int amount);
+  void _moveListCursor(int amount);
+  void _scrollList(uint32_t firstItem);
+  void _loadListRow(uint16_t viewRow);
+  void _moveListRow(uint16_t fromRow, uint16_t toRow);
+  uint16_t _getDirtyTrackedNb();
+  void _addWidgetDamage(uint16_t widgetIdx);
 };
 
 #endif
@@ -0,0 +1,147 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file contains a group of menus shown on different displays (i.e. a
+//    main TFT and a status OLED), each rendered by its own task. Inputs go to
+//    the menu that has the focus, and values shown by several menus are
+//    reprinted on every display when one of them, or the application, changes
+//    them.
+//
+//        input task / ISR:   group.push(DISPLAY_INPUT_DOWN);
+//        display task N:     group.processInputs(N);
+//                            renderer.printDirty(*group.getMenu(N));
+//
+// Implementation:
+//    Each menu has its own input queue, filled by the input side and emptied by
+//    the menu task, so a display task never waits for another one. Only the
+//    menu task touches its menu: changes of shared values are posted as one
+//    flag byte per menu and value, set with a single store by any task and
+//    taken by the menu task, which then marks the widgets bound to the value.
+//    A value is edited by one task at a time (only the focused menu edits, the
+//    application only changes the values no menu edits). Bound values are read
+//    and written in one access each (see DisplayValue.h), so the
+//    application changes a shared value with displayValueStore(); the release
+//    store of the flag orders the new value before the reprint.
+//    Menus, queues and shared values are added before the tasks start.
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_MENU_GROUP_H
+#define DISPLAY_MENU_GROUP_H
+
+#include <stdint.h>
+#include "DisplayMenu.h"
+#include "DisplayInputQueue.h"
+
+#ifndef DISPLAY_GROUP_MAX_MENUS
+#define DISPLAY_GROUP_MAX_MENUS (4)
+#endif
+#ifndef DISPLAY_GROUP_MAX_SHARED_VALUES
+#define DISPLAY_GROUP_MAX_SHARED_VALUES (16)
+#endif
+#define DISPLAY_GROUP_NO_MENU (-1)
+
+class DisplayMenuGroup
+{
+public:
+  /***************************************************************************/
+  /*!
+      @brief Setup: add a menu, the first one added has the focus. The group
+      sets the value edit function of the menu (see DisplayMenu::setValueEditFct).
+      @param menu  menu of one display
+      @param queue inputs of this menu, only used through the group
+      @return index of the menu in the group, DISPLAY_GROUP_NO_MENU if full
+  */
+  /***************************************************************************/
+  int8_t addMenu(DisplayMenu &menu, DisplayInputQueue &queue);
+
+  /***************************************************************************/
+  /*!
+      @brief Setup: declare a variable shown by several menus. Widgets bound to
+      it are reprinted on every menu when it changes.
+      @param value bound variable (DisplayValueRange value, or int of a value widget)
+      @return false if there are already DISPLAY_GROUP_MAX_SHARED_VALUES values
+  */
+  /***************************************************************************/
+  bool addSharedValue(const void *value);
+
+  /***************************************************************************/
+  /*!
+      @brief Input side: add an event to the queue of the focused menu. Single
+      producer, like DisplayInputQueue::push, can be called from an ISR.
+      @return false if the event went to the overflow counters
+  */
+  /***************************************************************************/
+  bool push(DisplayInput input);
+
+  /***************************************************************************/
+  /*!
+      @brief Send the next inputs to another menu, from any task. Events
+      already queued stay with the menu they were sent to.
+  */
+  /***************************************************************************/
+  void setFocus(uint8_t menuIdx);
+  uint8_t getFocus() { return __atomic_load_n(&_focusIdx, __ATOMIC_ACQUIRE); }
+  bool isFocused(uint8_t menuIdx) { return getFocus() == menuIdx; }
+
+  /***************************************************************************/
+  /*!
+      @brief Tell the menus that a shared value changed, from any task. Called
+      by the group for edits made through a menu, by the application for
+      others (sensor, ...) after writing the value.
+      @param value shared value, ignored if it was not added
+  */
+  /***************************************************************************/
+  void notifyValueChange(const void *value);
+
+  /***************************************************************************/
+  /*!
+      @brief Menu task: mark the widgets bound to shared values changed since
+      the last call
+      @return number of widgets marked
+  */
+  /***************************************************************************/
+  uint16_t syncValues(uint8_t menuIdx);
+
+  /***************************************************************************/
+  /*!
+      @brief Menu task: sync the shared values, then apply the inputs queued
+      for the menu (see DisplayMenu::processInputs), once per frame
+      @return number of events taken from the queue
+  */
+  /***************************************************************************/
+  uint32_t processInputs(uint8_t menuIdx);
+
+  uint8_t getMenuNb() { return _menuNb; }
+  DisplayMenu *getMenu(uint8_t menuIdx) { return (menuIdx < _menuNb) ? _members[menuIdx].menu : NULL; }
+
+private:
+  struct _Member
+  {
+    DisplayMenu *menu;
+    DisplayInputQueue *queue;
+  };
+
+  _Member _members[DISPLAY_GROUP_MAX_MENUS];
+  uint8_t _menuNb = 0;
+  uint8_t _focusIdx = 0;
+  const void *_sharedValues[DISPLAY_GROUP_MAX_SHARED_VALUES];
+  uint8_t _sharedValueNb = 0;
+  uint8_t _changedValues[DISPLAY_GROUP_MAX_MENUS][DISPLAY_GROUP_MAX_SHARED_VALUES] = {{0}};   // set by any task, taken by the menu task
+
+  static void _onValueEdit(DisplayWidget &wdg, void *ctx);
+};
+
+#endif
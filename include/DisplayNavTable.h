@@ -0,0 +1,87 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file contains the navigation table of pages whose widgets are not
+//    laid out on a regular grid (widgets of different sizes, gaps, ...).
+//    For each widget, the table gives the widget reached with each move key,
+//    so a move is a single lookup (see DisplayMenu::setDisplayedLayout).
+//
+// Implementation:
+//    The table is computed from the widget positions and sizes: the neighbor
+//    in a direction is the closest widget center within a 90 degrees cone
+//    around that direction, widgets facing the current one (overlapping it
+//    across the move) being preferred. It can be built once at run time, or
+//    generated beforehand and kept in flash.
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_NAV_TABLE_H
+#define DISPLAY_NAV_TABLE_H
+
+#include <stdint.h>
+#include "DisplayWidget.h"
+#include "DisplayInputQueue.h"
+
+#define DISPLAY_NAV_DIR_NB (4)        // DISPLAY_INPUT_UP to DISPLAY_INPUT_RIGHT
+// Indexes are 8 bits, and the menu tracks the redraw of MAX_WIDGETS_NB widgets
+// (DisplayMenu.h, checked there)
+#define DISPLAY_NAV_MAX_WIDGETS (144)
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define DISPLAY_NAV_READ_PROGMEM(addr) pgm_read_byte(addr)
+#else
+#define DISPLAY_NAV_READ_PROGMEM(addr) (*(const uint8_t *)(addr))
+#endif
+
+// Widget index reached from a widget with each move key, indexed by DisplayInput.
+// A widget with no neighbor in a direction points to itself.
+struct DisplayNavEntry
+{
+  uint8_t neighbor[DISPLAY_NAV_DIR_NB];
+};
+
+class DisplayNavTable
+{
+public:
+  /***************************************************************************/
+  /*!
+      @brief Compute the neighbors of every widget from their positions and
+      sizes (see DisplayWidget::setPosition and setSize).
+      @param wdgList widgets of the page
+      @param wdgNb number of widgets, DISPLAY_NAV_MAX_WIDGETS max
+      @param table wdgNb entries, filled by the function
+      @return false if there are too many widgets
+  */
+  /***************************************************************************/
+  static bool build(DisplayWidget *wdgList, uint16_t wdgNb, DisplayNavEntry *table);
+
+  /***************************************************************************/
+  /*!
+      @brief Get a neighbor from a table in RAM or in flash (PROGMEM on AVR)
+  */
+  /***************************************************************************/
+  static uint8_t getNeighbor(const DisplayNavEntry *table, bool isProgmem, uint16_t wdgIdx, DisplayInput dir)
+  {
+    const uint8_t *entry = &table[wdgIdx].neighbor[dir];
+    return isProgmem ? DISPLAY_NAV_READ_PROGMEM(entry) : *entry;
+  }
+
+private:
+  static void _measure(DisplayWidget &from, DisplayWidget &to, bool isVertical, int32_t &along, int32_t &across,
+                       bool &inBeam);
+};
+
+#endif
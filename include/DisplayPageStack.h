@@ -0,0 +1,144 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file contains a navigation stack for menus organized as a tree of
+//    pages. Opening a sub page pushes it, going back pops it and puts the
+//    cursor back where it was on the parent page.
+//    A page either points to a static widget array, or has a build function
+//    that creates its widgets when the page is opened. Built widgets only live
+//    while the page is on the stack, so RAM is only needed for the pages of the
+//    current path, not for every page of the tree.
+//
+// Implementation:
+//    Built widgets are copied in slots provided by the user and used as a stack:
+//    a page takes the slots after its parent's ones and gives them back when
+//    popped. No heap. Pages descriptions can be const.
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_PAGE_STACK_H
+#define DISPLAY_PAGE_STACK_H
+
+#include <stdint.h>
+#include "DisplayMenu.h"
+
+#ifndef MAX_PAGE_DEPTH
+#define MAX_PAGE_DEPTH (8)
+#endif
+
+class DisplayPageStack;
+
+typedef void (*DisplayPageBuildFct)(DisplayPageStack &pages);
+typedef void (*DisplayPageReleaseFct)();
+
+struct DisplayPage
+{
+  DisplayPageBuildFct build;      // adds the widgets when the page is opened, NULL for a static page
+  DisplayPageReleaseFct release;  // called when the page is popped, can be NULL
+  DisplayWidget *widgets;         // static page widgets, unused when build is set
+  uint16_t yNbWdg;
+  uint16_t xNbWdg;
+};
+
+class DisplayPageStack
+{
+public:
+  /***************************************************************************/
+  /*!
+      @brief Ctor
+      @param menu menu displaying the page on top of the stack
+      @param slots storage shared by the built pages of the current path
+      @param slotNb number of slots, at least the widgets of the largest path
+  */
+  /***************************************************************************/
+  DisplayPageStack(DisplayMenu &menu, DisplayWidgetSlot *slots, uint16_t slotNb)
+      : _menu(menu), _slots(slots), _slotNb(slotNb) {}
+
+  /***************************************************************************/
+  /*!
+      @brief Open a page on top of the current one, its build function is called
+      (if any) and the menu displays it with the cursor on the first widget.
+      @param page page to open, must outlive its time on the stack
+      @return false if the stack is full, the page has no widget or its widgets
+      do not fit in the remaining slots. The current page is kept.
+  */
+  /***************************************************************************/
+  bool push(const DisplayPage &page);
+
+  /***************************************************************************/
+  /*!
+      @brief Go back to the parent page, with the cursor where it was when the
+      page was pushed. The slots of a built page are freed after its release
+      function is called. Can be called from a widget of the popped page.
+      @return false on the root page, which is never popped
+  */
+  /***************************************************************************/
+  bool pop();
+
+  /***************************************************************************/
+  /*!
+      @brief Pop every page above the root page
+  */
+  /***************************************************************************/
+  void popToRoot() { while (pop()) {} }
+
+  /***************************************************************************/
+  /*!
+      @brief From a build function: add a widget to the page being built.
+      @param wdg widget copied in the next free slot
+      @return false if there is no slot left, the push will then fail
+  */
+  /***************************************************************************/
+  bool addWidget(const DisplayWidget &wdg);
+
+  /***************************************************************************/
+  /*!
+      @brief From a build function: layout of the built widgets, a single column
+      of every added widget if not called.
+  */
+  /***************************************************************************/
+  void setGrid(uint16_t yNbWdg, uint16_t xNbWdg = 1) { _buildYNb = yNbWdg; _buildXNb = xNbWdg; }
+
+  uint8_t getDepth() { return _depth; }
+  uint16_t getUsedSlotNb() { return _usedSlotNb; }
+  const DisplayPage *getCurrentPage() { return (_depth > 0) ? _levels[_depth - 1].page : NULL; }
+
+private:
+  struct _Level
+  {
+    const DisplayPage *page;
+    DisplayWidget *widgets;
+    uint16_t firstSlot;
+    uint16_t yNbWdg;
+    uint16_t xNbWdg;
+    uint16_t cursorX;   // saved when a child page is pushed
+    uint16_t cursorY;
+  };
+
+  DisplayMenu &_menu;
+  DisplayWidgetSlot *_slots;
+  uint16_t _slotNb;
+  uint16_t _usedSlotNb = 0;
+  _Level _levels[MAX_PAGE_DEPTH];
+  uint8_t _depth = 0;
+
+  // page being built
+  bool _buildFailed = false;
+  uint16_t _buildNb = 0;
+  uint16_t _buildYNb = 0;
+  uint16_t _buildXNb = 0;
+};
+
+#endif
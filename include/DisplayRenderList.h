@@ -0,0 +1,174 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file contains a retained mode layer for drawing menu pages. Instead of
+//    drawing right away, the page is recorded as a list of draw commands (text,
+//    rect, fill, bitmap) every frame. commit() compares the list with the one of
+//    the previous frame and only sends the commands that changed, plus what they
+//    overlap, to a user draw function. Static labels and frames cost nothing on
+//    frames where they do not change.
+//
+// Implementation:
+//    Two fixed size command lists (current and previous frame), no allocation.
+//    Commands are matched between frames by key: a group (i.e. the widget index,
+//    see setGroup()) and their order in the group. The areas of the changed
+//    commands, before and after the change, are erased with the background color
+//    and every command that overlaps them is drawn again, in order. Fills and
+//    outlines are clipped to these areas (sent as fills), so a full screen
+//    background or frame does not make the whole page redraw. Texts are
+//    compared by content (hash), so a text buffer reused every frame is handled.
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_RENDER_LIST_H
+#define DISPLAY_RENDER_LIST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "DisplayBitmap.h"
+#include "DisplayDamage.h"
+
+#ifndef RENDER_LIST_MAX_CMDS
+#define RENDER_LIST_MAX_CMDS (48)
+#endif
+
+// Text area when none is given, the classic font cell of the backends
+#ifndef RENDER_LIST_CHAR_WIDTH
+#define RENDER_LIST_CHAR_WIDTH (6)
+#endif
+#ifndef RENDER_LIST_CHAR_HEIGHT
+#define RENDER_LIST_CHAR_HEIGHT (8)
+#endif
+
+enum DisplayCmdType : uint8_t
+{
+  DISPLAY_CMD_FILL_RECT = 0,
+  DISPLAY_CMD_RECT,       // outline
+  DISPLAY_CMD_TEXT,
+  DISPLAY_CMD_BITMAP
+};
+
+struct DisplayCmd
+{
+  const void *data;   // char string for texts, DisplayBitmap for bitmaps
+  uint32_t dataHash;  // text contents, compared instead of the (maybe reused) buffer
+  uint16_t key;
+  int16_t x;
+  int16_t y;
+  uint16_t w;         // texts: area covered by the text, to erase it when it changes
+  uint16_t h;
+  uint16_t color;
+  uint16_t bgColor;
+  uint8_t type;
+  uint8_t textSize;
+
+  const char *getText() const { return (const char *)data; }
+  const DisplayBitmap *getBitmap() const { return (const DisplayBitmap *)data; }
+  DisplayRect getRect() const { DisplayRect r = {x, y, w, h}; return r; }
+};
+
+/***************************************************************************/
+/*!
+    @brief Function called by commit() for every command to draw
+    @param cmd command, x/y/w/h are the area to draw for fills
+    @param ctx user pointer given to commit()
+*/
+/***************************************************************************/
+typedef void (*DisplayCmdDrawFct)(const DisplayCmd &cmd, void *ctx);
+
+class DisplayRenderList
+{
+public:
+  DisplayRenderList() {}
+
+  /***************************************************************************/
+  /*!
+      @brief Start recording a frame, the previous frame is kept for comparison
+  */
+  /***************************************************************************/
+  void begin();
+
+  /***************************************************************************/
+  /*!
+      @brief Following commands belong to a group, i.e. a widget. Commands are
+      matched with the previous frame by group and order in the group, so a
+      widget drawing more or fewer commands does not affect the others.
+      @param group 0 to 255
+  */
+  /***************************************************************************/
+  void setGroup(uint8_t group) { _group = group; _groupCmdNb = 0; }
+
+  /***************************************************************************/
+  /*!
+      @brief Record draw commands. Texts and bitmaps must stay valid until
+      commit(). The area of a text (w, h) is erased when it changes: without
+      one, it is computed from the text length and size with the classic font
+      cell (RENDER_LIST_CHAR_WIDTH x RENDER_LIST_CHAR_HEIGHT). Give it for other
+      fonts, or to erase a fixed field.
+      @return false if the list is full, the command is dropped
+  */
+  /***************************************************************************/
+  bool fillRect(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t color);
+  bool drawRect(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t color);
+  bool drawText(int16_t x, int16_t y, const char *text, uint16_t color, uint16_t bgColor, uint8_t textSize = 1,
+                uint16_t w = 0, uint16_t h = 0);
+  bool drawBitmap(int16_t x, int16_t y, const DisplayBitmap *bmp, uint16_t color, uint16_t bgColor);
+
+  /***************************************************************************/
+  /*!
+      @brief Send what changed since the previous frame to the display.
+      @param drawFct called for each command to draw
+      @param ctx passed to drawFct
+      @return number of commands sent
+  */
+  /***************************************************************************/
+  uint16_t commit(DisplayCmdDrawFct drawFct, void *ctx = NULL);
+
+  /***************************************************************************/
+  /*!
+      @brief Next commit() draws every command, i.e. after the screen was
+      cleared outside of the render list.
+  */
+  /***************************************************************************/
+  void invalidate() { _isFullRedraw = true; }
+
+  void setBackgroundColor(uint16_t color) { _bgColor = color; }
+  uint16_t getCmdNb() { return _cmdNb[_frame]; }
+  bool hasOverflowed() { return _hasOverflowed; }
+
+private:
+  DisplayCmd _cmds[2][RENDER_LIST_MAX_CMDS];
+  uint16_t _cmdNb[2] = {0, 0};
+  uint8_t _frame = 0;           // list being recorded, the other one is the previous frame
+  uint8_t _redraw[(RENDER_LIST_MAX_CMDS + 7) / 8];
+  bool _isFullRedraw = true;
+  bool _hasOverflowed = false;
+  uint8_t _group = 0;
+  uint8_t _groupCmdNb = 0;
+  uint16_t _bgColor = 0;
+
+  DisplayCmd *_add(DisplayCmdType type, int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t color);
+  int16_t _findPrevious(uint16_t key, uint16_t hint);
+  static uint8_t _getParts(const DisplayCmd &cmd, DisplayRect *parts);
+  static void _addDamage(DisplayDamage &damage, const DisplayCmd &cmd);
+  static bool _overlaps(const DisplayDamage &damage, const DisplayCmd &cmd);
+  static bool _isSame(const DisplayCmd &a, const DisplayCmd &b);
+  static uint32_t _hashText(const char *text);
+  bool _isMarked(uint16_t idx) { return (_redraw[idx >> 3] & (1 << (idx & 7))) != 0; }
+  void _mark(uint16_t idx) { _redraw[idx >> 3] |= (1 << (idx & 7)); }
+};
+
+#endif
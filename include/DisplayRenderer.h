@@ -0,0 +1,287 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file contains a menu renderer, the drawing code every application
+//    used to write itself: widgets are drawn as a frame in their state color
+//    with their value inside, the whole page or only the widgets that changed.
+//    It also sends DisplayRenderList commands and DisplayFramebuffer tiles to
+//    the display.
+//
+// Implementation:
+//    Template on a render backend (see DisplayBackend.h), so drawing calls go
+//    straight to the display library, without virtual calls, and the backend
+//    fast paths (pixel bursts) are used for bitmaps and framebuffer flushes.
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_RENDERER_H
+#define DISPLAY_RENDERER_H
+
+#include <stdint.h>
+#include "DisplayMenu.h"
+#include "DisplayBackend.h"
+#include "DisplayRenderList.h"
+#include "DisplayFramebuffer.h"
+#include "DisplayGlyphCache.h"
+
+#define DISPLAY_RENDERER_TEXT_LEN (16)
+
+#ifndef DISPLAY_RENDERER_BAR_GAP
+#define DISPLAY_RENDERER_BAR_GAP  (1)     // pixels between a bar frame and its fill
+#endif
+#define DISPLAY_RENDERER_BAR_INSET (1 + DISPLAY_RENDERER_BAR_GAP)
+
+template <class Backend>
+class DisplayRenderer
+{
+public:
+  DisplayRenderer(Backend &backend) : _backend(backend) {}
+
+  Backend &getBackend() { return _backend; }
+
+  /***************************************************************************/
+  /*!
+      @brief Set how widget values are printed
+      @param size text size given to the backend
+      @param offsetX,offsetY text position in the widget
+      @param minChars values are padded with spaces to this length, so a
+        shorter value erases the previous one (width of the value formats)
+  */
+  /***************************************************************************/
+  void setTextStyle(uint8_t size, int16_t offsetX, int16_t offsetY, uint8_t minChars = 0)
+  {
+    _textSize = size;
+    _textOffsetX = offsetX;
+    _textOffsetY = offsetY;
+    _intFormat.width = (minChars < DISPLAY_RENDERER_TEXT_LEN) ? minChars : DISPLAY_RENDERER_TEXT_LEN - 1;
+    _floatFormat.width = _intFormat.width;
+  }
+
+  /***************************************************************************/
+  /*!
+      @brief Set how values are written (see DisplayValueFormat)
+      @param intFormat   integer widgets, left aligned without decimals by default
+      @param floatFormat float widgets, 2 decimals by default
+  */
+  /***************************************************************************/
+  void setValueFormat(const DisplayValueFormat &intFormat, const DisplayValueFormat &floatFormat)
+  {
+    _intFormat = intFormat;
+    _floatFormat = floatFormat;
+  }
+
+  /***************************************************************************/
+  /*!
+      @brief Print values from a glyph cache instead of the backend text
+      function. Values the cache cannot draw (other text size, character or
+      color) still go through the backend.
+      @param cache built for the text style size and the menu colors, or NULL
+  */
+  /***************************************************************************/
+  void setGlyphCache(DisplayGlyphCache *cache) { _glyphCache = cache; }
+
+  /***************************************************************************/
+  /*!
+      @brief Set the fill color of bar widgets, their frame is in the widget
+      state color and the empty part in the menu background color
+  */
+  /***************************************************************************/
+  void setBarColor(uint16_t fillColor) { _barColor = fillColor; }
+
+  /***************************************************************************/
+  /*!
+      @brief Draw a widget: frame of its size in the widget color (if it has a
+      size), and its value for editable widgets. Bars only draw what changed
+      since they were last drawn. The pixels sent are counted in the menu stats.
+  */
+  /***************************************************************************/
+  void printWidget(DisplayMenu &menu, uint16_t widgetIdx)
+  {
+    DisplayWidget *wdg = menu.getWidget(widgetIdx);
+    if ((wdg == NULL) || (wdg->getXPostion() < 0) || (wdg->getYPostion() < 0)) {
+      return;
+    }
+    uint16_t color = menu.getWidgetColor(widgetIdx);
+    if (wdg->getKind() == WIDGET_KIND_BAR) {
+      _printBar(menu, wdg, color);
+      return;
+    }
+    if ((wdg->getWidth() > 0) && (wdg->getHeight() > 0)) {
+      _backend.drawRect(wdg->getXPostion(), wdg->getYPostion(), wdg->getWidth(), wdg->getHeight(), color);
+      DISPLAY_STATS(menu.addPushedPixels(2 * (uint32_t)(wdg->getWidth() + wdg->getHeight())));
+    }
+    char text[DISPLAY_RENDERER_TEXT_LEN];
+    bool isFloat = (wdg->getKind() == WIDGET_KIND_TYPED_VALUE) && (wdg->getValueType() == VALUE_TYPE_FLOAT);
+    uint8_t len = wdg->formatValue(text, sizeof(text), isFloat ? _floatFormat : _intFormat);
+    if (len > 0) {
+      DISPLAY_STATS(menu.addPushedPixels((uint32_t)len * DISPLAY_BACKEND_CHAR_WIDTH * DISPLAY_BACKEND_CHAR_HEIGHT *
+                                         _textSize * _textSize));
+      int16_t x = wdg->getXPostion() + _textOffsetX;
+      int16_t y = wdg->getYPostion() + _textOffsetY;
+      bool isCached = (_glyphCache != NULL) && (_glyphCache->getTextSize() == _textSize) &&
+                      _glyphCache->drawText(x, y, text, color, _pushPixels, this);
+      if (!isCached) {
+        _backend.drawText(x, y, text, color, menu.getBackgroundColor(), _textSize);
+      }
+    }
+  }
+
+  /***************************************************************************/
+  /*!
+      @brief Draw every widget of the page, then flush the backend. Bars are
+      drawn entirely, the display may have been cleared.
+  */
+  /***************************************************************************/
+  void printMenu(DisplayMenu &menu)
+  {
+    menu.startPrint();
+    for (uint16_t i = 0; i < menu.getWidgetNb(); i++) {
+      DisplayWidget *wdg = menu.getWidget(i);
+      if (wdg != NULL) {
+        wdg->invalidateBar();
+      }
+      printWidget(menu, i);
+    }
+    _backend.flush();
+    menu.clearDamage();
+  }
+
+  /***************************************************************************/
+  /*!
+      @brief Draw the widgets that changed since they were last printed, then
+      flush the backend
+      @return number of widgets drawn
+  */
+  /***************************************************************************/
+  uint16_t printDirty(DisplayMenu &menu)
+  {
+    uint16_t printedNb = 0;
+    if (menu.startDirtyPrint()) {
+      do {
+        printWidget(menu, menu.getPrintWidgetIdx());
+        printedNb++;
+      } while (menu.nextDirtyPrint());
+    }
+    _backend.flush();
+    menu.clearDamage();
+    return printedNb;
+  }
+
+  /***************************************************************************/
+  /*!
+      @brief Send what changed in a render list, then flush the backend
+      @return number of commands sent
+  */
+  /***************************************************************************/
+  uint16_t commit(DisplayRenderList &list)
+  {
+    uint16_t sentNb = list.commit(_drawCmd, this);
+    _backend.flush();
+    return sentNb;
+  }
+
+  /***************************************************************************/
+  /*!
+      @brief Send the touched tiles of a framebuffer through the backend
+      @param menu if set, the pixels are counted in its stats
+      @return number of pixels sent
+  */
+  /***************************************************************************/
+  uint32_t flushFramebuffer(DisplayFramebuffer &fb, DisplayMenu *menu = NULL)
+  {
+    uint32_t pixelNb = fb.flush(_pushPixels, this);
+    if (menu != NULL) {
+      menu->addPushedPixels(pixelNb);
+    }
+    _backend.flush();
+    return pixelNb;
+  }
+
+private:
+  Backend &_backend;
+  uint8_t _textSize = 1;
+  int16_t _textOffsetX = 2;
+  int16_t _textOffsetY = 2;
+  DisplayValueFormat _intFormat = {0, 0, NULL, ' ', false};
+  DisplayValueFormat _floatFormat = {0, 2, NULL, ' ', false};
+  DisplayGlyphCache *_glyphCache = NULL;
+  uint16_t _barColor = 0xFFFF;
+
+  // Frame if the bar is new or changed state, then only the fill between the
+  // drawn extent and the new one, in fill or background color
+  void _printBar(DisplayMenu &menu, DisplayWidget *wdg, uint16_t color)
+  {
+    if ((wdg->getWidth() <= 2 * DISPLAY_RENDERER_BAR_INSET) || (wdg->getHeight() <= 2 * DISPLAY_RENDERER_BAR_INSET)) {
+      return;
+    }
+    bool isVertical = (wdg->getBarDirection() == BAR_BOTTOM_TO_TOP);
+    uint16_t length = (isVertical ? wdg->getHeight() : wdg->getWidth()) - 2 * DISPLAY_RENDERER_BAR_INSET;
+    uint16_t extent = wdg->getBarExtent(length);
+    int16_t drawn = wdg->getBarDrawnExtent();
+
+    if ((drawn < 0) || (wdg->getBarDrawnColor() != color)) {
+      _backend.drawRect(wdg->getXPostion(), wdg->getYPostion(), wdg->getWidth(), wdg->getHeight(), color);
+      DISPLAY_STATS(menu.addPushedPixels(2 * (uint32_t)(wdg->getWidth() + wdg->getHeight())));
+    }
+    if (drawn < 0) {
+      _fillBar(menu, wdg, 0, extent, _barColor);
+      _fillBar(menu, wdg, extent, length, menu.getBackgroundColor());
+    } else if (extent > (uint16_t)drawn) {
+      _fillBar(menu, wdg, drawn, extent, _barColor);
+    } else {
+      _fillBar(menu, wdg, extent, drawn, menu.getBackgroundColor());
+    }
+    wdg->setBarDrawn(extent, color);
+  }
+
+  // Part [from, to[ of a bar, along its direction
+  void _fillBar(DisplayMenu &menu, DisplayWidget *wdg, uint16_t from, uint16_t to, uint16_t color)
+  {
+    (void)menu;   // stats only
+    if (to <= from) {
+      return;
+    }
+    int16_t x = wdg->getXPostion() + DISPLAY_RENDERER_BAR_INSET;
+    int16_t y = wdg->getYPostion() + DISPLAY_RENDERER_BAR_INSET;
+    uint16_t w = wdg->getWidth() - 2 * DISPLAY_RENDERER_BAR_INSET;
+    uint16_t h = wdg->getHeight() - 2 * DISPLAY_RENDERER_BAR_INSET;
+    if (wdg->getBarDirection() == BAR_BOTTOM_TO_TOP) {
+      _backend.fillRect(x, y + h - to, w, to - from, color);
+      DISPLAY_STATS(menu.addPushedPixels((uint32_t)w * (to - from)));
+    } else {
+      _backend.fillRect(x + from, y, to - from, h, color);
+      DISPLAY_STATS(menu.addPushedPixels((uint32_t)h * (to - from)));
+    }
+  }
+
+  static void _drawCmd(const DisplayCmd &cmd, void *ctx)
+  {
+    Backend &backend = ((DisplayRenderer *)ctx)->_backend;
+    switch (cmd.type) {
+      case DISPLAY_CMD_FILL_RECT: backend.fillRect(cmd.x, cmd.y, cmd.w, cmd.h, cmd.color); break;
+      case DISPLAY_CMD_RECT:      backend.drawRect(cmd.x, cmd.y, cmd.w, cmd.h, cmd.color); break;
+      case DISPLAY_CMD_TEXT:      backend.drawText(cmd.x, cmd.y, cmd.getText(), cmd.color, cmd.bgColor, cmd.textSize); break;
+      case DISPLAY_CMD_BITMAP:    backend.drawBitmap(cmd.x, cmd.y, *cmd.getBitmap(), cmd.color, cmd.bgColor); break;
+    }
+  }
+
+  static void _pushPixels(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t *pixels, uint16_t stride,
+                          void *ctx)
+  {
+    ((DisplayRenderer *)ctx)->_backend.pushPixels(x, y, w, h, pixels, stride);
+  }
+};
+
+#endif
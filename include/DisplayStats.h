@@ -0,0 +1,56 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file contains the render statistics of a menu (see
+//    DisplayMenu::getStats): how many frames were drawn, what they cost and
+//    how inputs were applied, to find the expensive pages on deployed units.
+//
+// Implementation:
+//    Counters are only compiled in when DISPLAY_MENU_STATS is defined to 1, for
+//    the whole project (it changes the DisplayMenu layout). Otherwise the
+//    counting code expands to nothing and getStats() reads zeros.
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_STATS_H
+#define DISPLAY_STATS_H
+
+#include <stdint.h>
+
+#ifndef DISPLAY_MENU_STATS
+#define DISPLAY_MENU_STATS (0)
+#endif
+
+#if DISPLAY_MENU_STATS
+#define DISPLAY_STATS(...) __VA_ARGS__
+#else
+#define DISPLAY_STATS(...)
+#endif
+
+struct DisplayRenderStats
+{
+  uint32_t frameNb;             // startPrint() or startDirtyPrint() to the last widget printed (or clearDamage())
+  uint32_t redrawnWidgetNb;
+  uint32_t skippedWidgetNb;     // widgets of a frame that were not dirty
+  uint32_t pushedPixelNb;       // reported by the renderer, see DisplayMenu::addPushedPixels
+  uint32_t pushedByteNb;
+  uint32_t damageRectNb;        // damage rectangles at the end of the frames
+  uint32_t inputEventNb;        // events taken by processInputs()
+  uint32_t coalescedInputNb;    // events merged with others instead of applied one by one
+  uint32_t lastFrameUs;
+  uint32_t worstFrameUs;
+};
+
+#endif
@@ -0,0 +1,84 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file contains the render backend for the TFT_eSPI library, see
+//    DisplayBackend.h. Pixels are native RGB565, call tft.setSwapBytes(true)
+//    as for pushImage().
+//
+// Implementation:
+//    Template on the display class (TFT_eSPI, or TFT_eSprite to draw in a
+//    sprite), so this file does not depend on the TFT_eSPI headers. Opaque
+//    bitmaps and pixel rectangles are sent with one address window and
+//    pushPixels bursts.
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_TFT_ESPI_BACKEND_H
+#define DISPLAY_TFT_ESPI_BACKEND_H
+
+#include "DisplayBackend.h"
+
+template <class Tft>
+class DisplayTftEspiBackend
+{
+public:
+  DisplayTftEspiBackend(Tft &tft) : _tft(tft) {}
+
+  void fillRect(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t color) { _tft.fillRect(x, y, w, h, color); }
+  void drawRect(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t color) { _tft.drawRect(x, y, w, h, color); }
+
+  void drawBitmap(int16_t x, int16_t y, const DisplayBitmap &bmp, uint16_t color, uint16_t bgColor)
+  {
+    if ((bmp.width > DISPLAY_BACKEND_LINE_PIXELS) || (x < 0) || (y < 0) ||
+        ((int32_t)x + (int32_t)bmp.width > _tft.width()) || ((int32_t)y + (int32_t)bmp.height > _tft.height())) {
+      _tft.drawBitmap(x, y, bmp.bitmap, bmp.width, bmp.height, color, bgColor);
+      return;
+    }
+    _blit.setColors(color, bgColor);
+    _tft.startWrite();
+    _tft.setAddrWindow(x, y, bmp.width, bmp.height);
+    for (uint16_t row = 0; row < bmp.height; row++) {
+      _blit.expandRow(bmp, row, _line);
+      _tft.pushPixels(_line, bmp.width);
+    }
+    _tft.endWrite();
+  }
+
+  void drawText(int16_t x, int16_t y, const char *text, uint16_t color, uint16_t bgColor, uint8_t size)
+  {
+    _tft.setTextColor(color, bgColor);
+    _tft.setTextSize(size);
+    _tft.drawString(text, x, y);
+  }
+
+  void pushPixels(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t *pixels, uint16_t stride)
+  {
+    _tft.startWrite();
+    _tft.setAddrWindow(x, y, w, h);
+    for (uint16_t j = 0; j < h; j++) {
+      _tft.pushPixels(&pixels[(uint32_t)j * stride], w);
+    }
+    _tft.endWrite();
+  }
+
+  void flush() {}
+
+private:
+  Tft &_tft;
+  DisplayBlit _blit;
+  uint16_t _line[DISPLAY_BACKEND_LINE_PIXELS];
+};
+
+#endif
@@ -0,0 +1,208 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file contains an animation engine: tweens move a variable (level,
+//    position, color, ...) or a widget (value, x, y) from its current value to
+//    a target in a given time, following an easing curve. A single
+//    DisplayAnimator::update() in the loop steps every running tween.
+//    Each step reports the previous and new values, so the application only
+//    redraws what moved (i.e. the columns between the old and new end of a
+//    bar) instead of clearing and redrawing the whole drawing.
+//
+// Implementation:
+//    Fixed point only: progress is a 16 bit fraction of the duration, eased
+//    with 17 points tables (linear interpolation between points) and applied
+//    with a multiply and a shift. Colors are RGB565, eased per channel.
+//    Tweens are stored in a fixed array of the animator, no heap. Starting a
+//    tween on a target that is already animated replaces the running one, so
+//    the animation restarts from where it is. Widget tweens keep the widget
+//    pointer and the page change count of the menu, and stop when the widget
+//    index names another widget.
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_TWEEN_H
+#define DISPLAY_TWEEN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "DisplayMenu.h"
+
+#ifndef DISPLAY_ANIMATOR_MAX_TWEENS
+#define DISPLAY_ANIMATOR_MAX_TWEENS (8)
+#endif
+
+#define DISPLAY_ANIMATOR_DFLT_STEP_MS (16)   // about 60 steps per second
+#define DISPLAY_TWEEN_NONE (-1)
+
+enum DisplayEasing : uint8_t
+{
+  EASE_LINEAR = 0,
+  EASE_IN,          // starts slowly (quadratic)
+  EASE_OUT,         // ends slowly
+  EASE_IN_OUT
+};
+
+enum DisplayTweenKind : uint8_t
+{
+  TWEEN_KIND_INT16 = 0,   // int16_t variable
+  TWEEN_KIND_INT32,       // int32_t variable
+  TWEEN_KIND_COLOR,       // uint16_t RGB565 variable
+  TWEEN_KIND_WIDGET_VALUE,  // bound int of a value widget
+  TWEEN_KIND_WIDGET_X,
+  TWEEN_KIND_WIDGET_Y
+};
+
+/***************************************************************************/
+/*!
+    @brief Called on every step that changed the animated value
+    @param previous value before the step (RGB565 for colors)
+    @param current  value after the step
+    @param isDone   last step of the tween
+*/
+/***************************************************************************/
+typedef void (*DisplayTweenStepFct)(int32_t previous, int32_t current, bool isDone, void *ctx);
+
+class DisplayAnimator
+{
+public:
+  DisplayAnimator()
+  {
+    for (uint8_t i = 0; i < DISPLAY_ANIMATOR_MAX_TWEENS; i++) {
+      _tweens[i].isRunning = false;
+    }
+  }
+
+  /***************************************************************************/
+  /*!
+      @brief Animate a variable from its current value
+      @param target     animated variable, must outlive the tween
+      @param to         final value
+      @param durationMs 0 jumps to the final value at the next update
+      @param stepFct    called when the value changed, can be NULL
+      @return tween handle, DISPLAY_TWEEN_NONE if all tweens are running
+  */
+  /***************************************************************************/
+  int8_t animate(int16_t *target, int16_t to, uint16_t durationMs, DisplayEasing easing = EASE_IN_OUT,
+                 DisplayTweenStepFct stepFct = NULL, void *ctx = NULL)
+  {
+    return _start(TWEEN_KIND_INT16, target, *target, to, durationMs, easing, stepFct, ctx);
+  }
+
+  int8_t animate(int32_t *target, int32_t to, uint16_t durationMs, DisplayEasing easing = EASE_IN_OUT,
+                 DisplayTweenStepFct stepFct = NULL, void *ctx = NULL)
+  {
+    return _start(TWEEN_KIND_INT32, target, *target, to, durationMs, easing, stepFct, ctx);
+  }
+
+  int8_t animateColor(uint16_t *target, uint16_t to, uint16_t durationMs, DisplayEasing easing = EASE_LINEAR,
+                      DisplayTweenStepFct stepFct = NULL, void *ctx = NULL)
+  {
+    return _start(TWEEN_KIND_COLOR, target, *target, to, durationMs, easing, stepFct, ctx);
+  }
+
+  /***************************************************************************/
+  /*!
+      @brief Animate a widget of a menu: the bound value of a value widget
+      (TWEEN_KIND_WIDGET_VALUE) or its position (TWEEN_KIND_WIDGET_X/Y). The
+      widget is flagged changed on each step, a moved widget also damages the
+      area it leaves. The tween stops, without a last step, when the widget
+      leaves the page: new page, page stack push or pop, list scroll (see
+      DisplayMenu::getPageChangeNb()).
+      @return DISPLAY_TWEEN_NONE if the widget does not exist or has no int value
+  */
+  /***************************************************************************/
+  int8_t animateWidget(DisplayMenu &menu, uint16_t widgetIdx, DisplayTweenKind kind, int32_t to, uint16_t durationMs,
+                       DisplayEasing easing = EASE_IN_OUT, DisplayTweenStepFct stepFct = NULL, void *ctx = NULL);
+
+  /***************************************************************************/
+  /*!
+      @brief Step every running tween, at most once per step period
+      @param nowMs current time, millis()
+      @return number of tweens whose value changed
+  */
+  /***************************************************************************/
+  uint8_t update(unsigned long nowMs);
+  uint8_t update() { return update(millis()); }
+
+  /***************************************************************************/
+  /*!
+      @brief Stop a tween where it is, or jump to its final value
+  */
+  /***************************************************************************/
+  void stop(int8_t handle, bool isFinished = false);
+  bool isRunning(int8_t handle);
+  uint8_t getRunningNb();
+
+  /***************************************************************************/
+  /*!
+      @brief Time between two steps of the running tweens
+  */
+  /***************************************************************************/
+  void setStepPeriod(uint16_t periodMs) { _stepPeriodMs = periodMs; }
+
+  /***************************************************************************/
+  /*!
+      @brief Time until update() has a step to do, to be combined with
+      DisplayMenu::getNextDeadlineMs() in tickless loops
+      @return DISPLAY_DEADLINE_NEVER when no tween is running, or only tweens
+      of widgets that left the page
+  */
+  /***************************************************************************/
+  uint32_t getNextDeadlineMs(unsigned long nowMs);
+  uint32_t getNextDeadlineMs() { return getNextDeadlineMs(millis()); }
+
+  /***************************************************************************/
+  /*!
+      @brief Eased value between two values
+      @param progress fraction of the animation, 0 to 65536
+  */
+  /***************************************************************************/
+  static int32_t ease(int32_t from, int32_t to, uint32_t progress, DisplayEasing easing);
+  static uint16_t easeColor(uint16_t from, uint16_t to, uint32_t progress, DisplayEasing easing);
+
+private:
+  struct _Tween
+  {
+    void *target;            // variable, or DisplayWidget for widget tweens
+    DisplayMenu *menu;       // widget tweens only
+    DisplayTweenStepFct stepFct;
+    void *ctx;
+    int32_t from;
+    int32_t to;
+    int32_t current;
+    unsigned long startMs;
+    uint16_t durationMs;
+    uint16_t widgetIdx;
+    uint16_t pageChangeNb;   // of the menu when a widget tween started
+    uint8_t kind;            // DisplayTweenKind
+    uint8_t easing;          // DisplayEasing
+    bool isRunning;
+  };
+
+  _Tween _tweens[DISPLAY_ANIMATOR_MAX_TWEENS];
+  uint8_t _runningNb = 0;
+  uint16_t _stepPeriodMs = DISPLAY_ANIMATOR_DFLT_STEP_MS;
+  unsigned long _lastStepMs = 0;
+  bool _hasStepped = false;
+
+  int8_t _start(DisplayTweenKind kind, void *target, int32_t from, int32_t to, uint16_t durationMs,
+                DisplayEasing easing, DisplayTweenStepFct stepFct, void *ctx);
+  void _apply(_Tween &tween, int32_t value);
+  static bool _isWidgetGone(_Tween &tween);
+  static uint32_t _easeProgress(uint32_t progress, DisplayEasing easing);
+};
+
+#endif
@@ -0,0 +1,192 @@
+//***********************************************************************************
+// Copyright 2021 jcsb1994
+// Written by jcsb1994
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//***********************************************************************************
+//
+// Description:
+//    This file contains the typed description of a value edited by a widget:
+//    the bound variable with its step, floor and ceiling, all of the same type.
+//    Settings can then be stored in their natural size (uint8_t, int16_t, float,
+//    ...) instead of int.
+//    Fixed point values are stored as their raw integer (i.e. int16_t in 1/10
+//    units), the step, floor and ceiling being in the same raw units.
+//
+// Implementation:
+//    The widget keeps a pointer to the DisplayValueRange and a type tag, edits
+//    switch on the tag to the matching template instance (no virtual call).
+//    A DisplayValueRange can be const, so it stays in flash on most MCUs.
+//    Bound values can be shown by several tasks (see DisplayMenuGroup.h), so
+//    they are read and written with displayValueLoad/displayValueStore. On 32
+//    bit MCUs and hosts that is one relaxed atomic access, a plain load or
+//    store of at most a word (even without compare and swap, i.e. Cortex-M0):
+//    no data race and no torn value. AVR has no such access for 16 and 32 bit
+//    values (generic atomics would become library calls), so there the access
+//    is done with interrupts off: an interrupt handler sees the old or the new
+//    value, never half of each.
+//
+//***********************************************************************************
+
+#ifndef DISPLAY_VALUE_H
+#define DISPLAY_VALUE_H
+
+#include "stdint.h"
+#if defined(__AVR__)
+#include <util/atomic.h>
+#endif
+
+enum DisplayValueType : uint8_t
+{
+  VALUE_TYPE_UINT8 = 0,
+  VALUE_TYPE_INT8,
+  VALUE_TYPE_UINT16,
+  VALUE_TYPE_INT16,
+  VALUE_TYPE_UINT32,
+  VALUE_TYPE_INT32,
+  VALUE_TYPE_FLOAT
+};
+
+template <typename T>
+struct DisplayValueRange
+{
+  T *value;
+  T step;
+  T floor;
+  T ceiling;
+};
+
+// Type tag, type wide enough to compute an accelerated step without overflow,
+// and unsigned type wide enough for a value offset times a length in pixels
+template <typename T> struct DisplayValueTraits;
+template <> struct DisplayValueTraits<uint8_t>  { static const DisplayValueType type = VALUE_TYPE_UINT8;  typedef int32_t Wide; typedef uint32_t Span; };
+template <> struct DisplayValueTraits<int8_t>   { static const DisplayValueType type = VALUE_TYPE_INT8;   typedef int32_t Wide; typedef uint32_t Span; };
+template <> struct DisplayValueTraits<uint16_t> { static const DisplayValueType type = VALUE_TYPE_UINT16; typedef int32_t Wide; typedef uint32_t Span; };
+template <> struct DisplayValueTraits<int16_t>  { static const DisplayValueType type = VALUE_TYPE_INT16;  typedef int32_t Wide; typedef uint32_t Span; };
+template <> struct DisplayValueTraits<uint32_t> { static const DisplayValueType type = VALUE_TYPE_UINT32; typedef int64_t Wide; typedef uint64_t Span; };
+template <> struct DisplayValueTraits<int32_t>  { static const DisplayValueType type = VALUE_TYPE_INT32;  typedef int64_t Wide; typedef uint64_t Span; };
+template <> struct DisplayValueTraits<float>    { static const DisplayValueType type = VALUE_TYPE_FLOAT;  typedef float Wide;   typedef float Span; };
+
+/***************************************************************************/
+/*!
+    @brief Read a bound value, in one access
+    @param value bound variable
+    @return current value
+*/
+/***************************************************************************/
+template <typename T>
+T displayValueLoad(const T *value)
+{
+  T current;
+#if defined(__AVR__)
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { current = *(const volatile T *)value; }
+#else
+  static_assert(sizeof(T) <= sizeof(void *), "bound values must fit a single load or store");
+  __atomic_load(value, &current, __ATOMIC_RELAXED);
+#endif
+  return current;
+}
+
+/***************************************************************************/
+/*!
+    @brief Write a bound value, in one access. The application uses it for
+    values shown by other tasks, before DisplayMenuGroup::notifyValueChange().
+    @param value bound variable
+    @param next  new value
+*/
+/***************************************************************************/
+template <typename T>
+void displayValueStore(T *value, T next)
+{
+#if defined(__AVR__)
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { *(volatile T *)value = next; }
+#else
+  static_assert(sizeof(T) <= sizeof(void *), "bound values must fit a single load or store");
+  __atomic_store(value, &next, __ATOMIC_RELAXED);
+#endif
+}
+
+// Float steps add rounding errors (0.1 added ten times is over 1.0): a step
+// ending less than half a step past a limit lands on it. Integer steps are exact.
+template <typename T>
+T displayValueSlack(T step)
+{
+  (void)step;
+  return 0;
+}
+inline float displayValueSlack(float step) { return step / 2; }
+
+/***************************************************************************/
+/*!
+    @brief Step a typed value. Same rules as the int widgets: going over a limit
+    wraps to the other one, unless saturating, and accelerated steps stop on the
+    limit before wrapping. Floats land on a limit they miss by rounding errors
+    (see displayValueSlack). The load and the store are atomic, not the whole
+    step: a value has one writer at a time.
+    @param range      value description
+    @param isIncrease step direction
+    @param multiplier number of steps applied at once
+    @param isSaturating stay on the limits instead of wrapping
+*/
+/***************************************************************************/
+template <typename T>
+void displayValueStep(const DisplayValueRange<T> &range, bool isIncrease, uint16_t multiplier, bool isSaturating)
+{
+  typedef typename DisplayValueTraits<T>::Wide Wide;
+  T current = displayValueLoad(range.value);
+  Wide delta = (Wide)range.step * multiplier;
+  Wide slack = displayValueSlack(range.step);
+
+  if (isIncrease) {
+    Wide next = (Wide)current + delta;
+    if (next > (Wide)range.ceiling + slack) {
+      bool stopsOnLimit = isSaturating || ((multiplier > 1) && (current < range.ceiling));
+      displayValueStore(range.value, stopsOnLimit ? range.ceiling : range.floor);
+    } else {
+      displayValueStore(range.value, (next > (Wide)range.ceiling) ? range.ceiling : (T)next);
+    }
+  } else {
+    Wide next = (Wide)current - delta;
+    if (next < (Wide)range.floor - slack) {
+      bool stopsOnLimit = isSaturating || ((multiplier > 1) && (current > range.floor));
+      displayValueStore(range.value, stopsOnLimit ? range.floor : range.ceiling);
+    } else {
+      displayValueStore(range.value, (next < (Wide)range.floor) ? range.floor : (T)next);
+    }
+  }
+}
+
+/***************************************************************************/
+/*!
+    @brief Position of a typed value in its range, scaled to a length (i.e. the
+    filled part of a bar). Values out of the range are clamped.
+    @param range  value description
+    @param length length matching the ceiling
+    @return 0 at the floor, length at the ceiling
+*/
+/***************************************************************************/
+template <typename T>
+uint16_t displayValueScale(const DisplayValueRange<T> &range, uint16_t length)
+{
+  typedef typename DisplayValueTraits<T>::Wide Wide;
+  typedef typename DisplayValueTraits<T>::Span Span;
+  T current = displayValueLoad(range.value);
+  if (current <= range.floor) {
+    return 0;
+  }
+  if (current >= range.ceiling) {
+    return length;
+  }
+  Span offset = (Span)((Wide)current - (Wide)range.floor);
+  Span span = (Span)((Wide)range.ceiling - (Wide)range.floor);
+  return (uint16_t)(offset * length / span);
+}
+
+#endif
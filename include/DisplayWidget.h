@@ -20,13 +20,50 @@
 // Implementation:
 //    Implemented with Arduino.h, can be used with various TFT screens, can operate
 //    with the Adafruit_GFX library, TFT_eSPI, ...
+//    Kept small for pages with many widgets: the fields of the different widget
+//    kinds share a union, positions and the increment are 16 bits and the flags
+//    are bit fields in two bytes (24 bytes on 32 bit MCUs, see
+//    DISPLAY_WIDGET_SIZE_BUDGET, also checked by the host build).
 //
 //***********************************************************************************
 
 #ifndef DISPLAY_WIDGET_H
 #define DISPLAY_WIDGET_H
 
+#include <stddef.h>
 #include "stdint.h"
+#include "DisplayValue.h"
+#include "DisplayFormat.h"
+
+// Hold time after which a held edit key speeds up, see DisplayWidget::getRampMultiplier()
+#define EDIT_RAMP_TIER1_MS        (1000)
+#define EDIT_RAMP_TIER2_MS        (2500)
+#define EDIT_RAMP_TIER1_FACTOR    (10)
+#define EDIT_RAMP_TIER2_FACTOR    (100)
+#define EDIT_RAMP_DOUBLING_MS     (400)
+#define EDIT_RAMP_MAX_FACTOR      (1024)
+
+enum DisplayWidgetKind : uint8_t
+{
+  WIDGET_KIND_ACTION = 0,       // calls a function when activated
+  WIDGET_KIND_PARAM_ACTION,     // calls a function with a parameter when activated
+  WIDGET_KIND_VALUE,            // edits a bound int value
+  WIDGET_KIND_TYPED_VALUE,      // edits a value described by a DisplayValueRange
+  WIDGET_KIND_BAR               // shows a value described by a DisplayValueRange as a bar
+};
+
+enum DisplayBarDirection : uint8_t
+{
+  BAR_LEFT_TO_RIGHT = 0,
+  BAR_BOTTOM_TO_TOP
+};
+
+enum DisplayEditRamp : uint8_t
+{
+  EDIT_RAMP_NONE = 0,     // fixed steps, whatever the hold time
+  EDIT_RAMP_TIERED,       // x1, then x10 and x100 after the tier times
+  EDIT_RAMP_EXPONENTIAL   // step doubles every EDIT_RAMP_DOUBLING_MS
+};
 
 class DisplayWidget
 {
@@ -37,11 +74,12 @@ public:
     @param  activation_fct function to run when widget is pressed
   */
   /**********************************************************************/
-  DisplayWidget(void(activation_fct)(), int xPos = -1, int yPos = -1) : _value(NULL)
+  DisplayWidget(void(activation_fct)(), int xPos = -1, int yPos = -1, int width = 0, int height = 0)
+      : _kind(WIDGET_KIND_ACTION), _isSaturating(false), _editRamp(EDIT_RAMP_NONE), _valueType(0), _isLowPriority(false)
   {
     setPosition(xPos, yPos);
-    _activationFct = activation_fct;
-    _isEditable = false;
+    setSize(width, height);
+    _data.action.fct = activation_fct;
   }
 
   /**********************************************************************/
@@ -52,50 +90,283 @@ public:
     @param  paramValue     param to pass to the function when widget is activated
   */
   /**********************************************************************/
-  DisplayWidget(void(activation_fct)(int), int paramValue) : _value(NULL)
+  DisplayWidget(void(activation_fct)(int), int paramValue)
+      : _kind(WIDGET_KIND_PARAM_ACTION), _isSaturating(false), _editRamp(EDIT_RAMP_NONE), _valueType(0), _isLowPriority(false)
   {
-    _activationParam = paramValue;
-    _paramActivationFct = activation_fct;
-    _isEditable = false;
+    _data.paramAction.fct = activation_fct;
+    _data.paramAction.param = paramValue;
   }
 
   /**********************************************************************/
   /*!
     @brief  Ctor for modifiable widgets, that contain a value that can be inc/decremented
     @param  displayedValue variable to link to the widget
-    @param  incrementAmount Numeric amount by which the displayed value is changed when edited
+    @param  incrementAmount Numeric amount by which the displayed value is changed when edited (16 bits,
+    larger amounts are clamped to 65535)
+  */
+  /**********************************************************************/
+  DisplayWidget(void *displayedValue, unsigned int incrementAmount, int valueCeiling, int valueFloor = 0, int xPos = -1, int yPos = -1,
+                int width = 0, int height = 0)
+      : _incrementSize((incrementAmount > UINT16_MAX) ? UINT16_MAX : incrementAmount), _kind(WIDGET_KIND_VALUE), _isSaturating(false), _editRamp(EDIT_RAMP_NONE), _valueType(0), _isLowPriority(false)
+  {
+    setPosition(xPos, yPos);
+    setSize(width, height);
+    _data.value.ptr = (int*)displayedValue;
+    _data.value.ceiling = valueCeiling;
+    _data.value.floor = valueFloor;
+  }
+
+  /**********************************************************************/
+  /*!
+    @brief  Ctor for modifiable widgets bound to a value of any supported type
+    (see DisplayValueType)
+    @param  range bound variable with its step, floor and ceiling. Must outlive
+    the widget, can be const.
   */
   /**********************************************************************/
-  DisplayWidget(void *displayedValue, unsigned int incrementAmount, int valueCeiling, int valueFloor = 0, int xPos = -1, int yPos = -1)
-      : _value(displayedValue), _incrementSize(incrementAmount),
-        _valueCeiling(valueCeiling), _valueFloor(valueFloor)
+  template <typename T>
+  DisplayWidget(const DisplayValueRange<T> &range, int xPos = -1, int yPos = -1, int width = 0, int height = 0)
+      : _kind(WIDGET_KIND_TYPED_VALUE), _isSaturating(false), _editRamp(EDIT_RAMP_NONE),
+        _valueType(DisplayValueTraits<T>::type), _isLowPriority(false)
   {
     setPosition(xPos, yPos);
-    _isEditable = true;
+    setSize(width, height);
+    _data.typedValue.range = &range;
+  }
+
+  /**********************************************************************/
+  /*!
+    @brief  Ctor for bar widgets (level, progress), filled in proportion of
+    a value in its range. Bars are not editable, the bound value is changed
+    by the application (see DisplayMenu::flagWidgetChange).
+    @param  range bound variable with its floor and ceiling (step unused).
+    Must outlive the widget, can be const.
+    @param  direction side the bar fills from
+  */
+  /**********************************************************************/
+  template <typename T>
+  DisplayWidget(const DisplayValueRange<T> &range, DisplayBarDirection direction, int xPos, int yPos, int width,
+                int height)
+      : _kind(WIDGET_KIND_BAR), _isSaturating(false), _editRamp(EDIT_RAMP_NONE),
+        _valueType(DisplayValueTraits<T>::type), _isLowPriority(false)
+  {
+    _data.bar.range = &range;
+    _data.bar.direction = direction;
+    setPosition(xPos, yPos);
+    setSize(width, height);
+    invalidateBar();
+  }
+
+  bool is_editable() { return (_kind == WIDGET_KIND_VALUE) || (_kind == WIDGET_KIND_TYPED_VALUE); }
+  DisplayWidgetKind getKind() { return (DisplayWidgetKind)_kind; }
+  DisplayValueType getValueType() { return (DisplayValueType)_valueType; }
+
+  // Bound value description, for printing: int widgets have the int pointer,
+  // typed widgets the DisplayValueRange of getValueType()
+  int *getIntValue() { return (_kind == WIDGET_KIND_VALUE) ? _data.value.ptr : NULL; }
+  const void *getValueRange()
+  {
+    return ((_kind == WIDGET_KIND_TYPED_VALUE) || (_kind == WIDGET_KIND_BAR)) ? _data.typedValue.range : NULL;
+  }
+
+  /**********************************************************************/
+  /*!
+    @brief  Address of the bound variable, to find the widgets showing a
+    given value (i.e. on another display)
+    @return NULL for widgets without value
+  */
+  /**********************************************************************/
+  const void *getValuePtr()
+  {
+    const void *range = getValueRange();
+    if (_kind == WIDGET_KIND_VALUE) {
+      return _data.value.ptr;
+    }
+    if (range == NULL) {
+      return NULL;
+    }
+    switch ((DisplayValueType)_valueType) {
+      case VALUE_TYPE_UINT8:  return ((const DisplayValueRange<uint8_t> *)range)->value;
+      case VALUE_TYPE_INT8:   return ((const DisplayValueRange<int8_t> *)range)->value;
+      case VALUE_TYPE_UINT16: return ((const DisplayValueRange<uint16_t> *)range)->value;
+      case VALUE_TYPE_INT16:  return ((const DisplayValueRange<int16_t> *)range)->value;
+      case VALUE_TYPE_UINT32: return ((const DisplayValueRange<uint32_t> *)range)->value;
+      case VALUE_TYPE_INT32:  return ((const DisplayValueRange<int32_t> *)range)->value;
+      default:                return ((const DisplayValueRange<float> *)range)->value;
+    }
+  }
+
+  /**********************************************************************/
+  /*!
+    @brief  Bar widgets: filled length for the bound value
+    @param  length length of a full bar, in pixels
+    @return 0 for an empty bar or another widget kind
+  */
+  /**********************************************************************/
+  uint16_t getBarExtent(uint16_t length)
+  {
+    const void *range = _data.bar.range;
+    if (_kind != WIDGET_KIND_BAR) {
+      return 0;
+    }
+    switch ((DisplayValueType)_valueType) {
+      case VALUE_TYPE_UINT8:  return displayValueScale(*(const DisplayValueRange<uint8_t> *)range, length);
+      case VALUE_TYPE_INT8:   return displayValueScale(*(const DisplayValueRange<int8_t> *)range, length);
+      case VALUE_TYPE_UINT16: return displayValueScale(*(const DisplayValueRange<uint16_t> *)range, length);
+      case VALUE_TYPE_INT16:  return displayValueScale(*(const DisplayValueRange<int16_t> *)range, length);
+      case VALUE_TYPE_UINT32: return displayValueScale(*(const DisplayValueRange<uint32_t> *)range, length);
+      case VALUE_TYPE_INT32:  return displayValueScale(*(const DisplayValueRange<int32_t> *)range, length);
+      default:                return displayValueScale(*(const DisplayValueRange<float> *)range, length);
+    }
+  }
+  DisplayBarDirection getBarDirection() { return (DisplayBarDirection)_data.bar.direction; }
+
+  /**********************************************************************/
+  /*!
+    @brief  Bar widgets: what is currently on the display, so a value change
+    only redraws the part of the bar between the drawn and the new extent.
+    Moving or resizing the bar invalidates it.
+    @return drawn fill length, -1 if the bar has to be drawn entirely
+  */
+  /**********************************************************************/
+  int16_t getBarDrawnExtent() { return (_kind == WIDGET_KIND_BAR) ? _data.bar.drawnExtent : -1; }
+  uint16_t getBarDrawnColor() { return _data.bar.drawnColor; }
+  void setBarDrawn(int16_t extent, uint16_t frameColor)
+  {
+    if (_kind == WIDGET_KIND_BAR) {
+      _data.bar.drawnExtent = extent;
+      _data.bar.drawnColor = frameColor;
+    }
+  }
+  void invalidateBar() { setBarDrawn(-1, 0); }
+
+  /**********************************************************************/
+  /*!
+    @brief  Write the bound value as text, without heap (see DisplayFormat.h)
+    @param  text     destination buffer, always NUL terminated
+    @param  textSize size of text, NUL included
+    @param  format   width, padding, decimals and unit, {} for the value alone
+    @return text length, 0 for widgets without value or a too small buffer
+  */
+  /**********************************************************************/
+  uint8_t formatValue(char *text, uint8_t textSize, const DisplayValueFormat &format)
+  {
+    const void *range = _data.typedValue.range;
+    if (_kind == WIDGET_KIND_VALUE) {
+      return displayFormatInt(displayValueLoad(_data.value.ptr), format, text, textSize);
+    }
+    if (_kind != WIDGET_KIND_TYPED_VALUE) {
+      if (textSize > 0) {
+        text[0] = '\0';
+      }
+      return 0;
+    }
+    switch ((DisplayValueType)_valueType) {
+      case VALUE_TYPE_UINT8:  return displayFormatInt(displayValueLoad(((const DisplayValueRange<uint8_t> *)range)->value), format, text, textSize);
+      case VALUE_TYPE_INT8:   return displayFormatInt(displayValueLoad(((const DisplayValueRange<int8_t> *)range)->value), format, text, textSize);
+      case VALUE_TYPE_UINT16: return displayFormatInt(displayValueLoad(((const DisplayValueRange<uint16_t> *)range)->value), format, text, textSize);
+      case VALUE_TYPE_INT16:  return displayFormatInt(displayValueLoad(((const DisplayValueRange<int16_t> *)range)->value), format, text, textSize);
+      case VALUE_TYPE_UINT32: return displayFormatUInt(displayValueLoad(((const DisplayValueRange<uint32_t> *)range)->value), format, text, textSize);
+      case VALUE_TYPE_INT32:  return displayFormatInt(displayValueLoad(((const DisplayValueRange<int32_t> *)range)->value), format, text, textSize);
+      default:                return displayFormatFloat(displayValueLoad(((const DisplayValueRange<float> *)range)->value), format, text, textSize);
+    }
   }
 
-  ~DisplayWidget() {}
-  bool is_editable() { return _isEditable; }
   void activate() {
-    if (_isEditable) {
+    if ((_kind == WIDGET_KIND_ACTION) && (_data.action.fct != NULL)) {
+      _data.action.fct();
+    } else if ((_kind == WIDGET_KIND_PARAM_ACTION) && (_data.paramAction.fct != NULL)) {
+      _data.paramAction.fct(_data.paramAction.param);
+    }
+  }
+  /**********************************************************************/
+  /*!
+    @brief  Increase the value by its increment size. Going over the ceiling
+    wraps to the floor, or stays at the ceiling for saturating widgets.
+    @param  multiplier number of increment sizes to add at once (held keys).
+    An accelerated step that would jump over the ceiling stops on it first.
+  */
+  /**********************************************************************/
+  void increment(uint16_t multiplier = 1)
+  {
+    if (_kind == WIDGET_KIND_TYPED_VALUE) {
+      _stepTypedValue(true, multiplier);
       return;
     }
-    if(_activationFct != NULL) 
-      _activationFct();
-    else if(_paramActivationFct != NULL) 
-      _paramActivationFct(_activationParam);      
+    if (_kind != WIDGET_KIND_VALUE) {
+      return;
+    }
+    int current = displayValueLoad(_data.value.ptr);
+    int64_t next = (int64_t)current + (int64_t)_incrementSize * multiplier;   // long is 32 bits on MCUs
+    if (next > _data.value.ceiling) {
+      bool stopsOnLimit = _isSaturating || ((multiplier > 1) && (current < _data.value.ceiling));
+      displayValueStore(_data.value.ptr, stopsOnLimit ? _data.value.ceiling : _data.value.floor);
+    } else {
+      displayValueStore(_data.value.ptr, (int)next);
+    }
   }
-  void increment()
+  void decrement(uint16_t multiplier = 1)
   {
-    *(int*)_value += _incrementSize;
-    if (*(int*)_value > _valueCeiling)
-      *(int*)_value = _valueFloor;
+    if (_kind == WIDGET_KIND_TYPED_VALUE) {
+      _stepTypedValue(false, multiplier);
+      return;
+    }
+    if (_kind != WIDGET_KIND_VALUE) {
+      return;
+    }
+    int current = displayValueLoad(_data.value.ptr);
+    int64_t next = (int64_t)current - (int64_t)_incrementSize * multiplier;
+    if (next < _data.value.floor) {
+      bool stopsOnLimit = _isSaturating || ((multiplier > 1) && (current > _data.value.floor));
+      displayValueStore(_data.value.ptr, stopsOnLimit ? _data.value.floor : _data.value.ceiling);
+    } else {
+      displayValueStore(_data.value.ptr, (int)next);
+    }
   }
-  void decrement()
+
+  /**********************************************************************/
+  /*!
+    @brief  Set how edits speed up when an edit key is held (see
+    DisplayMenu::holdKey)
+  */
+  /**********************************************************************/
+  void setEditRamp(DisplayEditRamp ramp) { _editRamp = ramp; }
+  void setSaturating(bool isSaturating) { _isSaturating = isSaturating; }
+
+  /**********************************************************************/
+  /*!
+    @brief  Low priority widgets (clock, graph, ...) are left for the next
+    frame when a frame runs out of time (see DisplayMenu::setFrameSchedule)
+  */
+  /**********************************************************************/
+  void setLowPriority(bool isLowPriority) { _isLowPriority = isLowPriority; }
+  bool isLowPriority() { return _isLowPriority; }
+
+  /**********************************************************************/
+  /*!
+    @brief  Number of increment sizes to apply per repeat for a key held
+    for heldMs
+  */
+  /**********************************************************************/
+  uint16_t getRampMultiplier(unsigned long heldMs)
   {
-    *(int*)_value -= _incrementSize;
-    if (*(int*)_value < _valueFloor)
-      *(int*)_value = _valueCeiling;
+    switch ((DisplayEditRamp)_editRamp) {
+      case EDIT_RAMP_TIERED:
+        if (heldMs >= EDIT_RAMP_TIER2_MS) {
+          return EDIT_RAMP_TIER2_FACTOR;
+        }
+        return (heldMs >= EDIT_RAMP_TIER1_MS) ? EDIT_RAMP_TIER1_FACTOR : 1;
+      case EDIT_RAMP_EXPONENTIAL: {
+        unsigned long doublings = heldMs / EDIT_RAMP_DOUBLING_MS;
+        uint16_t factor = 1;
+        while ((doublings-- > 0) && (factor < EDIT_RAMP_MAX_FACTOR)) {
+          factor <<= 1;
+        }
+        return factor;
+      }
+      default:
+        return 1;
+    }
   }
 
   void setPosition(int xPos, int yPos) {
@@ -104,28 +375,100 @@ public:
     }
     _xPos = xPos;
     _yPos = yPos;
+    invalidateBar();
+  }
+
+  /**********************************************************************/
+  /*!
+    @brief  Set the area covered by the widget on the display, from its position.
+    Widgets without a size (default) are not tracked in the menu damage region.
+    @param  width  width in pixels
+    @param  height height in pixels
+  */
+  /**********************************************************************/
+  void setSize(int width, int height) {
+    if ((width < 0) || (height < 0)) {
+      return;
+    }
+    _width = width;
+    _height = height;
+    invalidateBar();
   }
 
   int getXPostion() {return _xPos; }
   int getYPostion() {return _yPos; }
+  int getWidth() {return _width; }
+  int getHeight() {return _height; }
 
 private:
-  // widget position on the display
-  int _xPos = -1;
-  int _yPos = -1;
-
-  // widgets that store a changeable value
-  void *const _value; //  You can not store a function pointer in a void * pointer. This causes UB.
-  unsigned int _incrementSize;
-  int _valueCeiling;
-  int _valueFloor;
-
-  // widgets that trigger an action
-  bool _isEditable = 0;
-  int _activationParam = 0;
-  void (*_activationFct)() = NULL;   // Will need to have a single fct pointer for any parameters/return
-  void (*_paramActivationFct)(int) = NULL;
-  
+  // fields of the widget kind, see _kind
+  union {
+    struct {
+      void (*fct)();
+    } action;
+    struct {
+      void (*fct)(int);
+      int param;
+    } paramAction;
+    struct {
+      int *ptr;
+      int ceiling;
+      int floor;
+    } value;
+    struct {
+      const void *range;      // DisplayValueRange of type _valueType
+    } typedValue;
+    struct {
+      const void *range;      // same as typedValue
+      int16_t drawnExtent;    // fill length on the display, -1 if unknown
+      uint16_t drawnColor;    // frame color on the display
+      uint8_t direction;      // DisplayBarDirection
+    } bar;
+  } _data;
+
+  // widget area on the display
+  int16_t _xPos = -1;
+  int16_t _yPos = -1;
+  uint16_t _width = 0;
+  uint16_t _height = 0;
+
+  uint16_t _incrementSize = 0;  // value widgets only
+
+  uint8_t _kind : 3;            // DisplayWidgetKind
+  uint8_t _isSaturating : 1;
+  uint8_t _editRamp : 2;        // DisplayEditRamp
+  uint8_t _valueType : 3;       // DisplayValueType, typed value widgets only
+  uint8_t _isLowPriority : 1;
+
+  void _stepTypedValue(bool isIncrease, uint16_t multiplier)
+  {
+    const void *range = _data.typedValue.range;
+    switch ((DisplayValueType)_valueType) {
+      case VALUE_TYPE_UINT8:  displayValueStep(*(const DisplayValueRange<uint8_t> *)range, isIncrease, multiplier, _isSaturating); break;
+      case VALUE_TYPE_INT8:   displayValueStep(*(const DisplayValueRange<int8_t> *)range, isIncrease, multiplier, _isSaturating); break;
+      case VALUE_TYPE_UINT16: displayValueStep(*(const DisplayValueRange<uint16_t> *)range, isIncrease, multiplier, _isSaturating); break;
+      case VALUE_TYPE_INT16:  displayValueStep(*(const DisplayValueRange<int16_t> *)range, isIncrease, multiplier, _isSaturating); break;
+      case VALUE_TYPE_UINT32: displayValueStep(*(const DisplayValueRange<uint32_t> *)range, isIncrease, multiplier, _isSaturating); break;
+      case VALUE_TYPE_INT32:  displayValueStep(*(const DisplayValueRange<int32_t> *)range, isIncrease, multiplier, _isSaturating); break;
+      case VALUE_TYPE_FLOAT:  displayValueStep(*(const DisplayValueRange<float> *)range, isIncrease, multiplier, _isSaturating); break;
+    }
+  }
+};
+
+// RAM used per widget on 32 bit MCUs, large settings pages rely on it. The
+// host build checks it too, with a 32 bit syntax only compile of this header.
+#define DISPLAY_WIDGET_SIZE_BUDGET (24)
+static_assert((sizeof(void *) != 4) || (sizeof(DisplayWidget) <= DISPLAY_WIDGET_SIZE_BUDGET),
+              "DisplayWidget is over its RAM budget");
+
+// Storage for a widget built at run time (page stacks, virtual lists),
+// DisplayWidget has no default ctor
+struct DisplayWidgetSlot
+{
+  union {
+    DisplayWidget widget;
+  };
+  DisplayWidgetSlot() {}
 };
 
 #endif
\ No newline at end of file
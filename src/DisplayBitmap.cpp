@@ -0,0 +1,137 @@
+#include "DisplayBitmap.h"
+
+#define PACKBITS_MAX_RUN (128)
+#define PACKBITS_MIN_REPEAT (3)   // shorter repeats are cheaper inside a literal run
+#define PACKBITS_NOP (-128)
+
+//#######################################################################
+// DisplayPackedBitmap
+//#######################################################################
+
+uint16_t DisplayPackedBitmap::pack(const DisplayBitmap &bmp, unsigned char *out, uint16_t outSize)
+{
+  uint32_t srcSize = (uint32_t)bmp.getRowBytes() * bmp.height;
+  const unsigned char *src = bmp.bitmap;
+  uint32_t i = 0;
+  uint16_t outLen = 0;
+
+  while (i < srcSize) {
+    uint8_t b = DISPLAY_BITMAP_READ(&src[i]);
+    uint16_t run = 1;
+    while ((i + run < srcSize) && (run < PACKBITS_MAX_RUN) && (DISPLAY_BITMAP_READ(&src[i + run]) == b)) {
+      run++;
+    }
+
+    if (run >= PACKBITS_MIN_REPEAT) {
+      if (outLen + 2 > outSize) {
+        return 0;
+      }
+      out[outLen++] = (unsigned char)(int8_t)(1 - run);
+      out[outLen++] = b;
+      i += run;
+      continue;
+    }
+
+    // literal run, until the next repeat worth encoding
+    uint32_t start = i;
+    while ((i < srcSize) && (i - start < PACKBITS_MAX_RUN)) {
+      if ((i + 2 < srcSize) && (DISPLAY_BITMAP_READ(&src[i]) == DISPLAY_BITMAP_READ(&src[i + 1])) &&
+          (DISPLAY_BITMAP_READ(&src[i]) == DISPLAY_BITMAP_READ(&src[i + 2]))) {
+        break;
+      }
+      i++;
+    }
+    uint16_t len = i - start;
+    if (outLen + 1 + len > outSize) {
+      return 0;
+    }
+    out[outLen++] = len - 1;
+    for (uint16_t j = 0; j < len; j++) {
+      out[outLen++] = DISPLAY_BITMAP_READ(&src[start + j]);
+    }
+  }
+  return outLen;
+}
+
+//#######################################################################
+// DisplayBitmapDecoder
+//#######################################################################
+
+uint8_t DisplayBitmapDecoder::_nextByte()
+{
+  while (_runLeft == 0) {
+    int8_t header = (int8_t)DISPLAY_BITMAP_READ(_src++);
+    if (header >= 0) {
+      _runLeft = header + 1;
+      _isRepeatRun = false;
+    } else if (header != PACKBITS_NOP) {
+      _runLeft = 1 - header;
+      _isRepeatRun = true;
+      _repeatByte = DISPLAY_BITMAP_READ(_src++);
+    }
+  }
+  _runLeft--;
+  return _isRepeatRun ? _repeatByte : DISPLAY_BITMAP_READ(_src++);
+}
+
+void DisplayBitmapDecoder::restart()
+{
+  _src = _bmp.packed;
+  _row = 0;
+  _runLeft = 0;
+  _isRepeatRun = false;
+  _repeatByte = 0;
+}
+
+bool DisplayBitmapDecoder::nextRow(unsigned char *rowBytes)
+{
+  if (_row >= _bmp.height) {
+    return false;
+  }
+  uint16_t rowLen = _bmp.getRowBytes();
+  for (uint16_t i = 0; i < rowLen; i++) {
+    rowBytes[i] = _nextByte();
+  }
+  _row++;
+  return true;
+}
+
+bool DisplayBitmapDecoder::nextRowSpans(DisplaySpanFct spanFct, void *ctx)
+{
+  if (_row >= _bmp.height) {
+    return false;
+  }
+  uint16_t rowLen = _bmp.getRowBytes();
+  int32_t spanStart = -1;
+
+  for (uint16_t i = 0; i < rowLen; i++) {
+    uint8_t b = _nextByte();
+    uint16_t x = i * 8;
+
+    // whole byte continues the current state
+    if ((b == 0x00) && (spanStart < 0)) {
+      continue;
+    }
+    if ((b == 0xFF) && (spanStart >= 0)) {
+      continue;
+    }
+    for (uint8_t bit = 0; bit < 8; bit++, x++) {
+      bool isSet = (b & (0x80 >> bit)) != 0;
+      if (isSet && (spanStart < 0)) {
+        spanStart = x;
+      } else if (!isSet && (spanStart >= 0)) {
+        if ((uint32_t)spanStart < _bmp.width) {
+          uint16_t end = (x > _bmp.width) ? _bmp.width : x;
+          spanFct(spanStart, _row, end - spanStart, ctx);
+        }
+        spanStart = -1;
+      }
+    }
+  }
+  // close the span at the end of the row, padding bits are ignored
+  if ((spanStart >= 0) && ((uint32_t)spanStart < _bmp.width)) {
+    spanFct(spanStart, _row, _bmp.width - spanStart, ctx);
+  }
+  _row++;
+  return true;
+}
@@ -0,0 +1,57 @@
+#include "DisplayBlit.h"
+
+#include <string.h>
+
+#if defined(DISPLAY_BLIT_SSE2)
+#include <emmintrin.h>
+#endif
+
+#define PIXELS_PER_NIBBLE (4)
+#define READ_BITS(addr, isProgmem) ((isProgmem) ? DISPLAY_BITMAP_READ(addr) : *(addr))
+
+void DisplayBlit::setColors(uint16_t fgColor, uint16_t bgColor)
+{
+  _fgColor = fgColor;
+  _bgColor = bgColor;
+  for (uint8_t nibble = 0; nibble < 16; nibble++) {
+    uint16_t pixels[PIXELS_PER_NIBBLE];
+    for (uint8_t i = 0; i < PIXELS_PER_NIBBLE; i++) {
+      pixels[i] = (nibble & (0x08 >> i)) ? fgColor : bgColor;
+    }
+    // copied as bytes so pixel order in memory does not depend on endianness
+    memcpy(&_nibbleLut[nibble], pixels, sizeof(pixels));
+  }
+}
+
+void DisplayBlit::_expandRow(const unsigned char *bits, uint16_t width, uint16_t *line, bool isProgmem)
+{
+  uint16_t fullBytes = width / 8;
+  uint16_t i = 0;
+
+#if defined(DISPLAY_BLIT_SSE2)
+  const __m128i bitMasks = _mm_set_epi16(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80);
+  const __m128i fg = _mm_set1_epi16(_fgColor);
+  const __m128i bg = _mm_set1_epi16(_bgColor);
+  for (; i < fullBytes; i++) {
+    __m128i b = _mm_set1_epi16(bits[i]);
+    __m128i isSet = _mm_cmpeq_epi16(_mm_and_si128(b, bitMasks), bitMasks);
+    __m128i px = _mm_or_si128(_mm_and_si128(isSet, fg), _mm_andnot_si128(isSet, bg));
+    _mm_storeu_si128((__m128i *)&line[i * 8], px);
+  }
+#else
+  for (; i < fullBytes; i++) {
+    uint8_t b = READ_BITS(&bits[i], isProgmem);
+    memcpy(&line[i * 8], &_nibbleLut[b >> 4], sizeof(uint64_t));
+    memcpy(&line[i * 8 + PIXELS_PER_NIBBLE], &_nibbleLut[b & 0x0F], sizeof(uint64_t));
+  }
+#endif
+
+  // last pixels of a row that does not end on a byte boundary
+  uint16_t x = fullBytes * 8;
+  if (x < width) {
+    uint8_t b = READ_BITS(&bits[fullBytes], isProgmem);
+    for (uint8_t bit = 0; x < width; bit++, x++) {
+      line[x] = (b & (0x80 >> bit)) ? _fgColor : _bgColor;
+    }
+  }
+}
@@ -0,0 +1,142 @@
+#include "DisplayFlushPipeline.h"
+
+//#######################################################################
+// Private functions
+//#######################################################################
+
+void DisplayFlushPipeline::_collect(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t *pixels,
+                                    uint16_t stride, void *ctx)
+{
+  (void)stride;
+  DisplayFlushPipeline *pipeline = (DisplayFlushPipeline *)ctx;
+  uint8_t idx = pipeline->_drawIdx;
+  Job &job = pipeline->_jobs[idx];
+
+  // too many rects for one job: send what is collected and wait, the buffer is not drawn into meanwhile
+  if (job.rectNb >= DISPLAY_PIPELINE_MAX_RECTS) {
+    pipeline->_submit(idx);
+    pipeline->_waitFree(idx);
+  }
+  DisplayRect r = {x, y, w, h};
+  job.rects[job.rectNb] = r;
+  job.pixels[job.rectNb] = pixels;
+  job.rectNb++;
+}
+
+void DisplayFlushPipeline::_submit(uint8_t jobIdx)
+{
+  Job &job = _jobs[jobIdx];
+  if (job.rectNb == 0) {
+    return;
+  }
+  job.sentNb = 0;
+  __atomic_store_n(&job.state, (uint8_t)JOB_PENDING, __ATOMIC_RELEASE);
+  _kick();
+}
+
+void DisplayFlushPipeline::_waitFree(uint8_t jobIdx)
+{
+  while (__atomic_load_n(&_jobs[jobIdx].state, __ATOMIC_ACQUIRE) != JOB_FREE) {
+    _wait();
+  }
+  _jobs[jobIdx].rectNb = 0;
+}
+
+void DisplayFlushPipeline::_wait()
+{
+  if (_waitFct != NULL) {
+    _waitFct(_waitCtx);
+  } else {
+    yield();
+  }
+}
+
+int8_t DisplayFlushPipeline::_findPending()
+{
+  // the main loop waits for a buffer to be free before drawing into it,
+  // so there is at most one pending job
+  for (uint8_t i = 0; i < DISPLAY_PIPELINE_BUFFER_NB; i++) {
+    if (__atomic_load_n(&_jobs[i].state, __ATOMIC_ACQUIRE) == JOB_PENDING) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void DisplayFlushPipeline::_kick()
+{
+  // whichever side takes the bus starts the pending job
+  uint8_t expected = 0;
+  if (!__atomic_compare_exchange_n(&_isBusSending, &expected, (uint8_t)1, false, __ATOMIC_ACQ_REL,
+                                   __ATOMIC_ACQUIRE)) {
+    return;
+  }
+  int8_t idx = _findPending();
+  if (idx < 0) {
+    __atomic_store_n(&_isBusSending, (uint8_t)0, __ATOMIC_RELEASE);
+    // a job may have been submitted between the check and the release
+    if (_findPending() >= 0) {
+      _kick();
+    }
+    return;
+  }
+  _sendIdx = idx;
+  __atomic_store_n(&_jobs[idx].state, (uint8_t)JOB_SENDING, __ATOMIC_RELAXED);
+  _sendNextRect(_jobs[idx]);
+}
+
+void DisplayFlushPipeline::_sendNextRect(Job &job)
+{
+  const DisplayRect &r = job.rects[job.sentNb];
+  _sendFct(r.x, r.y, r.w, r.h, job.pixels[job.sentNb], _fb.getWidth(), _sendCtx);
+}
+
+//#######################################################################
+// Public functions
+//#######################################################################
+
+DisplayFlushPipeline::DisplayFlushPipeline(DisplayFramebuffer &fb, uint16_t *secondBuffer, DisplayAsyncSendFct sendFct,
+                                           void *ctx)
+    : _fb(fb), _sendFct(sendFct), _sendCtx(ctx)
+{
+  _buffers[0] = fb.getBuffer();
+  _buffers[1] = secondBuffer;
+  for (uint8_t i = 0; i < DISPLAY_PIPELINE_BUFFER_NB; i++) {
+    _jobs[i].rectNb = 0;
+    _jobs[i].sentNb = 0;
+    _jobs[i].state = JOB_FREE;
+  }
+}
+
+uint32_t DisplayFlushPipeline::submitBand()
+{
+  uint32_t pixelNb = _fb.flush(_collect, this);
+  _submit(_drawIdx);
+
+  _drawIdx = (_drawIdx + 1) % DISPLAY_PIPELINE_BUFFER_NB;
+  _waitFree(_drawIdx);
+  _fb.setBuffer(_buffers[_drawIdx]);
+  return pixelNb;
+}
+
+void DisplayFlushPipeline::transferDone()
+{
+  Job &job = _jobs[_sendIdx];
+  job.sentNb++;
+  if (job.sentNb < job.rectNb) {
+    _sendNextRect(job);
+    return;
+  }
+  __atomic_store_n(&job.state, (uint8_t)JOB_FREE, __ATOMIC_RELEASE);
+  __atomic_store_n(&_isBusSending, (uint8_t)0, __ATOMIC_RELEASE);
+  _kick();
+}
+
+void DisplayFlushPipeline::waitIdle()
+{
+  for (uint8_t i = 0; i < DISPLAY_PIPELINE_BUFFER_NB; i++) {
+    while (__atomic_load_n(&_jobs[i].state, __ATOMIC_ACQUIRE) != JOB_FREE) {
+      _wait();
+    }
+  }
+}
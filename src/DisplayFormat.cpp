@@ -0,0 +1,142 @@
+#include "DisplayFormat.h"
+
+#include <math.h>
+
+//#######################################################################
+// Private functions
+//#######################################################################
+
+static uint8_t formatMagnitude(bool isNegative, uint32_t magnitude, const DisplayValueFormat &format, char *text,
+                               uint8_t textSize)
+{
+  char digits[DISPLAY_FORMAT_NUMBER_LEN];
+  uint8_t digitNb = 0;
+  uint8_t decimals = (format.decimals < 10) ? format.decimals : 9;
+  char padChar = (format.padChar == '\0') ? ' ' : format.padChar;
+
+  // zeros after the digits would change the value
+  if (!format.isRightAligned && (padChar == '0')) {
+    padChar = ' ';
+  }
+
+  // at least one digit before the point
+  do {
+    if ((digitNb == decimals) && (decimals > 0)) {
+      digits[digitNb++] = '.';
+    }
+    digits[digitNb++] = '0' + (magnitude % 10);
+    magnitude /= 10;
+  } while ((magnitude > 0) || (digitNb <= decimals));
+
+  uint8_t unitLen = 0;
+  if (format.unit != NULL) {
+    while (format.unit[unitLen] != '\0') {
+      unitLen++;
+    }
+  }
+  uint8_t len = digitNb + (isNegative ? 1 : 0) + unitLen;
+  uint8_t padNb = (format.width > len) ? format.width - len : 0;
+  if ((uint16_t)len + padNb + 1 > textSize) {
+    if (textSize > 0) {
+      text[0] = '\0';
+    }
+    return 0;
+  }
+
+  uint8_t pos = 0;
+  if (format.isRightAligned && (padChar != '0')) {
+    while (padNb > 0) {
+      text[pos++] = padChar;
+      padNb--;
+    }
+  }
+  if (isNegative) {
+    text[pos++] = '-';
+  }
+  if (format.isRightAligned) {
+    // zeros go after the sign
+    while (padNb > 0) {
+      text[pos++] = padChar;
+      padNb--;
+    }
+  }
+  while (digitNb > 0) {
+    text[pos++] = digits[--digitNb];
+  }
+  for (uint8_t i = 0; i < unitLen; i++) {
+    text[pos++] = format.unit[i];
+  }
+  while (padNb > 0) {
+    text[pos++] = padChar;
+    padNb--;
+  }
+  text[pos] = '\0';
+  return pos;
+}
+
+static uint8_t formatNan(const DisplayValueFormat &format, char *text, uint8_t textSize)
+{
+  static const char nanText[] = "nan";
+  uint8_t len = sizeof(nanText) - 1;
+  uint8_t padNb = (format.width > len) ? format.width - len : 0;
+  if ((uint16_t)len + padNb + 1 > textSize) {
+    if (textSize > 0) {
+      text[0] = '\0';
+    }
+    return 0;
+  }
+
+  uint8_t pos = 0;
+  if (format.isRightAligned) {
+    while (padNb > 0) {
+      text[pos++] = ' ';
+      padNb--;
+    }
+  }
+  for (uint8_t i = 0; i < len; i++) {
+    text[pos++] = nanText[i];
+  }
+  while (padNb > 0) {
+    text[pos++] = ' ';
+    padNb--;
+  }
+  text[pos] = '\0';
+  return pos;
+}
+
+//#######################################################################
+// Public functions
+//#######################################################################
+
+uint8_t displayFormatInt(int32_t value, const DisplayValueFormat &format, char *text, uint8_t textSize)
+{
+  uint32_t magnitude = (value < 0) ? (uint32_t)(-(value + 1)) + 1 : (uint32_t)value;
+  return formatMagnitude(value < 0, magnitude, format, text, textSize);
+}
+
+uint8_t displayFormatUInt(uint32_t value, const DisplayValueFormat &format, char *text, uint8_t textSize)
+{
+  return formatMagnitude(false, value, format, text, textSize);
+}
+
+uint8_t displayFormatFloat(float value, const DisplayValueFormat &format, char *text, uint8_t textSize)
+{
+  if (isnan(value)) {
+    return formatNan(format, text, textSize);   // no integer for it, the cast below would be undefined
+  }
+  float scaled = value;
+  for (uint8_t i = 0; (i < format.decimals) && (i < 9); i++) {
+    scaled *= 10;
+  }
+  scaled += (scaled < 0) ? -0.5f : 0.5f;
+  int32_t raw;
+  if (scaled >= 2147483647.0f) {
+    raw = INT32_MAX;
+  } else if (scaled <= -2147483648.0f) {
+    raw = INT32_MIN;
+  } else {
+    raw = (int32_t)scaled;
+  }
+  // -0.001 with 2 decimals is printed 0.00, not -0.00
+  return displayFormatInt(raw, format, text, textSize);
+}
@@ -0,0 +1,212 @@
+#include "DisplayFramebuffer.h"
+
+//#######################################################################
+// Private functions
+//#######################################################################
+
+bool DisplayFramebuffer::_clip(int16_t &x, int16_t &y, int16_t &w, int16_t &h)
+{
+  int32_t x1 = (int32_t)x + w;
+  int32_t y1 = (int32_t)y + h;
+  int32_t bandEnd = (int32_t)_bandY + _bandHeight;
+
+  if (x < 0) x = 0;
+  if (y < (int32_t)_bandY) y = _bandY;
+  if (x1 > _width) x1 = _width;
+  if (y1 > bandEnd) y1 = bandEnd;
+  if (y1 > _height) y1 = _height;
+
+  if ((x1 <= x) || (y1 <= y)) {
+    return false;
+  }
+  w = x1 - x;
+  h = y1 - y;
+  return true;
+}
+
+void DisplayFramebuffer::_touchClipped(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+  uint16_t tx0 = x / _tileSize;
+  uint16_t tx1 = (x + w - 1) / _tileSize;
+  uint16_t ty0 = y / _tileSize;
+  uint16_t ty1 = (y + h - 1) / _tileSize;
+
+  for (uint16_t ty = ty0; ty <= ty1; ty++) {
+    for (uint16_t tx = tx0; tx <= tx1; tx++) {
+      uint16_t idx = ty * _tilesPerRow + tx;
+      _touchedTiles[idx >> 3] |= (1 << (idx & 7));
+    }
+  }
+}
+
+void DisplayFramebuffer::_drawSpan(uint16_t x, uint16_t y, uint16_t len, void *ctx)
+{
+  DisplayFramebuffer *fb = (DisplayFramebuffer *)ctx;
+  fb->drawFastHLine(fb->_spanX + x, fb->_spanY + y, len, fb->_spanColor);
+}
+
+//#######################################################################
+// Public functions
+//#######################################################################
+
+DisplayFramebuffer::DisplayFramebuffer(uint16_t *buffer, uint16_t width, uint16_t height, uint16_t bandHeight,
+                                       uint16_t tileSize)
+    : _buffer(buffer), _width(width), _height(height)
+{
+  _bandHeight = ((bandHeight == 0) || (bandHeight > height)) ? height : bandHeight;
+  _tileSize = (tileSize == 0) ? FRAMEBUFFER_DFLT_TILE_SIZE : tileSize;
+  while ((uint32_t)((_width + _tileSize - 1) / _tileSize) * ((_height + _tileSize - 1) / _tileSize) > FRAMEBUFFER_MAX_TILES_NB) {
+    _tileSize *= 2;
+  }
+  _tilesPerRow = (_width + _tileSize - 1) / _tileSize;
+  memset(_touchedTiles, 0, sizeof(_touchedTiles));
+}
+
+void DisplayFramebuffer::startBand()
+{
+  _bandY = 0;
+}
+
+bool DisplayFramebuffer::nextBand()
+{
+  if ((uint32_t)_bandY + _bandHeight >= _height) {
+    return false;
+  }
+  _bandY += _bandHeight;
+  return true;
+}
+
+void DisplayFramebuffer::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  if ((x < 0) || (x >= _width) || (y < (int32_t)_bandY) || (y >= (int32_t)_bandY + _bandHeight) || (y >= _height)) {
+    return;
+  }
+  *_pixelAt(x, y) = color;
+  _touchClipped(x, y, 1, 1);
+}
+
+void DisplayFramebuffer::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  if ((w <= 0) || (h <= 0)) {
+    return;
+  }
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y, h, color);
+  drawFastVLine(x + w - 1, y, h, color);
+}
+
+void DisplayFramebuffer::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  if (!_clip(x, y, w, h)) {
+    return;
+  }
+  uint16_t *row = _pixelAt(x, y);
+  for (int16_t j = 0; j < h; j++) {
+    for (int16_t i = 0; i < w; i++) {
+      row[i] = color;
+    }
+    row += _width;
+  }
+  _touchClipped(x, y, w, h);
+}
+
+void DisplayFramebuffer::drawBitmap(int16_t x, int16_t y, const DisplayBitmap &bmp, uint16_t color,
+                                    uint16_t bgColor, bool transparent)
+{
+  int16_t cx = x, cy = y, cw = bmp.width, ch = bmp.height;
+  if (!_clip(cx, cy, cw, ch)) {
+    return;
+  }
+  uint16_t bytesPerRow = (bmp.width + 7) / 8;
+
+  if (!transparent && (cx == x)) {
+    if ((_blit.getFgColor() != color) || (_blit.getBgColor() != bgColor)) {
+      _blit.setColors(color, bgColor);
+    }
+    for (int16_t j = cy; j < cy + ch; j++) {
+      _blit.expandRow(&bmp.bitmap[(uint32_t)(j - y) * bytesPerRow], cw, _pixelAt(cx, j));
+    }
+    _touchClipped(cx, cy, cw, ch);
+    return;
+  }
+
+  for (int16_t j = cy; j < cy + ch; j++) {
+    const unsigned char *bits = &bmp.bitmap[(uint32_t)(j - y) * bytesPerRow];
+    uint16_t *row = _pixelAt(0, j);
+    for (int16_t i = cx; i < cx + cw; i++) {
+      uint16_t bit = i - x;
+      if (DISPLAY_BITMAP_READ(&bits[bit >> 3]) & (0x80 >> (bit & 7))) {
+        row[i] = color;
+      } else if (!transparent) {
+        row[i] = bgColor;
+      }
+    }
+  }
+  _touchClipped(cx, cy, cw, ch);
+}
+
+void DisplayFramebuffer::drawBitmap(int16_t x, int16_t y, const DisplayPackedBitmap &bmp, uint16_t color)
+{
+  // rows are packed as one stream, rows above the band still have to be decoded
+  if ((y >= (int32_t)_bandY + _bandHeight) || (y + (int32_t)bmp.height <= _bandY)) {
+    return;
+  }
+  _spanX = x;
+  _spanY = y;
+  _spanColor = color;
+  DisplayBitmapDecoder decoder(bmp);
+  while ((y + decoder.getRow() < (int32_t)_bandY + _bandHeight) && decoder.nextRowSpans(_drawSpan, this)) {
+  }
+}
+
+void DisplayFramebuffer::touch(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+  if (_clip(x, y, w, h)) {
+    _touchClipped(x, y, w, h);
+  }
+}
+
+bool DisplayFramebuffer::isTileTouched(uint16_t tileX, uint16_t tileY)
+{
+  uint16_t idx = tileY * _tilesPerRow + tileX;
+  return (_touchedTiles[idx >> 3] & (1 << (idx & 7))) != 0;
+}
+
+uint32_t DisplayFramebuffer::flush(DisplayFlushFct flushFct, void *ctx)
+{
+  uint32_t sentPixels = 0;
+  uint16_t bandEnd = ((uint32_t)_bandY + _bandHeight > _height) ? _height : _bandY + _bandHeight;
+  uint16_t ty0 = _bandY / _tileSize;
+  uint16_t ty1 = (bandEnd - 1) / _tileSize;
+
+  for (uint16_t ty = ty0; ty <= ty1; ty++) {
+    // part of the tile row that lies in the current band
+    uint16_t y0 = ty * _tileSize;
+    uint16_t y1 = y0 + _tileSize;
+    if (y0 < _bandY) y0 = _bandY;
+    if (y1 > bandEnd) y1 = bandEnd;
+
+    uint16_t tx = 0;
+    while (tx < _tilesPerRow) {
+      if (!isTileTouched(tx, ty)) {
+        tx++;
+        continue;
+      }
+      // send consecutive touched tiles as a single rectangle
+      uint16_t spanStart = tx;
+      while ((tx < _tilesPerRow) && isTileTouched(tx, ty)) {
+        uint16_t idx = ty * _tilesPerRow + tx;
+        _touchedTiles[idx >> 3] &= ~(1 << (idx & 7));
+        tx++;
+      }
+      uint16_t x0 = spanStart * _tileSize;
+      uint16_t x1 = ((uint32_t)tx * _tileSize > _width) ? _width : tx * _tileSize;
+      if (flushFct != NULL) {
+        flushFct(x0, y0, x1 - x0, y1 - y0, _pixelAt(x0, y0), _width, ctx);
+      }
+      sentPixels += (uint32_t)(x1 - x0) * (y1 - y0);
+    }
+  }
+  return sentPixels;
+}
@@ -0,0 +1,146 @@
+#include "DisplayGlyphCache.h"
+#include "DisplayMenu.h"
+#include <string.h>
+
+// Columns of the Adafruit_GFX classic font for GLYPH_CACHE_CHARS, LSB is the top row
+static const unsigned char glyphFont[GLYPH_CACHE_GLYPH_NB][5]
+#if defined(__AVR__)
+    PROGMEM
+#endif
+    = {
+        {0x3E, 0x51, 0x49, 0x45, 0x3E},   // 0
+        {0x00, 0x42, 0x7F, 0x40, 0x00},   // 1
+        {0x72, 0x49, 0x49, 0x49, 0x46},   // 2
+        {0x21, 0x41, 0x49, 0x4D, 0x33},   // 3
+        {0x18, 0x14, 0x12, 0x7F, 0x10},   // 4
+        {0x27, 0x45, 0x45, 0x45, 0x39},   // 5
+        {0x3C, 0x4A, 0x49, 0x49, 0x31},   // 6
+        {0x41, 0x21, 0x11, 0x09, 0x07},   // 7
+        {0x36, 0x49, 0x49, 0x49, 0x36},   // 8
+        {0x46, 0x49, 0x49, 0x29, 0x1E},   // 9
+        {0x08, 0x08, 0x08, 0x08, 0x08},   // -
+        {0x08, 0x08, 0x3E, 0x08, 0x08},   // +
+        {0x00, 0x60, 0x60, 0x00, 0x00},   // .
+        {0x00, 0x00, 0x00, 0x00, 0x00},   // space
+        {0x23, 0x13, 0x08, 0x64, 0x62},   // %
+        {0x1F, 0x20, 0x40, 0x20, 0x1F},   // V
+        {0x7C, 0x12, 0x11, 0x12, 0x7C},   // A
+        {0x3E, 0x41, 0x41, 0x41, 0x22},   // C
+        {0x7C, 0x04, 0x18, 0x04, 0x78},   // m
+        {0x48, 0x54, 0x54, 0x54, 0x24},   // s
+};
+
+//#######################################################################
+// Private functions
+//#######################################################################
+
+int8_t DisplayGlyphCache::_glyphIdx(char c)
+{
+  if ((c >= '0') && (c <= '9')) {
+    return c - '0';
+  }
+  const char *chars = GLYPH_CACHE_CHARS;
+  for (int8_t i = 10; i < GLYPH_CACHE_GLYPH_NB; i++) {
+    if (chars[i] == c) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int8_t DisplayGlyphCache::_stateIdx(uint16_t color)
+{
+  for (int8_t i = 0; i < GLYPH_CACHE_STATE_NB; i++) {
+    if (_blits[i].getFgColor() == color) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+//#######################################################################
+// Public functions
+//#######################################################################
+
+bool DisplayGlyphCache::build(uint8_t textSize, const uint16_t colors[GLYPH_CACHE_STATE_NB], uint16_t bgColor)
+{
+  _textSize = 0;
+  if ((textSize == 0) || (textSize > GLYPH_CACHE_MAX_TEXT_SIZE)) {
+    return false;
+  }
+  uint16_t cellW = GLYPH_CACHE_CHAR_WIDTH * textSize;
+  uint16_t cellH = GLYPH_CACHE_CHAR_HEIGHT * textSize;
+
+  memset(_glyphs, 0, sizeof(_glyphs));
+  for (uint8_t g = 0; g < GLYPH_CACHE_GLYPH_NB; g++) {
+    for (uint16_t py = 0; py < cellH; py++) {
+      uint8_t *row = &_glyphs[g][py * GLYPH_CACHE_ROW_BYTES];
+      for (uint16_t px = 0; px < cellW; px++) {
+        uint8_t col = px / textSize;
+        // 6th column is the spacing between characters
+        if ((col < 5) && (DISPLAY_BITMAP_READ(&glyphFont[g][col]) & (1 << (py / textSize)))) {
+          row[px >> 3] |= 0x80 >> (px & 7);
+        }
+      }
+    }
+  }
+  for (uint8_t i = 0; i < GLYPH_CACHE_STATE_NB; i++) {
+    _blits[i].setColors(colors[i], bgColor);
+  }
+  _textSize = textSize;
+  return true;
+}
+
+bool DisplayGlyphCache::build(DisplayMenu &menu, uint8_t textSize)
+{
+  uint16_t colors[GLYPH_CACHE_STATE_NB] = {menu.getIdleColor(), menu.getTargetColor(), menu.getEditingColor()};
+  return build(textSize, colors, menu.getBackgroundColor());
+}
+
+bool DisplayGlyphCache::canDraw(const char *text, uint16_t color)
+{
+  if ((_textSize == 0) || (_stateIdx(color) < 0)) {
+    return false;
+  }
+  uint8_t len = 0;
+  for (; *text != '\0'; text++, len++) {
+    if ((len >= GLYPH_CACHE_MAX_CHARS) || (_glyphIdx(*text) < 0)) {
+      return false;
+    }
+  }
+  return len > 0;
+}
+
+bool DisplayGlyphCache::drawText(int16_t x, int16_t y, const char *text, uint16_t color, DisplayFlushFct pushFct,
+                                 void *ctx)
+{
+  if (!canDraw(text, color) || (pushFct == NULL)) {
+    return false;
+  }
+  DisplayBlit &blit = _blits[_stateIdx(color)];
+  uint16_t cellW = getCharWidth();
+  uint16_t cellH = getCharHeight();
+  uint8_t len = strlen(text);
+  uint16_t width = len * cellW;
+  int8_t glyphs[GLYPH_CACHE_MAX_CHARS];
+  for (uint8_t i = 0; i < len; i++) {
+    glyphs[i] = _glyphIdx(text[i]);
+  }
+
+  for (uint16_t stripY = 0; stripY < cellH; stripY += GLYPH_CACHE_STRIP_ROWS) {
+    uint16_t rowNb = (cellH - stripY < GLYPH_CACHE_STRIP_ROWS) ? cellH - stripY : GLYPH_CACHE_STRIP_ROWS;
+    for (uint16_t j = 0; j < rowNb; j++) {
+      uint16_t *line = &_strip[j * width];
+      if ((j > 0) && ((stripY + j) % _textSize != 0)) {
+        // scaled font row, same pixels as the previous one
+        memcpy(line, line - width, width * sizeof(uint16_t));
+        continue;
+      }
+      for (uint8_t i = 0; i < len; i++) {
+        blit.expandRamRow(&_glyphs[glyphs[i]][(stripY + j) * GLYPH_CACHE_ROW_BYTES], cellW, &line[i * cellW]);
+      }
+    }
+    pushFct(x, y + stripY, width, rowNb, _strip, width, ctx);
+  }
+  return true;
+}
@@ -1,8 +1,5 @@
 #include "DisplayMenu.h"
 
-#define X_COORD_INDEX (0)
-#define Y_COORD_INDEX (1)
-
 //#######################################################################
 // Private functions
 //#######################################################################
@@ -25,10 +22,274 @@ void DisplayMenu::_updateTarget()
 }
 
 void DisplayMenu::_moveCursor(uint8_t dim, int amount) {
+    if (_navTable != NULL) {
+        _moveNavCursor(dim, amount);
+        return;
+    }
+    if ((_rowProvider != NULL) && (dim == Y_COORD_INDEX)) {
+        _moveListCursor(amount);
+        return;
+    }
+    markWidgetDirty(_targetIdx); // previous target goes back to idle color
     _cursorPos[dim] += amount;
     _encloseCursor();
     _updateTarget();
-    delay(1); // for debug
+    markWidgetDirty(_targetIdx);
+}
+
+void DisplayMenu::_moveNavCursor(uint8_t dim, int amount)
+{
+  DisplayInput dir;
+  if (dim == Y_COORD_INDEX) {
+    dir = (amount < 0) ? DISPLAY_INPUT_UP : DISPLAY_INPUT_DOWN;
+  } else {
+    dir = (amount < 0) ? DISPLAY_INPUT_LEFT : DISPLAY_INPUT_RIGHT;
+  }
+  uint32_t steps = (amount < 0) ? -(int32_t)amount : amount;
+  uint16_t idx = _targetIdx;
+
+  markWidgetDirty(_targetIdx);
+  // neighbors are strictly further in the direction, a chain ends on a widget pointing to itself
+  while (steps-- > 0) {
+    uint16_t next = DisplayNavTable::getNeighbor(_navTable, _isNavTableProgmem, idx, dir);
+    if (next == idx) {
+      break;
+    }
+    idx = next;
+  }
+  _targetIdx = idx;
+  _cursorPos[X_COORD_INDEX] = 0;
+  _cursorPos[Y_COORD_INDEX] = idx;
+  markWidgetDirty(_targetIdx);
+}
+
+void DisplayMenu::_moveListCursor(int amount)
+{
+  int64_t item = (int64_t)_listFirstItem + _cursorPos[Y_COORD_INDEX] + amount;
+  uint16_t rowNb = _mapDimensions[Y_COORD_INDEX];
+
+  // same wrapping as _encloseCursor(): out of the list goes back to the first item
+  if ((item < 0) || (item >= (int64_t)_listItemNb)) {
+    item = 0;
+  }
+  markWidgetDirty(_targetIdx);
+  if (item < _listFirstItem) {
+    _scrollList(item);
+  } else if (item >= (int64_t)_listFirstItem + rowNb) {
+    _scrollList(item - rowNb + 1);
+  }
+  _cursorPos[Y_COORD_INDEX] = item - _listFirstItem;
+  _updateTarget();
+  markWidgetDirty(_targetIdx);
+}
+
+void DisplayMenu::_scrollList(uint32_t firstItem)
+{
+  uint16_t rowNb = _mapDimensions[Y_COORD_INDEX];
+
+  if ((firstItem > _listFirstItem) && (firstItem - _listFirstItem < rowNb)) {
+    // rows still visible move up, only the entering ones are built
+    uint16_t shift = firstItem - _listFirstItem;
+    for (uint16_t row = 0; row + shift < rowNb; row++) {
+      _moveListRow(row + shift, row);
+    }
+    _listFirstItem = firstItem;
+    for (uint16_t row = rowNb - shift; row < rowNb; row++) {
+      _loadListRow(row);
+    }
+  } else if ((firstItem < _listFirstItem) && (_listFirstItem - firstItem < rowNb)) {
+    uint16_t shift = _listFirstItem - firstItem;
+    for (uint16_t row = rowNb - 1; row >= shift; row--) {
+      _moveListRow(row - shift, row);
+    }
+    _listFirstItem = firstItem;
+    for (uint16_t row = 0; row < shift; row++) {
+      _loadListRow(row);
+    }
+  } else {
+    _listFirstItem = firstItem;
+    for (uint16_t row = 0; row < rowNb; row++) {
+      _loadListRow(row);
+    }
+  }
+  markAllWidgetsDirty();
+  _pageChangeNb++;   // rows hold other items
+}
+
+void DisplayMenu::_loadListRow(uint16_t viewRow)
+{
+  DisplayWidget wdg = _rowProvider(_listFirstItem + viewRow, viewRow, _rowProviderCtx);
+  memcpy(&_listRows[viewRow].widget, &wdg, sizeof(DisplayWidget));
+}
+
+void DisplayMenu::_moveListRow(uint16_t fromRow, uint16_t toRow)
+{
+  // the item moves to another row, the geometry belongs to the row
+  DisplayWidget &dst = _listRows[toRow].widget;
+  int16_t x = dst.getXPostion();
+  int16_t y = dst.getYPostion();
+  uint16_t w = dst.getWidth();
+  uint16_t h = dst.getHeight();
+  memcpy(&dst, &_listRows[fromRow].widget, sizeof(DisplayWidget));
+  dst.setPosition(x, y);
+  dst.setSize(w, h);
+}
+
+bool DisplayMenu::_prepareMove(bool isSideKey, bool isIncrease, uint16_t editSteps, uint16_t editMultiplier)
+{
+  if (_menuWidgets == NULL)
+    return false;
+  _isChanged = true;
+  if (!_isEditingTarget)
+  {
+    return true;
+  }
+  if (isSideKey == _editsFromSides)
+  {
+    for (uint16_t i = 0; i < editSteps; i++)
+    {
+      if (isIncrease)
+      {
+        _menuWidgets[_targetIdx].increment(editMultiplier);
+      }
+      else
+      {
+        _menuWidgets[_targetIdx].decrement(editMultiplier);
+      }
+    }
+    markWidgetDirty(_targetIdx);
+    if ((editSteps > 0) && (_valueEditFct != NULL))
+    {
+      _valueEditFct(_menuWidgets[_targetIdx], _valueEditCtx);
+    }
+  }
+  return false;
+}
+
+void DisplayMenu::_applyKey(DisplayInput key, uint16_t editMultiplier)
+{
+  switch (key)
+  {
+  case DISPLAY_INPUT_UP:
+    if (_prepareMove(false, true, 1, editMultiplier))
+      _moveCursor(Y_COORD_INDEX, -1);
+    break;
+  case DISPLAY_INPUT_DOWN:
+    if (_prepareMove(false, false, 1, editMultiplier))
+      _moveCursor(Y_COORD_INDEX, 1);
+    break;
+  case DISPLAY_INPUT_LEFT:
+    if (_prepareMove(true, false, 1, editMultiplier))
+      _moveCursor(X_COORD_INDEX, -1);
+    break;
+  case DISPLAY_INPUT_RIGHT:
+    if (_prepareMove(true, true, 1, editMultiplier))
+      _moveCursor(X_COORD_INDEX, 1);
+    break;
+  case DISPLAY_INPUT_INTERACT:
+    interact();
+    break;
+  default:
+    break;
+  }
+}
+
+bool DisplayMenu::_applyMoveRun(DisplayInput input, uint32_t steps)
+{
+  // down and right move the cursor forward, up and right increase edited values
+  bool isSideKey = (input == DISPLAY_INPUT_LEFT) || (input == DISPLAY_INPUT_RIGHT);
+  bool isForward = (input == DISPLAY_INPUT_DOWN) || (input == DISPLAY_INPUT_RIGHT);
+  bool isIncrease = (input == DISPLAY_INPUT_UP) || (input == DISPLAY_INPUT_RIGHT);
+  uint8_t dim = isSideKey ? X_COORD_INDEX : Y_COORD_INDEX;
+
+  if ((input >= DISPLAY_INPUT_INTERACT) || (steps == 0))
+  {
+    return false;
+  }
+  while (steps > 0)
+  {
+    uint16_t chunk = (steps > INT16_MAX) ? INT16_MAX : steps;
+    if (!_prepareMove(isSideKey, isIncrease, chunk))
+    {
+      steps -= chunk;   // edited step by step, or no move while editing
+      continue;
+    }
+    // Moving back stops on the first widget, as single moves do. Moving
+    // forward past the last widget wraps to the first one, the remaining
+    // steps then go around again (nav tables do not wrap).
+    if (isForward && (_navTable == NULL))
+    {
+      bool isList = (_rowProvider != NULL) && (dim == Y_COORD_INDEX);
+      uint32_t posNb = isList ? _listItemNb : _mapDimensions[dim];
+      uint32_t pos = isList ? _listFirstItem + _cursorPos[dim] : _cursorPos[dim];
+      uint32_t room = posNb - 1 - pos;
+      if (chunk > room)
+      {
+        _moveCursor(dim, chunk);   // lands on the first widget
+        steps = (steps - room - 1) % posNb;
+        continue;
+      }
+    }
+    _moveCursor(dim, isForward ? chunk : -chunk);
+    steps -= chunk;
+  }
+  return true;
+}
+
+uint16_t DisplayMenu::_getDirtyTrackedNb()
+{
+  uint16_t nb = getWidgetNb();
+  return (nb > MAX_WIDGETS_NB) ? MAX_WIDGETS_NB : nb;
+}
+
+void DisplayMenu::_addWidgetDamage(uint16_t widgetIdx)
+{
+  if (_menuWidgets == NULL) {
+    return;
+  }
+  DisplayWidget &wdg = _menuWidgets[widgetIdx];
+  if ((wdg.getXPostion() < 0) || (wdg.getYPostion() < 0)) {
+    return;
+  }
+  _damage.add(wdg.getXPostion(), wdg.getYPostion(), wdg.getWidth(), wdg.getHeight());
+}
+
+int16_t DisplayMenu::_nextScheduledWidget(uint16_t fromIdx)
+{
+  if ((_frameBudgetUs == 0) || (_menuWidgets == NULL)) {
+    return nextDirtyWidget(fromIdx);
+  }
+  int16_t idx = fromIdx;
+  if (!_isPrintingLowPriority) {
+    while (((idx = nextDirtyWidget(idx)) != NO_DIRTY_WIDGET) && _menuWidgets[idx].isLowPriority()) {
+      idx++;
+    }
+    if (idx != NO_DIRTY_WIDGET) {
+      return idx;
+    }
+    // second pass for the low priority widgets
+    _isPrintingLowPriority = true;
+    idx = 0;
+  }
+  while (((idx = nextDirtyWidget(idx)) != NO_DIRTY_WIDGET) && !_menuWidgets[idx].isLowPriority()) {
+    idx++;
+  }
+  if (idx == NO_DIRTY_WIDGET) {
+    return NO_DIRTY_WIDGET;
+  }
+  if (_hasPrintedLowPriority && (micros() - _printStartUs >= _frameBudgetUs)) {
+    _hasDeferredWidgets = true;
+    return NO_DIRTY_WIDGET;
+  }
+  _hasPrintedLowPriority = true;
+  return idx;
+}
+
+void DisplayMenu::_addDirtyDamage()
+{
+  for (int16_t idx = nextDirtyWidget(0); idx != NO_DIRTY_WIDGET; idx = nextDirtyWidget(idx + 1)) {
+    _addWidgetDamage(idx);
+  }
 }
 
 void DisplayMenu::_updateMapDimensions(int x_count, int y_count) {
@@ -41,17 +302,58 @@ void DisplayMenu::_updateMapDimensions(int x_count, int y_count) {
     _cursorPos[Y_COORD_INDEX] = 0;
     _stopEditingTarget(); // leave editing mode, safeguard code
 
-    // reset printing
+    // reset printing, new page needs a full print
     _currWdgToPrint = 0; 
+    markAllWidgetsDirty();
+    _pageChangeNb++;
+}
+
+#if DISPLAY_MENU_STATS
+void DisplayMenu::_startFrameStats(uint16_t redrawnNb)
+{
+  if (!_isInFrame) {
+    _isInFrame = true;
+    _isFrameTimed = false;
+    _frameStartUs = micros();
+    _frameRedrawnNb = 0;
+  }
+  _frameRedrawnNb += redrawnNb;
+  _frameWidgetNb = getWidgetNb();
 }
 
+void DisplayMenu::_endFrameStats(bool isFlushed)
+{
+  // counted once, when the printing ends or at clearDamage() if it did not
+  if (_isInFrame) {
+    _isInFrame = false;
+    _isFrameTimed = true;
+    uint16_t redrawnNb = (_frameRedrawnNb < _frameWidgetNb) ? _frameRedrawnNb : _frameWidgetNb;
+    _stats.frameNb++;
+    _stats.redrawnWidgetNb += redrawnNb;
+    _stats.skippedWidgetNb += _frameWidgetNb - redrawnNb;
+    _stats.damageRectNb += _damage.getRectNb();
+  }
+  if (!_isFrameTimed) {
+    return;
+  }
+  // the renderer flush, between the last widget and clearDamage(), is part of the frame
+  uint32_t frameUs = micros() - _frameStartUs;
+  _stats.lastFrameUs = frameUs;
+  if (frameUs > _stats.worstFrameUs) {
+    _stats.worstFrameUs = frameUs;
+  }
+  _isFrameTimed = !isFlushed;
+}
+#endif
+
 //#######################################################################
 // Public functions
 //#######################################################################
 
 bool DisplayMenu::isChanged()
 {
-  if (_isChanged)
+  // widgets deferred by the frame budget still need a print
+  if (_isChanged || _hasDeferredWidgets)
   {
     _isChanged = false;
     return true;
@@ -62,6 +364,135 @@ bool DisplayMenu::isChanged()
   }
 }
 
+bool DisplayMenu::isWidgetDirty(uint16_t widgetIdx)
+{
+  if (widgetIdx >= _getDirtyTrackedNb()) {
+    return false;
+  }
+  return (_dirtyWidgets[widgetIdx >> 3] & (1 << (widgetIdx & 7))) != 0;
+}
+
+void DisplayMenu::markWidgetDirty(uint16_t widgetIdx)
+{
+  if (widgetIdx >= _getDirtyTrackedNb()) {
+    return;
+  }
+  _dirtyWidgets[widgetIdx >> 3] |= (1 << (widgetIdx & 7));
+  _addWidgetDamage(widgetIdx);
+}
+
+void DisplayMenu::markAllWidgetsDirty()
+{
+  uint16_t nb = _getDirtyTrackedNb();
+  clearDirtyWidgets();
+  memset(_dirtyWidgets, 0xFF, nb >> 3);
+  if (nb & 7) {
+    _dirtyWidgets[nb >> 3] = (1 << (nb & 7)) - 1;
+  }
+  for (uint16_t i = 0; i < nb; i++) {
+    _addWidgetDamage(i);
+  }
+}
+
+int16_t DisplayMenu::nextDirtyWidget(uint16_t fromIdx)
+{
+  uint16_t nb = _getDirtyTrackedNb();
+  while (fromIdx < nb) {
+    uint8_t bits = _dirtyWidgets[fromIdx >> 3] >> (fromIdx & 7);
+    if (bits == 0) {
+      // nothing left in this byte, jump to the next one
+      fromIdx = (fromIdx | 7) + 1;
+      continue;
+    }
+    while (!(bits & 1)) {
+      bits >>= 1;
+      fromIdx++;
+    }
+    return (fromIdx < nb) ? fromIdx : NO_DIRTY_WIDGET;
+  }
+  return NO_DIRTY_WIDGET;
+}
+
+void DisplayMenu::setFrameSchedule(uint16_t periodMs, uint32_t budgetUs)
+{
+  _framePeriodMs = periodMs;
+  _frameBudgetUs = budgetUs;
+  _nextFrameMs = millis();
+}
+
+bool DisplayMenu::isFrameDue()
+{
+  if (!_isChanged && !_hasDeferredWidgets && (nextDirtyWidget(0) == NO_DIRTY_WIDGET)) {
+    return false;
+  }
+  unsigned long now = millis();
+  if ((_framePeriodMs > 0) && ((long)(now - _nextFrameMs) < 0)) {
+    return false;
+  }
+  _isChanged = false;
+  // keep the cadence, unless the loop is late or the menu was idle
+  _nextFrameMs += _framePeriodMs;
+  if ((long)(now - _nextFrameMs) >= 0) {
+    _nextFrameMs = now + _framePeriodMs;
+  }
+  return true;
+}
+
+uint32_t DisplayMenu::getNextDeadlineMs()
+{
+  unsigned long now = millis();
+  uint32_t delayMs = DISPLAY_DEADLINE_NEVER;
+
+  if ((_heldKey != DISPLAY_INPUT_NONE) && (_heldKey != DISPLAY_INPUT_INTERACT)) {
+    long untilRepeat = (long)(_nextRepeatMs - now);
+    delayMs = (untilRepeat > 0) ? untilRepeat : 0;
+  }
+  if (_isChanged || _hasDeferredWidgets || (nextDirtyWidget(0) != NO_DIRTY_WIDGET)) {
+    long untilFrame = (_framePeriodMs > 0) ? (long)(_nextFrameMs - now) : 0;
+    if (untilFrame <= 0) {
+      return 0;
+    }
+    if ((uint32_t)untilFrame < delayMs) {
+      delayMs = untilFrame;
+    }
+  }
+  return delayMs;
+}
+
+bool DisplayMenu::startDirtyPrint()
+{
+  DISPLAY_STATS(_startFrameStats(0));
+  _printStartUs = micros();
+  _isPrintingLowPriority = false;
+  _hasPrintedLowPriority = false;
+  _hasDeferredWidgets = false;
+  int16_t idx = _nextScheduledWidget(0);
+  if (idx == NO_DIRTY_WIDGET) {
+    _currWdgToPrint = getWidgetNb();
+    DISPLAY_STATS(_endFrameStats(false));
+    return false;
+  }
+  _currWdgToPrint = idx;
+  return true;
+}
+
+bool DisplayMenu::nextDirtyPrint()
+{
+  if (_currWdgToPrint >= _getDirtyTrackedNb()) {
+    return false;
+  }
+  _dirtyWidgets[_currWdgToPrint >> 3] &= ~(1 << (_currWdgToPrint & 7));
+  DISPLAY_STATS(_frameRedrawnNb++);
+  int16_t idx = _nextScheduledWidget(_currWdgToPrint + 1);
+  if (idx == NO_DIRTY_WIDGET) {
+    _currWdgToPrint = getWidgetNb();
+    DISPLAY_STATS(_endFrameStats(false));
+    return false;
+  }
+  _currWdgToPrint = idx;
+  return true;
+}
+
 uint16_t DisplayMenu::getWidgetColor(uint16_t widgetIdx) {
   if (widgetIdx >= getWidgetNb()) {
     return 0;
@@ -106,11 +537,123 @@ uint16_t DisplayMenu::getTargetWidgetColor()
 
 void DisplayMenu::setDisplayedWidgets(DisplayWidget *wdgList, uint16_t yNbWdg, uint16_t xNbWdg)
 {
+  _rowProvider = NULL;
+  _navTable = NULL;
   _menuWidgets = wdgList;
   _updateMapDimensions(xNbWdg, yNbWdg);
   
 }
 
+bool DisplayMenu::setDisplayedLayout(DisplayWidget *wdgList, uint16_t wdgNb, const DisplayNavEntry *navTable,
+                                     bool isProgmem)
+{
+  if (wdgNb > DISPLAY_NAV_MAX_WIDGETS) {
+    return false;   // widgets past the dirty mask would never be redrawn
+  }
+  _rowProvider = NULL;
+  _navTable = navTable;
+  _isNavTableProgmem = isProgmem;
+  _menuWidgets = wdgList;
+  // a single column, so the cursor row is the widget index (see setCursor)
+  _updateMapDimensions(1, wdgNb);
+  return true;
+}
+
+void DisplayMenu::setDisplayedList(DisplayWidgetSlot *viewRows, uint16_t viewRowNb, uint32_t itemNb,
+                                   DisplayRowProviderFct rowProvider, void *ctx)
+{
+  _navTable = NULL;
+  _rowProvider = rowProvider;
+  _rowProviderCtx = ctx;
+  _listRows = viewRows;
+  _listViewRowNb = (viewRowNb > MAX_WIDGETS_NB) ? MAX_WIDGETS_NB : viewRowNb;
+  _listItemNb = itemNb;
+  _listFirstItem = 0;
+  _listAckFirstItem = 0;
+
+  uint16_t rowNb = (itemNb < _listViewRowNb) ? itemNb : _listViewRowNb;
+  if ((rowProvider == NULL) || (viewRows == NULL)) {
+    rowNb = 0;
+  }
+  for (uint16_t row = 0; row < rowNb; row++) {
+    _loadListRow(row);
+  }
+  _menuWidgets = (rowNb > 0) ? &_listRows[0].widget : NULL;
+  _updateMapDimensions(1, rowNb);
+}
+
+void DisplayMenu::setListItemNb(uint32_t itemNb)
+{
+  if ((_rowProvider == NULL) || (_listRows == NULL)) {
+    return;
+  }
+  uint32_t item = getTargetItem();
+  uint16_t rowNb = (itemNb < _listViewRowNb) ? itemNb : _listViewRowNb;
+  uint32_t first = _listFirstItem;
+
+  _listItemNb = itemNb;
+  if (item >= itemNb) {
+    item = 0;
+    _isEditingTarget = false;
+  }
+  if (first + rowNb > itemNb) {
+    first = itemNb - rowNb;
+  }
+  if (item < first) {
+    first = item;
+  } else if ((rowNb > 0) && (item >= first + rowNb)) {
+    first = item - rowNb + 1;
+  }
+  _listFirstItem = first;
+  for (uint16_t row = 0; row < rowNb; row++) {
+    _loadListRow(row);
+  }
+  _menuWidgets = (rowNb > 0) ? &_listRows[0].widget : NULL;
+  _mapDimensions[X_COORD_INDEX] = 1;
+  _mapDimensions[Y_COORD_INDEX] = rowNb;
+  _cursorPos[X_COORD_INDEX] = 0;
+  _cursorPos[Y_COORD_INDEX] = (rowNb > 0) ? item - first : 0;
+  _updateTarget();
+  markAllWidgetsDirty();
+  _pageChangeNb++;
+  _isChanged = true;
+}
+
+bool DisplayMenu::getListChange(DisplayListChange &change)
+{
+  uint32_t from = _listAckFirstItem;
+  uint32_t to = _listFirstItem;
+  uint32_t rowNb = _mapDimensions[Y_COORD_INDEX];
+
+  memset(&change, 0, sizeof(change));
+  if ((_rowProvider == NULL) || (from == to)) {
+    return false;
+  }
+  if (to > from) {
+    change.leftFirst = from;
+    change.leftNb = ((to - from) < rowNb) ? (to - from) : rowNb;
+    change.enteredFirst = ((from + rowNb) > to) ? (from + rowNb) : to;
+    change.enteredNb = to + rowNb - change.enteredFirst;
+  } else {
+    change.enteredFirst = to;
+    change.enteredNb = ((from - to) < rowNb) ? (from - to) : rowNb;
+    change.leftFirst = ((to + rowNb) > from) ? (to + rowNb) : from;
+    change.leftNb = from + rowNb - change.leftFirst;
+  }
+  return true;
+}
+
+void DisplayMenu::setCursor(uint16_t xPos, uint16_t yPos)
+{
+  markWidgetDirty(_targetIdx);
+  _cursorPos[X_COORD_INDEX] = xPos;
+  _cursorPos[Y_COORD_INDEX] = yPos;
+  _encloseCursor();
+  _updateTarget();
+  markWidgetDirty(_targetIdx);
+  _isChanged = true;
+}
+
 void DisplayMenu::setColors(uint16_t idleCol, uint16_t targetCol, uint16_t editingCol, uint16_t backgroundCol)
 {
   _idleColor = idleCol;
@@ -125,14 +668,7 @@ void DisplayMenu::setColors(uint16_t idleCol, uint16_t targetCol, uint16_t editi
 
 void DisplayMenu::moveUp(int amount /* = 1 */)
 {
-    if (_menuWidgets == NULL)
-    return;
-  _isChanged = true;
-  if (_isEditingTarget && !_editsFromSides)
-  {
-    _menuWidgets[_targetIdx].increment();
-  }
-  else if (!_isEditingTarget)
+  if (_prepareMove(false, true))
   {
     _moveCursor(Y_COORD_INDEX, -amount);
   }
@@ -140,14 +676,7 @@ void DisplayMenu::moveUp(int amount /* = 1 */)
 
 void DisplayMenu::moveDown(int amount /* = 1 */)
 {
-    if (_menuWidgets == NULL)
-    return;
-  _isChanged = true;
-  if (_isEditingTarget && !_editsFromSides)
-  {
-    _menuWidgets[_targetIdx].decrement();
-  }
-  else if (!_isEditingTarget)
+  if (_prepareMove(false, false))
   {
     _moveCursor(Y_COORD_INDEX, amount);
   }
@@ -155,14 +684,7 @@ void DisplayMenu::moveDown(int amount /* = 1 */)
 
 void DisplayMenu::moveLeft(int amount /* = 1 */)
 {
-    if (_menuWidgets == NULL)
-    return;
-  _isChanged = true;
-  if (_isEditingTarget && _editsFromSides)
-  {
-    _menuWidgets[_targetIdx].decrement();
-  }
-  else if (!_isEditingTarget)
+  if (_prepareMove(true, false))
   {
     _moveCursor(X_COORD_INDEX, -amount);
   }
@@ -170,17 +692,93 @@ void DisplayMenu::moveLeft(int amount /* = 1 */)
 
 void DisplayMenu::moveRight(int amount /* = 1 */)
 {
-    if (_menuWidgets == NULL)
+  if (_prepareMove(true, true))
+  {
+    _moveCursor(X_COORD_INDEX, amount);
+  }
+}
+
+uint32_t DisplayMenu::processInputs(DisplayInputQueue &queue)
+{
+  uint16_t processed = 0;
+  uint32_t applied = 0;   // runs and interactions, for the stats
+  uint32_t runNb = 0;
+  DisplayInput runInput = DISPLAY_INPUT_NONE;
+  DisplayInput input;
+
+  while ((input = queue.pop()) != DISPLAY_INPUT_NONE)
+  {
+    processed++;
+    if (input != runInput)
+    {
+      applied += _applyMoveRun(runInput, runNb) ? 1 : 0;
+      runInput = input;
+      runNb = 0;
+    }
+    if (input == DISPLAY_INPUT_INTERACT)
+    {
+      interact();   // never merged, each one toggles or activates
+      applied++;
+      continue;
+    }
+    runNb++;
+  }
+  applied += _applyMoveRun(runInput, runNb) ? 1 : 0;
+
+  // events that did not fit in the queue, their order is lost
+  uint32_t overflowNb = 0;
+  for (uint8_t dir = DISPLAY_INPUT_UP; dir <= DISPLAY_INPUT_RIGHT; dir++)
+  {
+    DisplayInputCount count = queue.popOverflow((DisplayInput)dir);
+    overflowNb += count;
+    applied += _applyMoveRun((DisplayInput)dir, count) ? 1 : 0;
+  }
+  DisplayInputCount interacts = queue.popOverflow(DISPLAY_INPUT_INTERACT);
+  for (DisplayInputCount i = 0; i < interacts; i++)
+  {
+    interact();
+  }
+  applied += interacts;
+
+  uint32_t eventNb = (uint32_t)processed + overflowNb + interacts;
+  DISPLAY_STATS(_stats.inputEventNb += eventNb; _stats.coalescedInputNb += eventNb - applied;)
+  (void)applied;
+  return eventNb;
+}
+
+void DisplayMenu::holdKey(DisplayInput key)
+{
+  unsigned long now = millis();
+
+  if (key != _heldKey)
+  {
+    _heldKey = key;
+    _holdStartMs = now;
+    _nextRepeatMs = now + KEY_REPEAT_DELAY_MS;
+    _applyKey(key, 1);
     return;
-  _isChanged = true;
-  if (_isEditingTarget && _editsFromSides)
+  }
+  if ((key == DISPLAY_INPUT_NONE) || (key == DISPLAY_INPUT_INTERACT) || ((long)(now - _nextRepeatMs) < 0))
   {
-    _menuWidgets[_targetIdx].increment();
+    return;
   }
-  else if (!_isEditingTarget)
+
+  // a late loop does not pile up repeats
+  if ((now - _nextRepeatMs) >= KEY_REPEAT_PERIOD_MS)
   {
-    _moveCursor(X_COORD_INDEX, amount);
+    _nextRepeatMs = now + KEY_REPEAT_PERIOD_MS;
   }
+  else
+  {
+    _nextRepeatMs += KEY_REPEAT_PERIOD_MS;
+  }
+
+  uint16_t multiplier = 1;
+  if (_isEditingTarget && (_menuWidgets != NULL))
+  {
+    multiplier = _menuWidgets[_targetIdx].getRampMultiplier(now - _holdStartMs);
+  }
+  _applyKey(key, multiplier);
 }
 
 void DisplayMenu::interact()
@@ -199,6 +797,26 @@ void DisplayMenu::interact()
   }
   else
   {
+    markWidgetDirty(_targetIdx);
     _menuWidgets[_targetIdx].activate();
   }
 }
+
+//-------------------------------------
+// Render statistics
+//-------------------------------------
+
+const DisplayRenderStats &DisplayMenu::getStats()
+{
+#if DISPLAY_MENU_STATS
+  return _stats;
+#else
+  static const DisplayRenderStats noStats = {};
+  return noStats;
+#endif
+}
+
+void DisplayMenu::resetStats()
+{
+  DISPLAY_STATS(memset(&_stats, 0, sizeof(_stats)));
+}
@@ -0,0 +1,96 @@
+#include "DisplayMenuGroup.h"
+
+//#######################################################################
+// Private functions
+//#######################################################################
+
+void DisplayMenuGroup::_onValueEdit(DisplayWidget &wdg, void *ctx)
+{
+  ((DisplayMenuGroup *)ctx)->notifyValueChange(wdg.getValuePtr());
+}
+
+//#######################################################################
+// Public functions
+//#######################################################################
+
+int8_t DisplayMenuGroup::addMenu(DisplayMenu &menu, DisplayInputQueue &queue)
+{
+  if (_menuNb >= DISPLAY_GROUP_MAX_MENUS) {
+    return DISPLAY_GROUP_NO_MENU;
+  }
+  _Member &member = _members[_menuNb];
+  member.menu = &menu;
+  member.queue = &queue;
+  menu.setValueEditFct(_onValueEdit, this);
+  return _menuNb++;
+}
+
+bool DisplayMenuGroup::addSharedValue(const void *value)
+{
+  if ((value == NULL) || (_sharedValueNb >= DISPLAY_GROUP_MAX_SHARED_VALUES)) {
+    return false;
+  }
+  _sharedValues[_sharedValueNb++] = value;
+  return true;
+}
+
+bool DisplayMenuGroup::push(DisplayInput input)
+{
+  uint8_t focusIdx = getFocus();
+  if (focusIdx >= _menuNb) {
+    return false;
+  }
+  return _members[focusIdx].queue->push(input);
+}
+
+void DisplayMenuGroup::setFocus(uint8_t menuIdx)
+{
+  if (menuIdx < _menuNb) {
+    __atomic_store_n(&_focusIdx, menuIdx, __ATOMIC_RELEASE);
+  }
+}
+
+void DisplayMenuGroup::notifyValueChange(const void *value)
+{
+  for (uint8_t v = 0; v < _sharedValueNb; v++) {
+    if (_sharedValues[v] != value) {
+      continue;
+    }
+    // release: the menu task that takes the flag also sees the new value
+    for (uint8_t m = 0; m < _menuNb; m++) {
+      __atomic_store_n(&_changedValues[m][v], (uint8_t)1, __ATOMIC_RELEASE);
+    }
+    return;
+  }
+}
+
+uint16_t DisplayMenuGroup::syncValues(uint8_t menuIdx)
+{
+  uint16_t markedNb = 0;
+  if (menuIdx >= _menuNb) {
+    return 0;
+  }
+  DisplayMenu &menu = *_members[menuIdx].menu;
+  for (uint8_t v = 0; v < _sharedValueNb; v++) {
+    if (__atomic_exchange_n(&_changedValues[menuIdx][v], (uint8_t)0, __ATOMIC_ACQUIRE) == 0) {
+      continue;
+    }
+    for (uint16_t i = 0; i < menu.getWidgetNb(); i++) {
+      DisplayWidget *wdg = menu.getWidget(i);
+      if ((wdg != NULL) && (wdg->getValuePtr() == _sharedValues[v])) {
+        menu.flagWidgetChange(i);
+        markedNb++;
+      }
+    }
+  }
+  return markedNb;
+}
+
+uint32_t DisplayMenuGroup::processInputs(uint8_t menuIdx)
+{
+  if (menuIdx >= _menuNb) {
+    return 0;
+  }
+  syncValues(menuIdx);
+  return _members[menuIdx].menu->processInputs(*_members[menuIdx].queue);
+}
@@ -0,0 +1,74 @@
+#include "DisplayNavTable.h"
+
+// Off axis distance counts more than distance along the move
+#define NAV_OFF_AXIS_WEIGHT (2)
+
+//#######################################################################
+// Private functions
+//#######################################################################
+
+void DisplayNavTable::_measure(DisplayWidget &from, DisplayWidget &to, bool isVertical, int32_t &along,
+                               int32_t &across, bool &inBeam)
+{
+  int32_t fromAlong = isVertical ? from.getYPostion() : from.getXPostion();
+  int32_t fromAcross = isVertical ? from.getXPostion() : from.getYPostion();
+  int32_t fromAlongLen = isVertical ? from.getHeight() : from.getWidth();
+  int32_t fromAcrossLen = isVertical ? from.getWidth() : from.getHeight();
+  int32_t toAlong = isVertical ? to.getYPostion() : to.getXPostion();
+  int32_t toAcross = isVertical ? to.getXPostion() : to.getYPostion();
+  int32_t toAlongLen = isVertical ? to.getHeight() : to.getWidth();
+  int32_t toAcrossLen = isVertical ? to.getWidth() : to.getHeight();
+
+  // center distances, doubled to stay in integers
+  along = (2 * toAlong + toAlongLen) - (2 * fromAlong + fromAlongLen);
+  across = (2 * toAcross + toAcrossLen) - (2 * fromAcross + fromAcrossLen);
+  if (across < 0) {
+    across = -across;
+  }
+  // widgets facing each other across the move come first
+  inBeam = (toAcross < fromAcross + fromAcrossLen) && (fromAcross < toAcross + toAcrossLen);
+}
+
+//#######################################################################
+// Public functions
+//#######################################################################
+
+bool DisplayNavTable::build(DisplayWidget *wdgList, uint16_t wdgNb, DisplayNavEntry *table)
+{
+  if (wdgNb > DISPLAY_NAV_MAX_WIDGETS) {
+    return false;
+  }
+
+  for (uint16_t i = 0; i < wdgNb; i++) {
+    for (uint8_t dir = 0; dir < DISPLAY_NAV_DIR_NB; dir++) {
+      uint16_t best = i;
+      bool bestInBeam = false;
+      int32_t bestScore = 0;
+
+      for (uint16_t j = 0; j < wdgNb; j++) {
+        if (j == i) {
+          continue;
+        }
+        bool isVertical = (dir == DISPLAY_INPUT_UP) || (dir == DISPLAY_INPUT_DOWN);
+        bool inBeam;
+        int32_t along, across;
+        _measure(wdgList[i], wdgList[j], isVertical, along, across, inBeam);
+        if ((dir == DISPLAY_INPUT_UP) || (dir == DISPLAY_INPUT_LEFT)) {
+          along = -along;
+        }
+        // only strictly forward, so repeated moves always end
+        if ((along <= 0) || (!inBeam && (across > along))) {
+          continue;
+        }
+        int32_t score = along + NAV_OFF_AXIS_WEIGHT * across;
+        if ((best == i) || (inBeam && !bestInBeam) || ((inBeam == bestInBeam) && (score < bestScore))) {
+          best = j;
+          bestInBeam = inBeam;
+          bestScore = score;
+        }
+      }
+      table[i].neighbor[dir] = best;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,82 @@
+#include "DisplayPageStack.h"
+
+//#######################################################################
+// Public functions
+//#######################################################################
+
+bool DisplayPageStack::addWidget(const DisplayWidget &wdg)
+{
+  if (_usedSlotNb + _buildNb >= _slotNb) {
+    _buildFailed = true;
+    return false;
+  }
+  memcpy(&_slots[_usedSlotNb + _buildNb].widget, &wdg, sizeof(DisplayWidget));
+  _buildNb++;
+  return true;
+}
+
+bool DisplayPageStack::push(const DisplayPage &page)
+{
+  if (_depth >= MAX_PAGE_DEPTH) {
+    return false;
+  }
+  _Level &level = _levels[_depth];
+  level.page = &page;
+  level.firstSlot = _usedSlotNb;
+
+  if (page.build != NULL) {
+    _buildFailed = false;
+    _buildNb = 0;
+    _buildYNb = 0;
+    _buildXNb = 0;
+    page.build(*this);
+    if (_buildXNb == 0) {
+      _buildYNb = _buildNb;
+      _buildXNb = 1;
+    }
+    if (_buildFailed || (_buildNb == 0) || ((uint32_t)_buildYNb * _buildXNb > _buildNb)) {
+      if (page.release != NULL) {
+        page.release();
+      }
+      return false;
+    }
+    level.widgets = &_slots[level.firstSlot].widget;
+    level.yNbWdg = _buildYNb;
+    level.xNbWdg = _buildXNb;
+    _usedSlotNb += _buildNb;
+  } else {
+    if ((page.widgets == NULL) || (page.yNbWdg == 0) || (page.xNbWdg == 0)) {
+      return false;
+    }
+    level.widgets = page.widgets;
+    level.yNbWdg = page.yNbWdg;
+    level.xNbWdg = page.xNbWdg;
+  }
+
+  if (_depth > 0) {
+    _Level &parent = _levels[_depth - 1];
+    parent.cursorX = _menu.getCursorX();
+    parent.cursorY = _menu.getCursorY();
+  }
+  _depth++;
+  _menu.setDisplayedWidgets(level.widgets, level.yNbWdg, level.xNbWdg);
+  return true;
+}
+
+bool DisplayPageStack::pop()
+{
+  if (_depth <= 1) {
+    return false;
+  }
+  _Level &level = _levels[_depth - 1];
+  if (level.page->release != NULL) {
+    level.page->release();
+  }
+  _usedSlotNb = level.firstSlot;
+  _depth--;
+
+  _Level &parent = _levels[_depth - 1];
+  _menu.setDisplayedWidgets(parent.widgets, parent.yNbWdg, parent.xNbWdg);
+  _menu.setCursor(parent.cursorX, parent.cursorY);
+  return true;
+}
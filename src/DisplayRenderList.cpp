@@ -0,0 +1,260 @@
+#include "DisplayRenderList.h"
+
+#define FNV_OFFSET_BASIS (2166136261UL)
+#define FNV_PRIME (16777619UL)
+#define RECT_OUTLINE_PARTS_NB (4)
+
+//#######################################################################
+// Private functions
+//#######################################################################
+
+uint8_t DisplayRenderList::_getParts(const DisplayCmd &cmd, DisplayRect *parts)
+{
+  // an outline only covers its edges
+  if ((cmd.type != DISPLAY_CMD_RECT) || (cmd.w <= 2) || (cmd.h <= 2)) {
+    parts[0] = cmd.getRect();
+    return 1;
+  }
+  DisplayRect top = {cmd.x, cmd.y, cmd.w, 1};
+  DisplayRect bottom = {cmd.x, (int16_t)(cmd.y + cmd.h - 1), cmd.w, 1};
+  DisplayRect left = {cmd.x, (int16_t)(cmd.y + 1), 1, (uint16_t)(cmd.h - 2)};
+  DisplayRect right = {(int16_t)(cmd.x + cmd.w - 1), (int16_t)(cmd.y + 1), 1, (uint16_t)(cmd.h - 2)};
+  parts[0] = top;
+  parts[1] = bottom;
+  parts[2] = left;
+  parts[3] = right;
+  return RECT_OUTLINE_PARTS_NB;
+}
+
+void DisplayRenderList::_addDamage(DisplayDamage &damage, const DisplayCmd &cmd)
+{
+  DisplayRect parts[RECT_OUTLINE_PARTS_NB];
+  uint8_t partNb = _getParts(cmd, parts);
+  for (uint8_t p = 0; p < partNb; p++) {
+    damage.add(parts[p]);
+  }
+}
+
+bool DisplayRenderList::_overlaps(const DisplayDamage &damage, const DisplayCmd &cmd)
+{
+  DisplayRect parts[RECT_OUTLINE_PARTS_NB];
+  uint8_t partNb = _getParts(cmd, parts);
+  for (uint8_t p = 0; p < partNb; p++) {
+    if (damage.overlaps(parts[p])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+DisplayCmd *DisplayRenderList::_add(DisplayCmdType type, int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+  if (_cmdNb[_frame] >= RENDER_LIST_MAX_CMDS) {
+    _hasOverflowed = true;
+    return NULL;
+  }
+  DisplayCmd *cmd = &_cmds[_frame][_cmdNb[_frame]++];
+  cmd->data = NULL;
+  cmd->dataHash = 0;
+  cmd->key = ((uint16_t)_group << 8) | _groupCmdNb++;
+  cmd->x = x;
+  cmd->y = y;
+  cmd->w = w;
+  cmd->h = h;
+  cmd->color = color;
+  cmd->bgColor = color;
+  cmd->type = type;
+  cmd->textSize = 0;
+  return cmd;
+}
+
+int16_t DisplayRenderList::_findPrevious(uint16_t key, uint16_t hint)
+{
+  const DisplayCmd *prev = _cmds[_frame ^ 1];
+  uint16_t prevNb = _cmdNb[_frame ^ 1];
+
+  // pages are usually recorded in the same order every frame
+  if ((hint < prevNb) && (prev[hint].key == key)) {
+    return hint;
+  }
+  for (uint16_t i = 0; i < prevNb; i++) {
+    if (prev[i].key == key) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool DisplayRenderList::_isSame(const DisplayCmd &a, const DisplayCmd &b)
+{
+  return (a.type == b.type) && (a.x == b.x) && (a.y == b.y) && (a.w == b.w) && (a.h == b.h) &&
+         (a.color == b.color) && (a.bgColor == b.bgColor) && (a.textSize == b.textSize) &&
+         (a.dataHash == b.dataHash) && ((a.type == DISPLAY_CMD_TEXT) || (a.data == b.data));
+}
+
+uint32_t DisplayRenderList::_hashText(const char *text)
+{
+  uint32_t hash = FNV_OFFSET_BASIS;
+  while (*text != '\0') {
+    hash = (hash ^ (uint8_t)*text++) * FNV_PRIME;
+  }
+  return hash;
+}
+
+//#######################################################################
+// Public functions
+//#######################################################################
+
+void DisplayRenderList::begin()
+{
+  _frame ^= 1;
+  _cmdNb[_frame] = 0;
+  _hasOverflowed = false;
+  setGroup(0);
+}
+
+bool DisplayRenderList::fillRect(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+  return _add(DISPLAY_CMD_FILL_RECT, x, y, w, h, color) != NULL;
+}
+
+bool DisplayRenderList::drawRect(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+  return _add(DISPLAY_CMD_RECT, x, y, w, h, color) != NULL;
+}
+
+bool DisplayRenderList::drawText(int16_t x, int16_t y, const char *text, uint16_t color, uint16_t bgColor,
+                                 uint8_t textSize, uint16_t w, uint16_t h)
+{
+  if ((w == 0) || (h == 0)) {
+    w = strlen(text) * RENDER_LIST_CHAR_WIDTH * textSize;
+    h = RENDER_LIST_CHAR_HEIGHT * textSize;
+  }
+  DisplayCmd *cmd = _add(DISPLAY_CMD_TEXT, x, y, w, h, color);
+  if (cmd == NULL) {
+    return false;
+  }
+  cmd->data = text;
+  cmd->dataHash = _hashText(text);
+  cmd->bgColor = bgColor;
+  cmd->textSize = textSize;
+  return true;
+}
+
+bool DisplayRenderList::drawBitmap(int16_t x, int16_t y, const DisplayBitmap *bmp, uint16_t color, uint16_t bgColor)
+{
+  DisplayCmd *cmd = _add(DISPLAY_CMD_BITMAP, x, y, bmp->width, bmp->height, color);
+  if (cmd == NULL) {
+    return false;
+  }
+  cmd->data = bmp;
+  cmd->bgColor = bgColor;
+  return true;
+}
+
+uint16_t DisplayRenderList::commit(DisplayCmdDrawFct drawFct, void *ctx)
+{
+  const DisplayCmd *cmds = _cmds[_frame];
+  const DisplayCmd *prev = _cmds[_frame ^ 1];
+  uint16_t cmdNb = _cmdNb[_frame];
+  uint16_t prevNb = _cmdNb[_frame ^ 1];
+  uint16_t sentNb = 0;
+
+  if (_isFullRedraw) {
+    for (uint16_t i = 0; i < cmdNb; i++) {
+      drawFct(cmds[i], ctx);
+    }
+    _isFullRedraw = false;
+    return cmdNb;
+  }
+
+  // changed commands, with their area before and after the change
+  DisplayDamage damage;
+  uint8_t prevMatched[(RENDER_LIST_MAX_CMDS + 7) / 8];
+  uint8_t clipped[(RENDER_LIST_MAX_CMDS + 7) / 8];
+  memset(prevMatched, 0, sizeof(prevMatched));
+  memset(clipped, 0, sizeof(clipped));
+  memset(_redraw, 0, sizeof(_redraw));
+  uint16_t hint = 0;
+
+  for (uint16_t i = 0; i < cmdNb; i++) {
+    int16_t j = _findPrevious(cmds[i].key, hint);
+    if (j >= 0) {
+      prevMatched[j >> 3] |= (1 << (j & 7));
+      hint = j + 1;
+      if (_isSame(cmds[i], prev[j])) {
+        continue;
+      }
+      _addDamage(damage, prev[j]);
+    }
+    _mark(i);
+    _addDamage(damage, cmds[i]);
+  }
+  for (uint16_t j = 0; j < prevNb; j++) {
+    if (!(prevMatched[j >> 3] & (1 << (j & 7)))) {
+      _addDamage(damage, prev[j]);
+    }
+  }
+
+  // everything drawn over the erased areas is drawn again, fills and outlines only inside them
+  bool isGrown = true;
+  while (isGrown) {
+    isGrown = false;
+    for (uint16_t i = 0; i < cmdNb; i++) {
+      if (_isMarked(i) || !_overlaps(damage, cmds[i])) {
+        continue;
+      }
+      _mark(i);
+      if ((cmds[i].type == DISPLAY_CMD_FILL_RECT) || (cmds[i].type == DISPLAY_CMD_RECT)) {
+        clipped[i >> 3] |= (1 << (i & 7));
+      } else {
+        damage.add(cmds[i].getRect());
+        isGrown = true;
+      }
+    }
+  }
+
+  DisplayCmd piece;
+  memset(&piece, 0, sizeof(piece));
+  piece.type = DISPLAY_CMD_FILL_RECT;
+  for (uint8_t r = 0; r < damage.getRectNb(); r++) {
+    DisplayRect area = damage.getRect(r);
+    piece.x = area.x;
+    piece.y = area.y;
+    piece.w = area.w;
+    piece.h = area.h;
+    piece.color = _bgColor;
+    piece.bgColor = _bgColor;
+    drawFct(piece, ctx);
+    sentNb++;
+  }
+  for (uint16_t i = 0; i < cmdNb; i++) {
+    if (!_isMarked(i)) {
+      continue;
+    }
+    if (!(clipped[i >> 3] & (1 << (i & 7)))) {
+      drawFct(cmds[i], ctx);
+      sentNb++;
+      continue;
+    }
+    DisplayRect parts[RECT_OUTLINE_PARTS_NB];
+    uint8_t partNb = _getParts(cmds[i], parts);
+    for (uint8_t p = 0; p < partNb; p++) {
+      for (uint8_t r = 0; r < damage.getRectNb(); r++) {
+        DisplayRect area = parts[p].intersect(damage.getRect(r));
+        if (area.isEmpty()) {
+          continue;
+        }
+        piece = cmds[i];
+        piece.type = DISPLAY_CMD_FILL_RECT;
+        piece.x = area.x;
+        piece.y = area.y;
+        piece.w = area.w;
+        piece.h = area.h;
+        drawFct(piece, ctx);
+        sentNb++;
+      }
+    }
+  }
+  return sentNb;
+}
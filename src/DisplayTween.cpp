@@ -0,0 +1,268 @@
+#include "DisplayTween.h"
+
+#define EASE_TABLE_POINTS (17)
+#define EASE_TABLE_SHIFT (12)   // 16 bit progress to table segment
+#define PROGRESS_ONE (65536UL)
+
+#if defined(__AVR__)
+#define EASE_TABLE_READ(addr) pgm_read_word(addr)
+#else
+#define EASE_TABLE_READ(addr) (*(addr))
+#endif
+
+// Eased progress at every 1/16 of the animation, 65535 is 1.0
+static const uint16_t easeTables[3][EASE_TABLE_POINTS]
+#if defined(__AVR__)
+    PROGMEM
+#endif
+    = {
+        // EASE_IN: t^2
+        {0, 256, 1024, 2304, 4096, 6400, 9216, 12544, 16384, 20736, 25600, 30976, 36863, 43263, 50175, 57599, 65535},
+        // EASE_OUT: 1 - (1 - t)^2
+        {0, 7936, 15360, 22272, 28672, 34559, 39935, 44799, 49151, 52991, 56319, 59135, 61439, 63231, 64511, 65279, 65535},
+        // EASE_IN_OUT: 2t^2, then 1 - 2(1 - t)^2
+        {0, 512, 2048, 4608, 8192, 12800, 18432, 25088, 32768, 40447, 47103, 52735, 57343, 60927, 63487, 65023, 65535},
+};
+
+//#######################################################################
+// Private functions
+//#######################################################################
+
+uint32_t DisplayAnimator::_easeProgress(uint32_t progress, DisplayEasing easing)
+{
+  if (progress >= PROGRESS_ONE) {
+    return PROGRESS_ONE;
+  }
+  if ((easing == EASE_LINEAR) || (easing > EASE_IN_OUT)) {
+    return progress;
+  }
+  const uint16_t *table = easeTables[easing - 1];
+  uint8_t point = progress >> EASE_TABLE_SHIFT;
+  uint32_t frac = progress & ((1 << EASE_TABLE_SHIFT) - 1);
+  uint32_t a = EASE_TABLE_READ(&table[point]);
+  uint32_t b = EASE_TABLE_READ(&table[point + 1]);
+  uint32_t eased = a + (((b - a) * frac) >> EASE_TABLE_SHIFT);
+  return eased + (eased >> 15);   // 65535 -> 65536
+}
+
+int8_t DisplayAnimator::_start(DisplayTweenKind kind, void *target, int32_t from, int32_t to, uint16_t durationMs,
+                               DisplayEasing easing, DisplayTweenStepFct stepFct, void *ctx)
+{
+  int8_t freeIdx = DISPLAY_TWEEN_NONE;
+  for (int8_t i = 0; i < DISPLAY_ANIMATOR_MAX_TWEENS; i++) {
+    _Tween &tween = _tweens[i];
+    if (!tween.isRunning) {
+      if (freeIdx == DISPLAY_TWEEN_NONE) {
+        freeIdx = i;
+      }
+    } else if ((tween.kind == kind) && (tween.target == target)) {
+      // already animated: restart from where it is
+      freeIdx = i;
+      _runningNb--;
+      break;
+    }
+  }
+  if (freeIdx == DISPLAY_TWEEN_NONE) {
+    return DISPLAY_TWEEN_NONE;
+  }
+  _Tween &tween = _tweens[freeIdx];
+  tween.target = target;
+  tween.menu = NULL;
+  tween.stepFct = stepFct;
+  tween.ctx = ctx;
+  tween.from = from;
+  tween.to = to;
+  tween.current = from;
+  tween.startMs = millis();
+  tween.durationMs = durationMs;
+  tween.widgetIdx = 0;
+  tween.pageChangeNb = 0;
+  tween.kind = kind;
+  tween.easing = easing;
+  tween.isRunning = true;
+  _runningNb++;
+  return freeIdx;
+}
+
+bool DisplayAnimator::_isWidgetGone(_Tween &tween)
+{
+  if (tween.kind < TWEEN_KIND_WIDGET_VALUE) {
+    return false;
+  }
+  // the slots of a page stack or list rows can hold another widget at the same address
+  return (tween.menu->getPageChangeNb() != tween.pageChangeNb) ||
+         (tween.menu->getWidget(tween.widgetIdx) != (DisplayWidget *)tween.target);
+}
+
+void DisplayAnimator::_apply(_Tween &tween, int32_t value)
+{
+  switch ((DisplayTweenKind)tween.kind) {
+    case TWEEN_KIND_INT16: *(int16_t *)tween.target = value; break;
+    case TWEEN_KIND_INT32: *(int32_t *)tween.target = value; break;
+    case TWEEN_KIND_COLOR: *(uint16_t *)tween.target = value; break;
+    default: {
+      DisplayWidget *wdg = (DisplayWidget *)tween.target;
+      if (tween.kind == TWEEN_KIND_WIDGET_VALUE) {
+        displayValueStore(wdg->getIntValue(), (int)value);
+      } else {
+        // the area left by the widget needs a redraw too
+        tween.menu->markWidgetDirty(tween.widgetIdx);
+        if (tween.kind == TWEEN_KIND_WIDGET_X) {
+          wdg->setPosition(value, wdg->getYPostion());
+        } else {
+          wdg->setPosition(wdg->getXPostion(), value);
+        }
+      }
+      tween.menu->flagWidgetChange(tween.widgetIdx);
+      break;
+    }
+  }
+}
+
+//#######################################################################
+// Public functions
+//#######################################################################
+
+int32_t DisplayAnimator::ease(int32_t from, int32_t to, uint32_t progress, DisplayEasing easing)
+{
+  uint32_t eased = _easeProgress(progress, easing);
+  int64_t delta = (int64_t)to - from;
+  if ((delta >= -32768) && (delta <= 32767)) {
+    // fits 32 bit math, much cheaper on small MCUs
+    return from + (((int32_t)delta * (int32_t)eased) >> 16);
+  }
+  return from + (int32_t)((delta * eased) >> 16);
+}
+
+uint16_t DisplayAnimator::easeColor(uint16_t from, uint16_t to, uint32_t progress, DisplayEasing easing)
+{
+  uint32_t eased = _easeProgress(progress, easing);
+  int32_t r0 = from >> 11, g0 = (from >> 5) & 0x3F, b0 = from & 0x1F;
+  int32_t r1 = to >> 11, g1 = (to >> 5) & 0x3F, b1 = to & 0x1F;
+  int32_t r = r0 + (((r1 - r0) * (int32_t)eased) >> 16);
+  int32_t g = g0 + (((g1 - g0) * (int32_t)eased) >> 16);
+  int32_t b = b0 + (((b1 - b0) * (int32_t)eased) >> 16);
+  return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+int8_t DisplayAnimator::animateWidget(DisplayMenu &menu, uint16_t widgetIdx, DisplayTweenKind kind, int32_t to,
+                                      uint16_t durationMs, DisplayEasing easing, DisplayTweenStepFct stepFct, void *ctx)
+{
+  DisplayWidget *wdg = menu.getWidget(widgetIdx);
+  if ((wdg == NULL) || (kind < TWEEN_KIND_WIDGET_VALUE)) {
+    return DISPLAY_TWEEN_NONE;
+  }
+  int32_t from;
+  if (kind == TWEEN_KIND_WIDGET_VALUE) {
+    if (wdg->getIntValue() == NULL) {
+      return DISPLAY_TWEEN_NONE;
+    }
+    from = displayValueLoad(wdg->getIntValue());
+  } else {
+    from = (kind == TWEEN_KIND_WIDGET_X) ? wdg->getXPostion() : wdg->getYPostion();
+  }
+  int8_t handle = _start(kind, wdg, from, to, durationMs, easing, stepFct, ctx);
+  if (handle != DISPLAY_TWEEN_NONE) {
+    _tweens[handle].menu = &menu;
+    _tweens[handle].widgetIdx = widgetIdx;
+    _tweens[handle].pageChangeNb = menu.getPageChangeNb();
+  }
+  return handle;
+}
+
+uint8_t DisplayAnimator::update(unsigned long nowMs)
+{
+  if ((_runningNb == 0) || (_hasStepped && (nowMs - _lastStepMs < _stepPeriodMs))) {
+    return 0;
+  }
+  _hasStepped = true;
+  _lastStepMs = nowMs;
+
+  uint8_t changedNb = 0;
+  for (uint8_t i = 0; i < DISPLAY_ANIMATOR_MAX_TWEENS; i++) {
+    _Tween &tween = _tweens[i];
+    if (!tween.isRunning) {
+      continue;
+    }
+    if (_isWidgetGone(tween)) {
+      tween.isRunning = false;
+      _runningNb--;
+      continue;
+    }
+    // started after nowMs was read
+    unsigned long elapsedMs = ((long)(nowMs - tween.startMs) > 0) ? nowMs - tween.startMs : 0;
+    bool isDone = elapsedMs >= tween.durationMs;
+    int32_t value = tween.to;
+    if (!isDone) {
+      uint32_t progress = ((uint32_t)elapsedMs << 16) / tween.durationMs;
+      value = (tween.kind == TWEEN_KIND_COLOR)
+                  ? easeColor(tween.from, tween.to, progress, (DisplayEasing)tween.easing)
+                  : ease(tween.from, tween.to, progress, (DisplayEasing)tween.easing);
+    }
+    if (isDone) {
+      tween.isRunning = false;
+      _runningNb--;
+    }
+    if (value == tween.current) {
+      if (isDone && (tween.stepFct != NULL)) {
+        tween.stepFct(value, value, true, tween.ctx);
+      }
+      continue;
+    }
+    int32_t previous = tween.current;
+    tween.current = value;
+    _apply(tween, value);
+    changedNb++;
+    if (tween.stepFct != NULL) {
+      tween.stepFct(previous, value, isDone, tween.ctx);
+    }
+  }
+  return changedNb;
+}
+
+void DisplayAnimator::stop(int8_t handle, bool isFinished)
+{
+  if (!isRunning(handle)) {
+    return;
+  }
+  _Tween &tween = _tweens[handle];
+  tween.isRunning = false;
+  _runningNb--;
+  if (isFinished && (tween.current != tween.to) && !_isWidgetGone(tween)) {
+    int32_t previous = tween.current;
+    tween.current = tween.to;
+    _apply(tween, tween.to);
+    if (tween.stepFct != NULL) {
+      tween.stepFct(previous, tween.to, true, tween.ctx);
+    }
+  }
+}
+
+bool DisplayAnimator::isRunning(int8_t handle)
+{
+  return (handle >= 0) && (handle < DISPLAY_ANIMATOR_MAX_TWEENS) && _tweens[handle].isRunning;
+}
+
+uint8_t DisplayAnimator::getRunningNb()
+{
+  return _runningNb;
+}
+
+uint32_t DisplayAnimator::getNextDeadlineMs(unsigned long nowMs)
+{
+  // tweens of widgets that left the page have no step left, update() only drops them
+  uint8_t stepNb = 0;
+  for (uint8_t i = 0; i < DISPLAY_ANIMATOR_MAX_TWEENS; i++) {
+    if (_tweens[i].isRunning && !_isWidgetGone(_tweens[i])) {
+      stepNb++;
+    }
+  }
+  if (stepNb == 0) {
+    return DISPLAY_DEADLINE_NEVER;
+  }
+  if (!_hasStepped) {
+    return 0;
+  }
+  long untilStep = (long)(_lastStepMs + _stepPeriodMs - nowMs);
+  return (untilStep > 0) ? untilStep : 0;
+}
@@ -15,6 +15,7 @@
 
 #define COUNTER_WIDGET_IDX      0
 #define RESET_WIDGET_IDX        1
+#define TEST_MENU_WIDGET_NB     2
 int widgetTestCounter;
 
 DisplayMenu menu;
@@ -23,9 +24,9 @@ void resetCounter() {
   widgetTestCounter = 0;
 }
 
-DisplayWidget widgets[DANCE_MENU_WIDGET_NB] = {
+DisplayWidget widgets[TEST_MENU_WIDGET_NB] = {
   DisplayWidget(&widgetTestCounter, 1, 20), //check to replace pointer with a void pointer, but needs to understand if is a fct ptr
-  DisplayWidget(widgetTestCounter)
+  DisplayWidget(resetCounter)
 };
 
 void Test_menuBackgroundColor(void)
@@ -51,6 +52,13 @@ void Test_menuWdgActivation(void)
     TEST_ASSERT_EQUAL(widgetTestCounter, 0);
 }
 
+/*! @brief Test that only the edited widget needs a reprint after an edit. */
+void Test_menuDirtyWidgets(void)
+{
+    TEST_ASSERT_EQUAL(menu.nextDirtyWidget(), COUNTER_WIDGET_IDX);
+    TEST_ASSERT_EQUAL(menu.nextDirtyWidget(COUNTER_WIDGET_IDX + 1), NO_DIRTY_WIDGET);
+}
+
 void setup()
 {
     // NOTE!!! Wait for >2 secs
@@ -59,13 +67,16 @@ void setup()
     
     UNITY_BEGIN(); // IMPORTANT LINE!
     menu.setColors(IDLE_TEXT_COLOR, TARGET_TEXT_COLOR, EDIT_TEXT_COLOR, BACKGROUND_TEXT_COLOR);
+    menu.setDisplayedWidgets(widgets, TEST_MENU_WIDGET_NB);
     RUN_TEST(Test_menuBackgroundColor);
 
     menu.interact();
     RUN_TEST(Test_menuEditingWidget);
 
+    menu.startPrint(); // full print consumes every pending reprint
     menu.moveUp();
     RUN_TEST(Test_menuVarEdit);
+    RUN_TEST(Test_menuDirtyWidgets);
 
     menu.interact();
     menu.moveDown();